@@ -1,6 +1,7 @@
 #include "argument.hpp"
 
 #include "certificate.hpp"
+#include "x509_utils.hpp"
 
 #include <CLI/CLI.hpp>
 
@@ -19,6 +20,14 @@ int processArguments(int argc, const char* const* argv, Arguments& arguments)
     app.add_option("-u,--unit", arguments.unit,
                    "Optional systemd unit need to reload")
         ->capture_default_str();
+    app.add_option("-f,--storage-format", arguments.format,
+                   "storage format of stored certificates: pem or der")
+        ->capture_default_str();
+    app.add_option("-m,--metrics-file", arguments.metricsFile,
+                   "Optional file to export metrics to, in Prometheus format");
+    app.add_option("-s,--startup-trace", arguments.startupTrace,
+                   "Optional Chrome trace file to record the startup to, or "
+                   "\"journal\"");
     CLI11_PARSE(app, argc, argv);
     phosphor::certs::CertificateType type =
         phosphor::certs::stringToCertificateType(arguments.typeStr);
@@ -27,6 +36,11 @@ int processArguments(int argc, const char* const* argv, Arguments& arguments)
         std::cerr << "type not specified or invalid." << std::endl;
         return 1;
     }
+    if (!phosphor::certs::stringToStorageFormat(arguments.format))
+    {
+        std::cerr << "storage format invalid." << std::endl;
+        return 1;
+    }
     return 0;
 }
 } // namespace phosphor::certs
@@ -7,10 +7,13 @@ namespace phosphor::certs
 
 struct Arguments
 {
-    std::string typeStr;  // certificate type
-    std::string endpoint; // d-bus endpoint
-    std::string path;     // certificate file path
-    std::string unit;     // Optional systemd unit need to reload
+    std::string typeStr;        // certificate type
+    std::string endpoint;       // d-bus endpoint
+    std::string path;           // certificate file path
+    std::string unit;           // Optional systemd unit need to reload
+    std::string format = "pem"; // storage format of stored certificates
+    std::string metricsFile;    // Optional file to export metrics to
+    std::string startupTrace;   // Optional startup trace file, or "journal"
 };
 
 // Validates all |argv| is valid and set corresponding attributes in
@@ -0,0 +1,686 @@
+/** @file
+ *  @brief End-to-end load generator: starts a private dbus-daemon, serves a
+ *  server, an authority and a secure boot database endpoint from a child
+ *  process, and drives a mix of D-Bus calls at them from concurrent clients.
+ *  Reports the throughput and the latency percentiles of each call as
+ *  clients see them, sd-bus marshalling and the bus daemon included.
+ */
+
+#include "config.h"
+
+#include "certificate.hpp"
+#include "certs_manager.hpp"
+#include "corpus.hpp"
+#include "x509_utils.hpp"
+
+#include <signal.h>
+#include <sys/wait.h>
+#include <systemd/sd-bus.h>
+#include <systemd/sd-event.h>
+#include <unistd.h>
+
+#include <sdbusplus/bus.hpp>
+#include <sdbusplus/exception.hpp>
+#include <sdbusplus/message.hpp>
+#include <sdbusplus/server/manager.hpp>
+#include <sdeventplus/event.hpp>
+#include <xyz/openbmc_project/BIOSConfig/SecureBootDatabase/Signature/server.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <CLI/CLI.hpp>
+
+namespace phosphor::certs::load
+{
+namespace
+{
+
+namespace fs = std::filesystem;
+using SignatureFormat = sdbusplus::xyz::openbmc_project::BIOSConfig::
+    SecureBootDatabase::server::Signature::SignatureFormat;
+using Clock = std::chrono::steady_clock;
+
+enum class Operation
+{
+    install,
+    installAll,
+    replaceAll,
+    remove,
+    generateCSR,
+    addSignature,
+    getAll,
+    getManagedObjects,
+};
+
+/** @brief Names of the operations in --mix and in the report */
+constexpr std::array<const char*, 8> operationNames = {
+    "install",     "installAll",   "replaceAll", "delete",
+    "generateCSR", "addSignature", "getAll",     "getManagedObjects",
+};
+
+constexpr char defaultMix[] =
+    "install=2,delete=2,installAll=1,replaceAll=1,generateCSR=1,"
+    "addSignature=1,getAll=8,getManagedObjects=4";
+
+/** @brief An endpoint served by the child process */
+struct Endpoint
+{
+    CertificateType type;
+    std::string name;
+    std::string objectPath;
+    std::string busName;
+    std::string installPath;
+};
+
+std::string capitalize(std::string s)
+{
+    if (!s.empty())
+    {
+        s[0] = static_cast<char>(std::toupper(s[0]));
+    }
+    return s;
+}
+
+Endpoint makeEndpoint(CertificateType type, const std::string& name,
+                      const fs::path& dir, const std::string& installPath)
+{
+    std::string typeStr = certificateTypeToString(type);
+    std::string objectPath = std::string(objectNamePrefix) + '/' + typeStr +
+                             '/' + name;
+    if (type == CertificateType::securebootDatabase)
+    {
+        objectPath = "/xyz/openbmc_project/secureBootDatabase/" + name;
+    }
+    return {type, name, objectPath,
+            std::string(busNamePrefix) + '.' + capitalize(typeStr) + '.' +
+                capitalize(name),
+            dir / installPath};
+}
+
+/** @brief Open a connection to the bus at |address| */
+sdbusplus::bus_t openBus(const std::string& address)
+{
+    sd_bus* bus = nullptr;
+    int r = sd_bus_new(&bus);
+    if (r >= 0)
+    {
+        r = sd_bus_set_address(bus, address.c_str());
+    }
+    if (r >= 0)
+    {
+        r = sd_bus_set_bus_client(bus, 1);
+    }
+    if (r >= 0)
+    {
+        r = sd_bus_start(bus);
+    }
+    if (r < 0)
+    {
+        sd_bus_unref(bus);
+        throw std::system_error(-r, std::generic_category(),
+                                "Unable to connect to " + address);
+    }
+    return sdbusplus::bus_t(bus, std::false_type{});
+}
+
+/** @class PrivateBus
+ *  @brief A dbus-daemon listening on a socket of a temporary directory
+ */
+class PrivateBus
+{
+  public:
+    PrivateBus(const std::string& daemon, const fs::path& dir)
+    {
+        fs::path config = dir / "bus.conf";
+        std::ofstream(config)
+            << "<!DOCTYPE busconfig PUBLIC "
+               "\"-//freedesktop//DTD D-Bus Bus Configuration 1.0//EN\" "
+               "\"http://www.freedesktop.org/standards/dbus/1.0/"
+               "busconfig.dtd\">\n"
+               "<busconfig>\n"
+               "  <type>session</type>\n"
+               "  <listen>unix:path="
+            << (dir / "bus").string()
+            << "</listen>\n"
+               "  <auth>EXTERNAL</auth>\n"
+               "  <policy context=\"default\">\n"
+               "    <allow send_destination=\"*\"/>\n"
+               "    <allow own=\"*\"/>\n"
+               "  </policy>\n"
+               "</busconfig>\n";
+
+        int fds[2];
+        if (pipe(fds) != 0)
+        {
+            throw std::system_error(errno, std::generic_category(), "pipe");
+        }
+        pid = fork();
+        if (pid == 0)
+        {
+            close(fds[0]);
+            std::string configArg = "--config-file=" + config.string();
+            std::string addressArg = "--print-address=" +
+                                     std::to_string(fds[1]);
+            execlp(daemon.c_str(), daemon.c_str(), configArg.c_str(),
+                   addressArg.c_str(), "--nofork", "--nopidfile", nullptr);
+            _exit(127);
+        }
+        close(fds[1]);
+        if (pid == -1)
+        {
+            close(fds[0]);
+            throw std::system_error(errno, std::generic_category(), "fork");
+        }
+
+        // The daemon prints its address once it listens
+        char c = 0;
+        while (read(fds[0], &c, 1) == 1 && c != '\n')
+        {
+            address += c;
+        }
+        close(fds[0]);
+        if (address.empty())
+        {
+            stop();
+            throw std::runtime_error("Unable to start " + daemon);
+        }
+    }
+
+    ~PrivateBus()
+    {
+        stop();
+    }
+
+    PrivateBus(const PrivateBus&) = delete;
+    PrivateBus& operator=(const PrivateBus&) = delete;
+
+    std::string address;
+
+  private:
+    void stop()
+    {
+        if (pid > 0)
+        {
+            kill(pid, SIGTERM);
+            waitpid(pid, nullptr, 0);
+            pid = -1;
+        }
+    }
+
+    pid_t pid = -1;
+};
+
+/** @brief Serve |endpoints| on the bus at |address| until killed */
+[[noreturn]] void serve(const std::string& address,
+                        const std::vector<Endpoint>& endpoints)
+{
+    try
+    {
+        auto bus = openBus(address);
+        auto event = sdeventplus::Event::get_new();
+        bus.attach_event(event.get(), SD_EVENT_PRIORITY_NORMAL);
+
+        std::vector<std::unique_ptr<sdbusplus::server::manager_t>> objManagers;
+        std::vector<std::unique_ptr<Manager>> managers;
+        for (const auto& endpoint : endpoints)
+        {
+            objManagers.emplace_back(
+                std::make_unique<sdbusplus::server::manager_t>(
+                    bus, endpoint.objectPath.c_str()));
+            managers.emplace_back(std::make_unique<Manager>(
+                bus, event, endpoint.objectPath.c_str(), endpoint.type, "",
+                endpoint.installPath));
+        }
+        for (const auto& endpoint : endpoints)
+        {
+            bus.request_name(endpoint.busName.c_str());
+        }
+        event.loop();
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Service failed: " << e.what() << std::endl;
+    }
+    _exit(EXIT_FAILURE);
+}
+
+/** @brief Latencies and errors of one operation */
+struct Samples
+{
+    std::vector<int64_t> latencies;
+    uint64_t errors = 0;
+};
+
+using Results = std::array<Samples, operationNames.size()>;
+
+/** @brief Files and object paths shared by the clients */
+struct Workload
+{
+    Endpoint server;
+    Endpoint authority;
+    Endpoint secureBoot;
+    /** @brief Distinct authorities, for Install */
+    std::vector<std::string> certificates;
+    /** @brief Authorities list, for InstallAll and ReplaceAll */
+    std::string bundle;
+    std::atomic<uint64_t> signatures{0};
+
+    std::mutex mutex;
+    /** @brief Objects of the installed authorities, as last seen */
+    std::vector<std::string> installed;
+};
+
+/** @brief Take an installed certificate object, or an empty string */
+std::string takeInstalled(Workload& workload, std::mt19937_64& random,
+                          bool remove)
+{
+    std::lock_guard lock(workload.mutex);
+    if (workload.installed.empty())
+    {
+        return {};
+    }
+    size_t index = random() % workload.installed.size();
+    std::string path = workload.installed[index];
+    if (remove)
+    {
+        workload.installed.erase(workload.installed.begin() +
+                                 static_cast<ptrdiff_t>(index));
+    }
+    return path;
+}
+
+void publishInstalled(Workload& workload,
+                      const std::vector<sdbusplus::message::object_path>& paths)
+{
+    std::lock_guard lock(workload.mutex);
+    workload.installed.clear();
+    for (const auto& path : paths)
+    {
+        workload.installed.emplace_back(path.str);
+    }
+}
+
+/** @brief Make the call of |operation|
+ *  @return false if it was skipped, for lack of an object to call.
+ */
+bool call(sdbusplus::bus_t& bus, Workload& workload, Operation operation,
+          std::mt19937_64& random)
+{
+    const Endpoint& authority = workload.authority;
+    switch (operation)
+    {
+        case Operation::install:
+        {
+            auto m = bus.new_method_call(
+                authority.busName.c_str(), authority.objectPath.c_str(),
+                "xyz.openbmc_project.Certs.Install", "Install");
+            m.append(workload.certificates[random() %
+                                           workload.certificates.size()]);
+            sdbusplus::message::object_path path;
+            bus.call(m).read(path);
+            std::lock_guard lock(workload.mutex);
+            workload.installed.emplace_back(path.str);
+            return true;
+        }
+        case Operation::installAll:
+        case Operation::replaceAll:
+        {
+            const char* method = operation == Operation::installAll
+                                     ? "InstallAll"
+                                     : "ReplaceAll";
+            auto m = bus.new_method_call(
+                authority.busName.c_str(), authority.objectPath.c_str(),
+                (std::string("xyz.openbmc_project.Certs.") + method).c_str(),
+                method);
+            m.append(workload.bundle);
+            std::vector<sdbusplus::message::object_path> paths;
+            bus.call(m).read(paths);
+            publishInstalled(workload, paths);
+            return true;
+        }
+        case Operation::remove:
+        {
+            std::string path = takeInstalled(workload, random, true);
+            if (path.empty())
+            {
+                return false;
+            }
+            auto m = bus.new_method_call(authority.busName.c_str(),
+                                         path.c_str(),
+                                         "xyz.openbmc_project.Object.Delete",
+                                         "Delete");
+            bus.call(m);
+            return true;
+        }
+        case Operation::generateCSR:
+        {
+            const Endpoint& server = workload.server;
+            auto m = bus.new_method_call(
+                server.busName.c_str(), server.objectPath.c_str(),
+                "xyz.openbmc_project.Certs.CSR.Create", "GenerateCSR");
+            m.append(std::vector<std::string>{"bmc.example.com"}, "",
+                     "Santa Clara", "bmc.example.com", "", "US", "", "", "",
+                     int64_t{0}, "prime256v1", "EC",
+                     std::vector<std::string>{"ServerAuthentication"},
+                     "Example Corporation", "", "California", "", "");
+            sdbusplus::message::object_path path;
+            bus.call(m).read(path);
+            return true;
+        }
+        case Operation::addSignature:
+        {
+            const Endpoint& secureBoot = workload.secureBoot;
+            auto m = bus.new_method_call(
+                secureBoot.busName.c_str(), secureBoot.objectPath.c_str(),
+                "xyz.openbmc_project.BIOSConfig.SecureBootDatabase."
+                "AddSignature",
+                "Add");
+            // Signatures must be unique
+            m.append("signature-" + std::to_string(random()) + '-' +
+                         std::to_string(workload.signatures++),
+                     SignatureFormat::Unspecified);
+            sdbusplus::message::object_path path;
+            bus.call(m).read(path);
+            return true;
+        }
+        case Operation::getAll:
+        {
+            std::string path = takeInstalled(workload, random, false);
+            if (path.empty())
+            {
+                return false;
+            }
+            auto m = bus.new_method_call(authority.busName.c_str(),
+                                         path.c_str(),
+                                         "org.freedesktop.DBus.Properties",
+                                         "GetAll");
+            m.append("xyz.openbmc_project.Certs.Certificate");
+            bus.call(m);
+            return true;
+        }
+        case Operation::getManagedObjects:
+        {
+            auto m = bus.new_method_call(
+                authority.busName.c_str(), authority.objectPath.c_str(),
+                "org.freedesktop.DBus.ObjectManager", "GetManagedObjects");
+            bus.call(m);
+            return true;
+        }
+    }
+    return false;
+}
+
+/** @brief Call operations drawn from |weights| until |deadline| */
+Results runClient(const std::string& address, Workload& workload,
+                  const std::vector<unsigned>& weights, uint64_t seed,
+                  Clock::time_point deadline)
+{
+    auto bus = openBus(address);
+    std::mt19937_64 random(seed);
+    std::discrete_distribution<size_t> pick(weights.begin(), weights.end());
+    Results results;
+    while (Clock::now() < deadline)
+    {
+        auto operation = static_cast<Operation>(pick(random));
+        Samples& samples = results[static_cast<size_t>(operation)];
+        auto begin = Clock::now();
+        try
+        {
+            if (!call(bus, workload, operation, random))
+            {
+                continue;
+            }
+        }
+        catch (const sdbusplus::exception_t&)
+        {
+            // NotAllowed once the authorities limit is reached, or calls
+            // on objects another client just removed
+            ++samples.errors;
+        }
+        samples.latencies.push_back(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                Clock::now() - begin)
+                .count());
+    }
+    return results;
+}
+
+/** @brief Wait until every endpoint owns its bus name */
+void waitForService(const std::string& address,
+                    const std::vector<Endpoint>& endpoints)
+{
+    auto bus = openBus(address);
+    auto deadline = Clock::now() + std::chrono::seconds(60);
+    for (const auto& endpoint : endpoints)
+    {
+        bool owned = false;
+        while (!owned)
+        {
+            if (Clock::now() > deadline)
+            {
+                throw std::runtime_error("Timed out waiting for " +
+                                         endpoint.busName);
+            }
+            auto m = bus.new_method_call(
+                "org.freedesktop.DBus", "/org/freedesktop/DBus",
+                "org.freedesktop.DBus", "NameHasOwner");
+            m.append(endpoint.busName);
+            bus.call(m).read(owned);
+            if (!owned)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            }
+        }
+    }
+}
+
+/** @brief Parse "name=weight,..." into a weight per operation */
+std::vector<unsigned> parseMix(const std::string& mix)
+{
+    std::vector<unsigned> weights(operationNames.size(), 0);
+    std::stringstream stream(mix);
+    std::string item;
+    while (std::getline(stream, item, ','))
+    {
+        auto separator = item.find('=');
+        std::string name = item.substr(0, separator);
+        auto it = std::find(operationNames.begin(), operationNames.end(),
+                            name);
+        if (it == operationNames.end() || separator == std::string::npos)
+        {
+            throw std::invalid_argument("Invalid mix entry: " + item);
+        }
+        weights[static_cast<size_t>(it - operationNames.begin())] =
+            static_cast<unsigned>(std::stoul(item.substr(separator + 1)));
+    }
+    if (std::all_of(weights.begin(), weights.end(),
+                    [](unsigned weight) { return weight == 0; }))
+    {
+        throw std::invalid_argument("Empty mix");
+    }
+    return weights;
+}
+
+double percentile(const std::vector<int64_t>& sorted, double p)
+{
+    if (sorted.empty())
+    {
+        return 0;
+    }
+    auto rank = static_cast<size_t>(
+        std::ceil(p * static_cast<double>(sorted.size())));
+    return static_cast<double>(sorted[std::max<size_t>(rank, 1) - 1]) / 1000;
+}
+
+void report(Results& results, double seconds)
+{
+    std::printf("%-18s %9s %7s %10s %10s %10s %10s\n", "operation", "calls",
+                "errors", "ops/s", "p50 us", "p99 us", "p999 us");
+    std::vector<int64_t> all;
+    uint64_t errors = 0;
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        auto& latencies = results[i].latencies;
+        std::sort(latencies.begin(), latencies.end());
+        all.insert(all.end(), latencies.begin(), latencies.end());
+        errors += results[i].errors;
+        std::printf("%-18s %9zu %7lu %10.1f %10.1f %10.1f %10.1f\n",
+                    operationNames[i], latencies.size(),
+                    static_cast<unsigned long>(results[i].errors),
+                    static_cast<double>(latencies.size()) / seconds,
+                    percentile(latencies, 0.5), percentile(latencies, 0.99),
+                    percentile(latencies, 0.999));
+    }
+    std::sort(all.begin(), all.end());
+    std::printf("%-18s %9zu %7lu %10.1f %10.1f %10.1f %10.1f\n", "total",
+                all.size(), static_cast<unsigned long>(errors),
+                static_cast<double>(all.size()) / seconds,
+                percentile(all, 0.5), percentile(all, 0.99),
+                percentile(all, 0.999));
+}
+
+int run(int argc, char** argv)
+{
+    std::string daemon = "dbus-daemon";
+    size_t clients = 4;
+    double duration = 10;
+    std::string mix = defaultMix;
+    uint64_t seed = 1;
+
+    CLI::App app{"D-Bus load generator for phosphor-certificate-manager"};
+    app.add_option("--dbus-daemon", daemon, "dbus-daemon program")
+        ->capture_default_str();
+    app.add_option("-c,--clients", clients, "Concurrent clients")
+        ->capture_default_str();
+    app.add_option("-d,--duration", duration, "Duration in seconds")
+        ->capture_default_str();
+    app.add_option("--mix", mix,
+                   "Weight of each operation: install, installAll, "
+                   "replaceAll, delete, generateCSR, addSignature, getAll "
+                   "and getManagedObjects")
+        ->capture_default_str();
+    app.add_option("--seed", seed, "Seed of the certificates and the calls")
+        ->capture_default_str();
+    CLI11_PARSE(app, argc, argv);
+    std::vector<unsigned> weights = parseMix(mix);
+
+    char dirTemplate[] = "/tmp/FakeCerts.XXXXXX";
+    if (mkdtemp(dirTemplate) == nullptr)
+    {
+        throw std::system_error(errno, std::generic_category(), "mkdtemp");
+    }
+    fs::path dir = dirTemplate;
+
+    Workload workload;
+    workload.server = makeEndpoint(CertificateType::server, "https", dir,
+                                   "https/server.pem");
+    workload.authority = makeEndpoint(CertificateType::authority,
+                                      "truststore", dir, "authority");
+    workload.secureBoot = makeEndpoint(CertificateType::securebootDatabase,
+                                       "db", dir, "db");
+    std::vector<Endpoint> endpoints{workload.server, workload.authority,
+                                    workload.secureBoot};
+
+    // Authorities are typically RSA 2048 roots
+    corpus::Generator generator(seed);
+    fs::create_directories(dir / "upload");
+    size_t index = 0;
+    for (const auto& authority :
+         generator.authorities(4 * maxNumAuthorityCertificates,
+                               corpus::KeyType::rsa2048))
+    {
+        std::string path = dir / "upload" / std::to_string(index++);
+        corpus::writeFile(path, authority);
+        workload.certificates.emplace_back(path);
+    }
+    workload.bundle = dir / "upload" / "bundle";
+    corpus::writeFile(workload.bundle,
+                      generator.authorities(maxNumAuthorityCertificates / 2,
+                                            corpus::KeyType::rsa2048));
+
+    int status = EXIT_SUCCESS;
+    {
+        PrivateBus bus(daemon, dir);
+        // Fork before any thread is started
+        pid_t service = fork();
+        if (service == 0)
+        {
+            serve(bus.address, endpoints);
+        }
+        try
+        {
+            waitForService(bus.address, endpoints);
+
+            std::vector<Results> clientResults(clients);
+            std::vector<std::thread> threads;
+            auto begin = Clock::now();
+            auto deadline = begin +
+                            std::chrono::duration_cast<Clock::duration>(
+                                std::chrono::duration<double>(duration));
+            for (size_t i = 0; i < clients; ++i)
+            {
+                threads.emplace_back([&, i] {
+                    clientResults[i] = runClient(bus.address, workload,
+                                                 weights, seed + i, deadline);
+                });
+            }
+            for (auto& thread : threads)
+            {
+                thread.join();
+            }
+            double seconds = std::chrono::duration<double>(Clock::now() -
+                                                           begin)
+                                 .count();
+
+            Results results;
+            for (auto& client : clientResults)
+            {
+                for (size_t i = 0; i < results.size(); ++i)
+                {
+                    auto& latencies = results[i].latencies;
+                    latencies.insert(latencies.end(),
+                                     client[i].latencies.begin(),
+                                     client[i].latencies.end());
+                    results[i].errors += client[i].errors;
+                }
+            }
+            std::printf("%zu clients, %.1f s\n", clients, seconds);
+            report(results, seconds);
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << e.what() << std::endl;
+            status = EXIT_FAILURE;
+        }
+        kill(service, SIGTERM);
+        waitpid(service, nullptr, 0);
+    }
+    fs::remove_all(dir);
+    return status;
+}
+
+} // namespace
+} // namespace phosphor::certs::load
+
+int main(int argc, char** argv)
+{
+    return phosphor::certs::load::run(argc, argv);
+}
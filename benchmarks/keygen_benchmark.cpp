@@ -0,0 +1,101 @@
+#include "keygen.hpp"
+
+#include <openssl/bio.h>
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+#include <openssl/x509.h>
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include <benchmark/benchmark.h>
+
+namespace phosphor::certs
+{
+namespace
+{
+
+using EVPPkeyPtr = std::unique_ptr<EVP_PKEY, decltype(&::EVP_PKEY_free)>;
+using KeyGenerator = std::function<EVPPkeyPtr()>;
+
+/** @brief Build, sign and PEM encode a CSR the way generateCSRHelper() does
+ */
+void buildCSR(EVP_PKEY& pKey)
+{
+    std::unique_ptr<X509_REQ, decltype(&::X509_REQ_free)> req(
+        X509_REQ_new(), ::X509_REQ_free);
+    X509_NAME* name = X509_REQ_get_subject_name(req.get());
+    X509_NAME_add_entry_by_txt(
+        name, "CN", MBSTRING_ASC,
+        reinterpret_cast<const unsigned char*>("bmc.example.com"), -1, -1, 0);
+    std::unique_ptr<BIO, decltype(&::BIO_free)> bio(BIO_new(BIO_s_mem()),
+                                                    ::BIO_free);
+    if (X509_REQ_set_pubkey(req.get(), &pKey) != 1 ||
+        X509_REQ_sign(req.get(), &pKey, getSigningDigest(pKey)) <= 0 ||
+        PEM_write_bio_X509_REQ(bio.get(), req.get()) != 1)
+    {
+        throw std::runtime_error("Unable to build CSR");
+    }
+    benchmark::DoNotOptimize(BIO_pending(bio.get()));
+}
+
+void keyGen(benchmark::State& state, const KeyGenerator& generate)
+{
+    for (auto _ : state)
+    {
+        auto pKey = generate();
+        benchmark::DoNotOptimize(pKey.get());
+    }
+}
+
+// Key generation plus CSR signing: what a generateCSR call waits for.
+void csr(benchmark::State& state, const KeyGenerator& generate)
+{
+    for (auto _ : state)
+    {
+        auto pKey = generate();
+        buildCSR(*pKey);
+    }
+}
+
+// CSR signing alone, as with the pre-generated RSA key.
+void csrSign(benchmark::State& state, const KeyGenerator& generate)
+{
+    auto pKey = generate();
+    for (auto _ : state)
+    {
+        buildCSR(*pKey);
+    }
+}
+
+const KeyGenerator rsa3072 = [] { return generateRSAKeyPair(3072); };
+const KeyGenerator p256 = [] { return generateECKeyPair("prime256v1"); };
+const KeyGenerator p384 = [] { return generateECKeyPair("secp384r1"); };
+const KeyGenerator ed25519 = [] { return generateEd25519KeyPair(); };
+
+// RSA keygen takes seconds on a BMC; keep the iteration count small.
+BENCHMARK_CAPTURE(keyGen, RSA3072, rsa3072)
+    ->Unit(benchmark::kMillisecond)
+    ->Iterations(5);
+BENCHMARK_CAPTURE(keyGen, P256, p256)->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(keyGen, P384, p384)->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(keyGen, Ed25519, ed25519)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_CAPTURE(csr, RSA3072, rsa3072)
+    ->Unit(benchmark::kMillisecond)
+    ->Iterations(5);
+BENCHMARK_CAPTURE(csr, P256, p256)->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(csr, P384, p384)->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(csr, Ed25519, ed25519)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_CAPTURE(csrSign, RSA3072, rsa3072)->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(csrSign, P384, p384)->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(csrSign, Ed25519, ed25519)->Unit(benchmark::kMicrosecond);
+
+} // namespace
+} // namespace phosphor::certs
+
+BENCHMARK_MAIN();
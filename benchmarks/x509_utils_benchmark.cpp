@@ -0,0 +1,286 @@
+#include "corpus.hpp"
+#include "x509_utils.hpp"
+
+#include <openssl/x509.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+namespace phosphor::certs
+{
+namespace
+{
+
+namespace fs = std::filesystem;
+using corpus::KeyType;
+
+/** @brief A directory of stored authorities, in one storage format
+ */
+class Store
+{
+  public:
+    Store(StorageFormat format, size_t count, KeyType keyType)
+    {
+        char dirTemplate[] = "/tmp/FakeCerts.XXXXXX";
+        if (mkdtemp(dirTemplate) == nullptr)
+        {
+            throw std::runtime_error("Unable to create the store");
+        }
+        dir = dirTemplate;
+        corpus::Generator generator;
+        auto authorities = generator.authorities(count, keyType);
+        for (size_t i = 0; i < count; ++i)
+        {
+            std::string path = dir / std::to_string(i);
+            std::ofstream(path, std::ios::binary)
+                << encodeCertificate(*authorities[i].cert, format);
+            files.emplace_back(path);
+            bytes += fs::file_size(path);
+        }
+    }
+
+    ~Store()
+    {
+        fs::remove_all(dir);
+    }
+
+    Store(const Store&) = delete;
+    Store& operator=(const Store&) = delete;
+
+    fs::path dir;
+    std::vector<std::string> files;
+    size_t bytes = 0;
+};
+
+void parse(benchmark::State& state, KeyType keyType)
+{
+    auto cert = corpus::Generator().root("bmc.example.com", keyType).cert;
+    std::string pem = encodeCertificate(*cert, StorageFormat::pem);
+    for (auto _ : state)
+    {
+        auto parsed = parseCert(pem);
+        benchmark::DoNotOptimize(parsed.get());
+    }
+    state.SetBytesProcessed(state.iterations() *
+                            static_cast<int64_t>(pem.size()));
+}
+
+void load(benchmark::State& state, KeyType keyType, StorageFormat format)
+{
+    Store store(format, 1, keyType);
+    for (auto _ : state)
+    {
+        auto cert = loadCert(store.files.front());
+        benchmark::DoNotOptimize(cert.get());
+    }
+    state.SetBytesProcessed(state.iterations() *
+                            static_cast<int64_t>(store.bytes));
+}
+
+void loadPEM(benchmark::State& state, KeyType keyType)
+{
+    load(state, keyType, StorageFormat::pem);
+}
+
+void loadDER(benchmark::State& state, KeyType keyType)
+{
+    load(state, keyType, StorageFormat::der);
+}
+
+void x509Store(benchmark::State& state, KeyType keyType)
+{
+    Store store(StorageFormat::pem, 1, keyType);
+    for (auto _ : state)
+    {
+        auto x509Store = getX509Store(store.files.front());
+        benchmark::DoNotOptimize(x509Store.get());
+    }
+}
+
+void validate(benchmark::State& state, KeyType keyType)
+{
+    Store store(StorageFormat::pem, 1, keyType);
+    auto x509Store = getX509Store(store.files.front());
+    auto cert = loadCert(store.files.front());
+    for (auto _ : state)
+    {
+        validateCertificateAgainstStore(*x509Store, *cert);
+    }
+}
+
+void sslContext(benchmark::State& state, KeyType keyType)
+{
+    auto cert = corpus::Generator().root("bmc.example.com", keyType).cert;
+    for (auto _ : state)
+    {
+        validateCertificateInSSLContext(*cert);
+    }
+}
+
+void certId(benchmark::State& state, KeyType keyType)
+{
+    auto cert = corpus::Generator().root("bmc.example.com", keyType).cert;
+    for (auto _ : state)
+    {
+        auto id = generateCertId(*cert);
+        benchmark::DoNotOptimize(id);
+    }
+}
+
+// What Certificate::populateProperties() costs, less the D-Bus updates
+void extract(benchmark::State& state, KeyType keyType)
+{
+    // A server certificate, with extended key usages
+    corpus::Generator generator;
+    auto root = generator.root("root", keyType);
+    auto cert = generator.leaf(root, "bmc.example.com", keyType).cert;
+    for (auto _ : state)
+    {
+        auto properties = extractProperties(*cert);
+        benchmark::DoNotOptimize(properties);
+    }
+}
+
+void name(benchmark::State& state)
+{
+    auto cert = corpus::Generator().root("bmc.example.com").cert;
+    for (auto _ : state)
+    {
+        auto subject = formatName(*X509_get_subject_name(cert.get()));
+        benchmark::DoNotOptimize(subject);
+    }
+}
+
+/** @brief An authorities list file, as installAll() and replaceAll() get it
+ */
+class Bundle
+{
+  public:
+    Bundle(StorageFormat format, size_t count)
+    {
+        char fileTemplate[] = "/tmp/FakeCerts.XXXXXX";
+        int fd = mkstemp(fileTemplate);
+        if (fd == -1)
+        {
+            throw std::runtime_error("Unable to create the bundle");
+        }
+        close(fd);
+        path = fileTemplate;
+        // Authorities are typically RSA 2048 roots
+        corpus::writeFile(
+            path, corpus::Generator().authorities(count, KeyType::rsa2048),
+            format);
+    }
+
+    ~Bundle()
+    {
+        fs::remove(path);
+    }
+
+    Bundle(const Bundle&) = delete;
+    Bundle& operator=(const Bundle&) = delete;
+
+    std::string path;
+};
+
+void bundle(benchmark::State& state, StorageFormat format)
+{
+    Bundle bundle(format, static_cast<size_t>(state.range(0)));
+    for (auto _ : state)
+    {
+        auto certs = loadCertificates(bundle.path);
+        benchmark::DoNotOptimize(certs.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.SetBytesProcessed(state.iterations() *
+                            static_cast<int64_t>(fs::file_size(bundle.path)));
+}
+
+void bundleStore(benchmark::State& state)
+{
+    Bundle bundle(StorageFormat::pem, static_cast<size_t>(state.range(0)));
+    auto certs = loadCertificates(bundle.path);
+    for (auto _ : state)
+    {
+        auto x509Store = getX509Store(certs);
+        benchmark::DoNotOptimize(x509Store.get());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// What restoring a stored authority costs, Certificate::validateFile() and
+// the property extraction
+void restore(benchmark::State& state, StorageFormat format)
+{
+    // Authorities are typically RSA 2048 roots
+    Store store(format, static_cast<size_t>(state.range(0)),
+                KeyType::rsa2048);
+    for (auto _ : state)
+    {
+        for (const auto& file : store.files)
+        {
+            auto x509Store = getX509Store(file);
+            auto cert = loadCert(file);
+            validateCertificateAgainstStore(*x509Store, *cert);
+            auto properties = extractProperties(*cert);
+            benchmark::DoNotOptimize(properties);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.counters["flash_bytes"] = static_cast<double>(store.bytes);
+    state.counters["bytes_per_cert"] = static_cast<double>(store.bytes) /
+                                       static_cast<double>(state.range(0));
+}
+
+// Registers |function| once per key type
+#define KEY_BENCHMARK(function)                                                \
+    BENCHMARK_CAPTURE(function, RSA2048, KeyType::rsa2048)                     \
+        ->Unit(benchmark::kMicrosecond);                                       \
+    BENCHMARK_CAPTURE(function, RSA3072, KeyType::rsa3072)                     \
+        ->Unit(benchmark::kMicrosecond);                                       \
+    BENCHMARK_CAPTURE(function, RSA4096, KeyType::rsa4096)                     \
+        ->Unit(benchmark::kMicrosecond);                                       \
+    BENCHMARK_CAPTURE(function, P256, KeyType::p256)                           \
+        ->Unit(benchmark::kMicrosecond);                                       \
+    BENCHMARK_CAPTURE(function, P384, KeyType::p384)                           \
+        ->Unit(benchmark::kMicrosecond)
+
+KEY_BENCHMARK(parse);
+KEY_BENCHMARK(loadPEM);
+KEY_BENCHMARK(loadDER);
+KEY_BENCHMARK(x509Store);
+KEY_BENCHMARK(validate);
+KEY_BENCHMARK(sslContext);
+KEY_BENCHMARK(certId);
+KEY_BENCHMARK(extract);
+BENCHMARK(name)->Unit(benchmark::kNanosecond);
+BENCHMARK_CAPTURE(bundle, PEM, StorageFormat::pem)
+    ->RangeMultiplier(4)
+    ->Range(1, 1024)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(bundle, DER, StorageFormat::der)
+    ->RangeMultiplier(4)
+    ->Range(1, 1024)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(bundleStore)
+    ->RangeMultiplier(4)
+    ->Range(1, 1024)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(restore, PEM, StorageFormat::pem)
+    ->Arg(10)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(restore, DER, StorageFormat::der)
+    ->Arg(10)
+    ->Unit(benchmark::kMicrosecond);
+
+} // namespace
+} // namespace phosphor::certs
+
+BENCHMARK_MAIN();
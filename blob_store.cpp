@@ -0,0 +1,117 @@
+#include "blob_store.hpp"
+
+#include "file_content.hpp"
+#include "metrics.hpp"
+
+#include <phosphor-logging/lg2.hpp>
+
+#include <system_error>
+
+namespace phosphor::certs
+{
+
+namespace fs = std::filesystem;
+
+namespace
+{
+
+/** @brief Write a blob with writeFileAtomically(), whose temporary file is
+ *  private to the process, so that the blob is never seen partially written
+ */
+bool writeBlob(const fs::path& blob, const std::string& data)
+{
+    try
+    {
+        writeFileAtomically(blob, data);
+    }
+    catch (const std::system_error& e)
+    {
+        lg2::error("Failed to write blob, BLOB:{BLOB}, ERR:{ERR}", "BLOB",
+                   blob, "ERR", e);
+        return false;
+    }
+    metrics::count(metrics::Counter::bytesWritten, data.size());
+    return true;
+}
+
+} // namespace
+
+BlobStore::BlobStore(const fs::path& directory) : directory(directory)
+{
+    fs::create_directories(directory);
+    fs::permissions(directory,
+                    fs::perms::owner_read | fs::perms::owner_write |
+                        fs::perms::owner_exec,
+                    fs::perm_options::replace);
+}
+
+bool BlobStore::link(const std::string& name, const std::string& data,
+                     const std::string& filePath) const
+{
+    fs::path blob = directory / name;
+    std::error_code ec;
+    if (fs::equivalent(blob, filePath, ec))
+    {
+        // Already stored as a link to the blob
+        return true;
+    }
+
+    std::string tempFilePath = filePath + ".tmp";
+    // Another endpoint may collect the blob between its creation and the
+    // link; create it again then
+    for (int attempt = 0; attempt < 2; ++attempt)
+    {
+        if (!fs::exists(blob, ec) && !writeBlob(blob, data))
+        {
+            return false;
+        }
+        fs::remove(tempFilePath, ec);
+        fs::create_hard_link(blob, tempFilePath, ec);
+        if (!ec)
+        {
+            fs::rename(tempFilePath, filePath, ec);
+            if (ec)
+            {
+                fs::remove(tempFilePath, ec);
+                break;
+            }
+            return true;
+        }
+        if (ec != std::errc::no_such_file_or_directory)
+        {
+            break;
+        }
+    }
+
+    // EXDEV for an endpoint on another file system than the store
+    lg2::info("Certificate not linked to the blob store, FILE:{FILE}, "
+              "ERR:{ERR}",
+              "FILE", filePath, "ERR", ec.message());
+    return false;
+}
+
+void BlobStore::collectGarbage() const
+{
+    std::error_code ec;
+    for (fs::directory_iterator it(directory, ec), end; !ec && it != end;
+         it.increment(ec))
+    {
+        // Skip the blobs being written
+        std::error_code entryEc;
+        if (it->path().extension() != ".tmp" &&
+            it->is_regular_file(entryEc) &&
+            fs::hard_link_count(it->path(), entryEc) == 1)
+        {
+            lg2::debug("Removing unused blob, BLOB:{BLOB}", "BLOB",
+                       it->path());
+            fs::remove(it->path(), entryEc);
+        }
+    }
+    if (ec)
+    {
+        lg2::error("Failed to scan the blob store, DIR:{DIR}, ERR:{ERR}",
+                   "DIR", directory, "ERR", ec.message());
+    }
+}
+
+} // namespace phosphor::certs
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+
+namespace phosphor::certs
+{
+
+/** @class BlobStore
+ *  @brief Content addressed certificate files shared by all the endpoints.
+ *  @details Each blob is named after the fingerprint of the certificate it
+ *  holds, and endpoints store a certificate as a hard link to its blob, so a
+ *  certificate installed on several endpoints takes its space on flash once.
+ *  The link count of a blob is its reference count: a blob only linked from
+ *  the store directory is unused and removed by collectGarbage().
+ *
+ *  Endpoints run in separate processes; no locking is needed since the worst
+ *  outcome of a race is a blob removed while being linked, which link()
+ *  recovers from, or an endpoint file that ends up not shared.
+ */
+class BlobStore
+{
+  public:
+    BlobStore() = delete;
+    BlobStore(const BlobStore&) = delete;
+    BlobStore& operator=(const BlobStore&) = delete;
+    BlobStore(BlobStore&&) = delete;
+    BlobStore& operator=(BlobStore&&) = delete;
+    ~BlobStore() = default;
+
+    /** @brief Constructor
+     *  @param[in] directory - Directory of the blobs; created if missing.
+     *  @throws std::filesystem::filesystem_error if it can't be created.
+     */
+    explicit BlobStore(const std::filesystem::path& directory);
+
+    /** @brief Store a certificate file as a link to its blob
+     *  @details The blob is created from |data| if there is none yet, and
+     *  |filePath| is atomically replaced by a hard link to it.
+     *  @param[in] name - Name of the blob, unique to the content.
+     *  @param[in] data - Content of the file.
+     *  @param[in] filePath - Path of the endpoint's file.
+     *  @return false if the file could not be linked, e.g. because it is on
+     *  another file system; the caller writes a private copy then.
+     */
+    bool link(const std::string& name, const std::string& data,
+              const std::string& filePath) const;
+
+    /** @brief Remove the blobs no endpoint file links to anymore
+     */
+    void collectGarbage() const;
+
+    /** @brief Get the directory of the blobs */
+    const std::filesystem::path& getDirectory() const
+    {
+        return directory;
+    }
+
+  private:
+    /** @brief Directory of the blobs */
+    std::filesystem::path directory;
+};
+
+} // namespace phosphor::certs
@@ -32,7 +32,7 @@ sdbusplus::message::object_path CACertMgr::signCSR(std::string csr)
             elog<InvalidArgument>(Argument::ARGUMENT_NAME("CSR"),
                                   Argument::ARGUMENT_VALUE(csr.c_str()));
         }
-        auto id = lastEntryId + 1;
+        auto id = static_cast<uint32_t>(entryIds.allocate());
         objPath = fs::path(objectNamePrefix) / "ca" / "entry" /
                   std::to_string(id);
         std::string cert;
@@ -41,7 +41,6 @@ sdbusplus::message::object_path CACertMgr::signCSR(std::string csr)
         // the certificate string would be updated with actual certificate.
         entries.insert(std::make_pair(
             id, std::make_unique<Entry>(bus, objPath, id, csr, cert, *this)));
-        lastEntryId++;
     }
     catch (const std::invalid_argument& e)
     {
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "ca_cert_entry.hpp"
+#include "id_allocator.hpp"
 #include "xyz/openbmc_project/Certs/Authority/server.hpp"
 #include "xyz/openbmc_project/Collection/DeleteAll/server.hpp"
 
@@ -38,8 +39,7 @@ class CACertMgr : public internal::ManagerInterface
      *  @param[in] path - Path to attach at.
      */
     CACertMgr(sdbusplus::bus_t& bus, const char* path) :
-        internal::ManagerInterface(bus, path), bus(bus), objectPath(path),
-        lastEntryId(0){};
+        internal::ManagerInterface(bus, path), bus(bus), objectPath(path){};
 
     /** @brief This method provides signing authority functionality.
                It signs the certificate and creates the CSR request entry Dbus
@@ -66,8 +66,11 @@ class CACertMgr : public internal::ManagerInterface
     sdbusplus::bus_t& bus;
     /** @brief object path */
     std::string objectPath;
-    /** @brief Id of the last certificate entry */
-    uint32_t lastEntryId;
+    /** @brief Certificate entry ID pool
+     *  IDs are not released on erase so that a hypervisor still signing a
+     *  deleted entry can never complete a newer entry with the same ID.
+     */
+    phosphor::certs::IdAllocator entryIds;
 };
 
 } // namespace ca::cert
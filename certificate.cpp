@@ -2,20 +2,21 @@
 
 #include "certificate.hpp"
 
+#include "blob_store.hpp"
 #include "certs_manager.hpp"
+#include "file_content.hpp"
 #include "lsp.hpp"
+#include "memory_usage.hpp"
+#include "metrics.hpp"
+#include "startup_trace.hpp"
+#include "tracepoints.hpp"
 #include "x509_utils.hpp"
 
-#include <openssl/asn1.h>
 #include <openssl/bio.h>
-#include <openssl/buffer.h>
 #include <openssl/err.h>
 #include <openssl/evp.h>
-#include <openssl/obj_mac.h>
-#include <openssl/objects.h>
 #include <openssl/opensslv.h>
 #include <openssl/pem.h>
-#include <openssl/x509v3.h>
 
 #include <phosphor-logging/elog-errors.hpp>
 #include <phosphor-logging/elog.hpp>
@@ -24,13 +25,15 @@
 #include <xyz/openbmc_project/Certs/error.hpp>
 #include <xyz/openbmc_project/Common/error.hpp>
 
+#include <cinttypes>
 #include <cstdint>
 #include <cstdio>
 #include <cstdlib>
 #include <exception>
 #include <filesystem>
 #include <fstream>
-#include <map>
+#include <optional>
+#include <system_error>
 #include <utility>
 #include <vector>
 
@@ -45,73 +48,14 @@ using InvalidCertificateError =
     ::sdbusplus::xyz::openbmc_project::Certs::Error::InvalidCertificate;
 using ::phosphor::logging::xyz::openbmc_project::Certs::InvalidCertificate;
 using ::sdbusplus::xyz::openbmc_project::Common::Error::InternalFailure;
+using ::sdbusplus::xyz::openbmc_project::Association::server::Definitions;
 using ::sdbusplus::xyz::openbmc_project::Common::server::UUID;
 
 // RAII support for openSSL functions.
 using BIOMemPtr = std::unique_ptr<BIO, decltype(&::BIO_free)>;
 using X509StorePtr = std::unique_ptr<X509_STORE, decltype(&::X509_STORE_free)>;
-using ASN1TimePtr = std::unique_ptr<ASN1_TIME, decltype(&ASN1_STRING_free)>;
 using EVPPkeyPtr = std::unique_ptr<EVP_PKEY, decltype(&::EVP_PKEY_free)>;
-using BufMemPtr = std::unique_ptr<BUF_MEM, decltype(&::BUF_MEM_free)>;
-
-// Refer to schema 2018.3
-// http://redfish.dmtf.org/schemas/v1/Certificate.json#/definitions/KeyUsage for
-// supported KeyUsage types in redfish
-// Refer to
-// https://github.com/openssl/openssl/blob/master/include/openssl/x509v3.h for
-// key usage bit fields
-std::map<uint8_t, std::string> keyUsageToRfStr = {
-    {KU_DIGITAL_SIGNATURE, "DigitalSignature"},
-    {KU_NON_REPUDIATION, "NonRepudiation"},
-    {KU_KEY_ENCIPHERMENT, "KeyEncipherment"},
-    {KU_DATA_ENCIPHERMENT, "DataEncipherment"},
-    {KU_KEY_AGREEMENT, "KeyAgreement"},
-    {KU_KEY_CERT_SIGN, "KeyCertSign"},
-    {KU_CRL_SIGN, "CRLSigning"},
-    {KU_ENCIPHER_ONLY, "EncipherOnly"},
-    {KU_DECIPHER_ONLY, "DecipherOnly"}};
-
-// Refer to schema 2018.3
-// http://redfish.dmtf.org/schemas/v1/Certificate.json#/definitions/KeyUsage for
-// supported Extended KeyUsage types in redfish
-std::map<uint8_t, std::string> extendedKeyUsageToRfStr = {
-    {NID_server_auth, "ServerAuthentication"},
-    {NID_client_auth, "ClientAuthentication"},
-    {NID_email_protect, "EmailProtection"},
-    {NID_OCSP_sign, "OCSPSigning"},
-    {NID_ad_timeStamping, "Timestamping"},
-    {NID_code_sign, "CodeSigning"}};
-
-/**
- * @brief Dumps the PEM encoded certificate to installFilePath
- *
- * @param[in] pem - PEM encoded X509 certificate buffer.
- * @param[in] certFilePath - Path to the destination file.
- *
- * @return void
- */
-
-void dumpCertificate(const std::string& pem, const std::string& certFilePath)
-{
-    std::ofstream outputCertFileStream;
-
-    outputCertFileStream.exceptions(
-        std::ofstream::failbit | std::ofstream::badbit | std::ofstream::eofbit);
 
-    try
-    {
-        outputCertFileStream.open(certFilePath, std::ios::out);
-        outputCertFileStream << pem << "\n" << std::flush;
-        outputCertFileStream.close();
-    }
-    catch (const std::exception& e)
-    {
-        lg2::error(
-            "Failed to dump certificate, ERR:{ERR}, SRC_PEM:{SRC_PEM}, DST:{DST}",
-            "ERR", e, "SRC_PEM", pem, "DST", certFilePath);
-        elog<InternalFailure>();
-    }
-}
 } // namespace
 
 void Certificate::copyCertificate(const std::string& certSrcFilePath,
@@ -132,9 +76,17 @@ void Certificate::copyCertificate(const std::string& certSrcFilePath,
                                         std::ofstream::eofbit);
         try
         {
+            // Don't write through a link shared with other endpoints
+            if (fs::exists(certFilePath) &&
+                fs::hard_link_count(certFilePath) > 1)
+            {
+                fs::remove(certFilePath);
+            }
             inputCertFileStream.open(certSrcFilePath);
             outputCertFileStream.open(certFilePath, std::ios::out);
             outputCertFileStream << inputCertFileStream.rdbuf() << std::flush;
+            metrics::count(metrics::Counter::bytesWritten,
+                           static_cast<uint64_t>(outputCertFileStream.tellp()));
             inputCertFileStream.close();
             outputCertFileStream.close();
         }
@@ -148,6 +100,24 @@ void Certificate::copyCertificate(const std::string& certSrcFilePath,
     }
 }
 
+void Certificate::dumpCertificate(const std::string& data,
+                                  const std::string& certFilePath)
+{
+    // Converting a stored file in place never leaves it truncated, a power
+    // loss included
+    try
+    {
+        writeFileAtomically(certFilePath, data);
+        metrics::count(metrics::Counter::bytesWritten, data.size());
+    }
+    catch (const std::exception& e)
+    {
+        lg2::error("Failed to dump certificate, ERR:{ERR}, DST:{DST}", "ERR", e,
+                   "DST", certFilePath);
+        elog<InternalFailure>();
+    }
+}
+
 std::string
     Certificate::generateUniqueFilePath(const std::string& directoryPath)
 {
@@ -195,119 +165,136 @@ std::string
 {
     // If there is a certificate file path (which means certificate replacement
     // is doing) use it (do not create new one)
-    if (!certFilePath.empty())
+    if (!certFileName.empty())
     {
-        return certFilePath;
+        return getCertFilePath();
     }
     // If source certificate file is located in the certificates directory use
     // it (do not create new one)
     else if (fs::path(certSrcFilePath).parent_path().string() ==
-             certInstallPath)
+             *certInstallPath)
     {
         return certSrcFilePath;
     }
     // Otherwise generate new file name/path
     else
     {
-        return generateUniqueFilePath(certInstallPath);
+        return generateUniqueFilePath(*certInstallPath);
     }
 }
 
 std::string
     Certificate::generateCertFilePath(const std::string& certSrcFilePath)
 {
-    if ((certType == CertificateType::authority) ||
-        (certType == CertificateType::authorityBios))
+    if (policy().hashLinked)
     {
         return generateAuthCertFilePath(certSrcFilePath);
     }
-    else if (certType == CertificateType::securebootDatabase)
-    {
-        return certInstallPath + "/" + fs::path(objectPath).filename().c_str();
-    }
     else
     {
-        return certInstallPath;
+        return getCertFilePath();
     }
 }
 
 Certificate::Certificate(sdbusplus::bus_t& bus, const std::string& objPath,
-                         CertificateType type, const std::string& installPath,
+                         uint64_t id, CertificateType type,
+                         const std::string& installPath,
                          const std::string& uploadPath, Watch* watch,
                          Manager& parent, bool restore) :
     internal::CertificateInterface(
         bus, objPath.c_str(),
         internal::CertificateInterface::action::defer_emit),
-    objectPath(objPath), certType(type), certInstallPath(installPath),
+    objectId(id), certType(type), certInstallPath(intern(installPath)),
     certWatch(watch), manager(parent)
 {
-    auto installHelper = [this](const auto& filePath) {
-        if (!compareKeys(filePath))
-        {
-            elog<InvalidCertificateError>(InvalidCertificate::REASON(
-                "Private key does not match the Certificate"));
-        };
-    };
-    typeFuncMap[CertificateType::server] = installHelper;
-    typeFuncMap[CertificateType::client] = installHelper;
-    typeFuncMap[CertificateType::authority] = [](const std::string&) {};
-    typeFuncMap[CertificateType::authorityBios] = [](const std::string&) {};
-    typeFuncMap[CertificateType::securebootDatabase] = [](const std::string&) {
-    };
-
-    auto appendPrivateKey = [this](const std::string& filePath) {
-        checkAndAppendPrivateKey(filePath);
-    };
-
-    appendKeyMap[CertificateType::server] = appendPrivateKey;
-    appendKeyMap[CertificateType::client] = appendPrivateKey;
-    appendKeyMap[CertificateType::authority] = [](const std::string&) {};
-    appendKeyMap[CertificateType::authorityBios] = [](const std::string&) {};
-    appendKeyMap[CertificateType::securebootDatabase] = [](const std::string&) {
-    };
-
     // Generate certificate file path
-    certFilePath = generateCertFilePath(uploadPath);
+    setCertFilePath(generateCertFilePath(uploadPath));
 
     // install the certificate
     install(uploadPath, restore);
 
-    if (certType == CertificateType::securebootDatabase)
+    if (policy().hasOwner)
     {
         ownerIntf = std::make_unique<internal::UefiSignatureOwnerIntf>(
-            bus, objectPath, certFilePath + ".owner");
+            bus, objPath, getCertFilePath() + ".owner");
     }
 
-    if (certType == CertificateType::authorityBios)
+    if (policy().hasUUID)
     {
         uuidIntf = std::make_unique<UUID>(bus, objPath.c_str());
     }
 
+    if (policy().hasAssociations)
+    {
+        associationsIntf = std::make_unique<Definitions>(bus, objPath.c_str());
+    }
+
     this->emit_object_added();
 }
 
 Certificate::Certificate(sdbusplus::bus_t& bus, const std::string& objPath,
-                         const CertificateType& type,
+                         uint64_t id, const CertificateType& type,
                          const std::string& installPath, X509_STORE& x509Store,
-                         const std::string& pem, Watch* watchPtr,
-                         Manager& parent, bool restore) :
+                         X509& cert, Watch* watchPtr, Manager& parent,
+                         bool restore) :
     internal::CertificateInterface(
         bus, objPath.c_str(),
         internal::CertificateInterface::action::defer_emit),
-    objectPath(objPath), certType(type), certInstallPath(installPath),
+    objectId(id), certType(type), certInstallPath(intern(installPath)),
     certWatch(watchPtr), manager(parent)
 {
     // Generate certificate file path
-    certFilePath = generateUniqueFilePath(installPath);
+    setCertFilePath(generateUniqueFilePath(installPath));
 
     // install the certificate
-    install(x509Store, pem, restore);
+    install(x509Store, cert, restore);
 
-    this->emit_object_added();
+    if (policy().hasAssociations)
+    {
+        associationsIntf = std::make_unique<Definitions>(bus, objPath.c_str());
+    }
+}
+
+Certificate::Certificate(sdbusplus::bus_t& bus, const std::string& objPath,
+                         uint64_t id, CertificateType type,
+                         const std::string& installPath,
+                         const std::string& filePath, X509& cert,
+                         Watch* watchPtr, Manager& parent) :
+    internal::CertificateInterface(
+        bus, objPath.c_str(),
+        internal::CertificateInterface::action::defer_emit),
+    objectId(id), certType(type), certInstallPath(intern(installPath)),
+    certWatch(watchPtr), manager(parent)
+{
+    lg2::debug("Certificate restore, FILEPATH:{FILEPATH}", "FILEPATH",
+               filePath);
+
+    // Generate certificate file path
+    setCertFilePath(generateCertFilePath(filePath));
+
+    installValidated(cert, filePath);
+
+    if (policy().hasOwner)
+    {
+        ownerIntf = std::make_unique<internal::UefiSignatureOwnerIntf>(
+            bus, objPath, getCertFilePath() + ".owner");
+    }
+
+    if (policy().hasUUID)
+    {
+        uuidIntf = std::make_unique<UUID>(bus, objPath.c_str());
+    }
+
+    if (policy().hasAssociations)
+    {
+        associationsIntf = std::make_unique<Definitions>(bus, objPath.c_str());
+    }
 }
 
 Certificate::~Certificate()
 {
+    manager.unindexCertificate(objectId);
+    auto certFilePath = getCertFilePath();
     if (!fs::remove(certFilePath))
     {
         lg2::info("Certificate file not found! PATH:{PATH}", "PATH",
@@ -322,6 +309,10 @@ void Certificate::replace(const std::string filePath)
 
 void Certificate::install(const std::string& certSrcFilePath, bool restore)
 {
+    CERTS_PROBE(certificate_install_entry, manager.getObjectPath().c_str(),
+                objectId, certSrcFilePath.c_str());
+    CERTS_PROBE_RETURN(certificate_install_return,
+                       manager.getObjectPath().c_str(), objectId);
     if (restore)
     {
         lg2::debug("Certificate install, FILEPATH:{FILEPATH}", "FILEPATH",
@@ -339,20 +330,54 @@ void Certificate::install(const std::string& certSrcFilePath, bool restore)
         certWatch->stopWatch();
     }
 
+    internal::X509Ptr cert = validateFile(certSrcFilePath);
+    manager.validateRevocation(*cert);
+
+    if (!policy().supported)
+    {
+        lg2::error("Unsupported Type, TYPE:{TYPE}", "TYPE",
+                   certificateTypeToString(certType));
+        elog<InternalFailure>();
+    }
+
+    // Append the endpoint's private key if needed, then check they match
+    if (policy().pairedWithPrivateKey)
+    {
+        checkAndAppendPrivateKey(certSrcFilePath);
+        if (!compareKeys(certSrcFilePath))
+        {
+            elog<InvalidCertificateError>(InvalidCertificate::REASON(
+                "Private key does not match the Certificate"));
+        }
+    }
+
+    installValidated(*cert, certSrcFilePath);
+
+    // restart watch
+    if (certWatch != nullptr)
+    {
+        certWatch->startWatch();
+    }
+}
+
+internal::X509Ptr Certificate::validateFile(const std::string& filePath)
+{
     // Verify the certificate file
-    fs::path file(certSrcFilePath);
+    fs::path file(filePath);
     if (!fs::exists(file))
     {
-        lg2::error("File is Missing, FILE:{FILE}", "FILE", certSrcFilePath);
+        lg2::error("File is Missing, FILE:{FILE}", "FILE", filePath);
         elog<InternalFailure>();
     }
 
+    uintmax_t size = 0;
     try
     {
-        if (fs::file_size(certSrcFilePath) == 0)
+        size = fs::file_size(filePath);
+        if (size == 0)
         {
             // file is empty
-            lg2::error("File is empty, FILE:{FILE}", "FILE", certSrcFilePath);
+            lg2::error("File is empty, FILE:{FILE}", "FILE", filePath);
             elog<InvalidCertificateError>(
                 InvalidCertificate::REASON("File is empty"));
         }
@@ -360,75 +385,83 @@ void Certificate::install(const std::string& certSrcFilePath, bool restore)
     catch (const fs::filesystem_error& e)
     {
         // Log Error message
-        lg2::error("File is empty, FILE:{FILE}, ERR:{ERR}", "FILE",
-                   certSrcFilePath, "ERR", e);
+        lg2::error("File is empty, FILE:{FILE}, ERR:{ERR}", "FILE", filePath,
+                   "ERR", e);
         elog<InternalFailure>();
     }
 
-    X509StorePtr x509Store = getX509Store(certSrcFilePath);
+    trace::Span parseSpan("parse");
+    parseSpan.arg("file", filePath);
+    parseSpan.arg("bytes", size);
+    X509StorePtr x509Store = getX509Store(filePath);
 
     // Load Certificate file into the X509 structure.
-    internal::X509Ptr cert = loadCert(certSrcFilePath);
+    internal::X509Ptr cert = loadCert(filePath);
+    parseSpan.end();
 
     // Perform validation
+    trace::Span validateSpan("validate");
+    validateSpan.arg("file", filePath);
     validateCertificateAgainstStore(*x509Store, *cert);
     validateCertificateStartDate(*cert);
     validateCertificateInSSLContext(*cert);
+    return cert;
+}
 
-    // Invoke type specific append private key function.
-    if (auto it = appendKeyMap.find(certType); it == appendKeyMap.end())
-    {
-        lg2::error("Unsupported Type, TYPE:{TYPE}", "TYPE",
-                   certificateTypeToString(certType));
-        elog<InternalFailure>();
-    }
-    else
-    {
-        it->second(certSrcFilePath);
-    }
-
-    // Invoke type specific compare keys function.
-    if (auto it = typeFuncMap.find(certType); it == typeFuncMap.end())
-    {
-        lg2::error("Unsupported Type, TYPE:{TYPE}", "TYPE",
-                   certificateTypeToString(certType));
-        elog<InternalFailure>();
-    }
-    else
-    {
-        it->second(certSrcFilePath);
+void Certificate::installValidated(X509& cert,
+                                   const std::string& certSrcFilePath)
+{
+    // Shared files are stored as a link to the shared copy. Files already
+    // in the storage format are copied as they are; this keeps the private
+    // key appended to server and client certificates. Others are converted,
+    // in place for a stored file.
+    StorageFormat format = manager.getStorageFormat();
+    if (!linkToBlob(cert))
+    {
+        if (getFileStorageFormat(certSrcFilePath) == format)
+        {
+            copyCertificate(certSrcFilePath, getCertFilePath());
+        }
+        else
+        {
+            if (certSrcFilePath == getCertFilePath())
+            {
+                lg2::info("Converting stored certificate, FILE:{FILE}, "
+                          "FORMAT:{FORMAT}",
+                          "FILE", certSrcFilePath, "FORMAT",
+                          storageFormatToString(format));
+            }
+            dumpCertificate(encodeCertificate(cert, format),
+                            getCertFilePath());
+        }
     }
-
-    copyCertificate(certSrcFilePath, certFilePath);
     storageUpdate();
 
     // Keep certificate ID
-    certId = generateCertId(*cert);
+    certId = std::stoull(generateCertId(cert), nullptr, 16);
 
     // Parse the certificate file and populate properties
-    populateProperties(*cert);
-
-    // restart watch
-    if (certWatch != nullptr)
-    {
-        certWatch->startWatch();
-    }
+    populateProperties(cert);
 }
 
-void Certificate::install(X509_STORE& x509Store, const std::string& pem,
-                          bool restore)
+void Certificate::install(X509_STORE& x509Store, X509& cert, bool restore)
 {
+    CERTS_PROBE(certificate_install_entry, manager.getObjectPath().c_str(),
+                objectId, "");
+    CERTS_PROBE_RETURN(certificate_install_return,
+                       manager.getObjectPath().c_str(), objectId);
     if (restore)
     {
-        lg2::debug("Certificate install, PEM_STR:{PEM_STR}", "PEM_STR", pem);
+        lg2::debug("Certificate install, SUBJECT:{SUBJECT}", "SUBJECT",
+                   formatName(*X509_get_subject_name(&cert)));
     }
     else
     {
-        lg2::info("Certificate install, PEM_STR:{PEM_STR} ", "PEM_STR", pem);
+        lg2::info("Certificate install, SUBJECT:{SUBJECT}", "SUBJECT",
+                  formatName(*X509_get_subject_name(&cert)));
     }
 
-    if ((certType != CertificateType::authority) &&
-        (certType != CertificateType::authorityBios))
+    if (!policy().hashLinked)
     {
         lg2::error("Bulk install error: Unsupported Type; only authority "
                    "supports bulk install, TYPE:{TYPE}",
@@ -442,20 +475,23 @@ void Certificate::install(X509_STORE& x509Store, const std::string& pem,
         certWatch->stopWatch();
     }
 
-    // Load Certificate file into the X509 structure.
-    internal::X509Ptr cert = parseCert(pem);
     // Perform validation; no type specific compare keys function
-    validateCertificateAgainstStore(x509Store, *cert);
-    validateCertificateStartDate(*cert);
-    validateCertificateInSSLContext(*cert);
+    validateCertificateAgainstStore(x509Store, cert);
+    validateCertificateStartDate(cert);
+    validateCertificateInSSLContext(cert);
+    manager.validateRevocation(cert);
 
-    // Copy the PEM to the installation path
-    dumpCertificate(pem, certFilePath);
+    // Store the certificate in the installation path
+    if (!linkToBlob(cert))
+    {
+        dumpCertificate(encodeCertificate(cert, manager.getStorageFormat()),
+                        getCertFilePath());
+    }
     storageUpdate();
     // Keep certificate ID
-    certId = generateCertId(*cert);
+    certId = std::stoull(generateCertId(cert), nullptr, 16);
     // Parse the certificate file and populate properties
-    populateProperties(*cert);
+    populateProperties(cert);
     // restart watch
     if (certWatch)
     {
@@ -463,15 +499,41 @@ void Certificate::install(X509_STORE& x509Store, const std::string& pem,
     }
 }
 
+bool Certificate::linkToBlob(X509& cert)
+{
+    const BlobStore* blobStore = manager.getBlobStore();
+    if (blobStore == nullptr)
+    {
+        return false;
+    }
+    StorageFormat format = manager.getStorageFormat();
+    try
+    {
+        return blobStore->link(generateFingerprint(cert) + '.' +
+                                   storageFormatToString(format),
+                               encodeCertificate(cert, format),
+                               getCertFilePath());
+    }
+    catch (const std::exception& e)
+    {
+        lg2::error("Failed to link certificate to the blob store, "
+                   "FILE:{FILE}, ERR:{ERR}",
+                   "FILE", getCertFilePath(), "ERR", e);
+        return false;
+    }
+}
+
 void Certificate::populateProperties()
 {
-    internal::X509Ptr cert = loadCert(certInstallPath);
+    internal::X509Ptr cert = loadCert(*certInstallPath);
     populateProperties(*cert);
 }
 
 std::string Certificate::getCertId() const
 {
-    return certId;
+    char idBuff[17];
+    snprintf(idBuff, sizeof(idBuff), "%016" PRIx64, certId);
+    return idBuff;
 }
 
 bool Certificate::isSame(const std::string& certPath)
@@ -482,131 +544,110 @@ bool Certificate::isSame(const std::string& certPath)
 
 void Certificate::storageUpdate(std::optional<std::string> certSrcFilePath)
 {
-    if ((certType == CertificateType::authority) ||
-        (certType == CertificateType::authorityBios))
+    if (policy().hashLinked)
     {
         // Create symbolic link in the certificate directory
-        std::string certFileX509Path;
-        try
-        {
-            if (!certFilePath.empty() &&
-                fs::is_regular_file(fs::path(certFilePath)))
-            {
-                certFileX509Path = generateAuthCertFileX509Path(
-                    certSrcFilePath ? *certSrcFilePath : certFilePath,
-                    certInstallPath);
-                fs::create_symlink(fs::path(certFilePath),
-                                   fs::path(certFileX509Path));
-            }
-        }
-        catch (const std::exception& e)
+        std::string certFilePath = getCertFilePath();
+        if (!certFilePath.empty() &&
+            fs::is_regular_file(fs::path(certFilePath)))
         {
-            lg2::error("Failed to create symlink for certificate, ERR:{ERR},"
-                       "FILE:{FILE}, SYMLINK:{SYMLINK}",
-                       "ERR", e, "FILE", certFilePath, "SYMLINK",
-                       certFileX509Path);
-            elog<InternalFailure>();
+            linkByHash(*certInstallPath,
+                       certSrcFilePath ? *certSrcFilePath : certFilePath);
         }
     }
 }
 
-void Certificate::populateProperties(X509& cert)
+void Certificate::stage(const std::string& stagingPath)
 {
-    // Update properties if no error thrown
-    BIOMemPtr certBio(BIO_new(BIO_s_mem()), BIO_free);
-    PEM_write_bio_X509(certBio.get(), &cert);
-    BufMemPtr certBuf(BUF_MEM_new(), BUF_MEM_free);
-    BUF_MEM* buf = certBuf.get();
-    BIO_get_mem_ptr(certBio.get(), &buf);
-    std::string certStr(buf->data, buf->length);
-    certificateString(certStr);
-
-    static const int maxKeySize = 4096;
-    char subBuffer[maxKeySize] = {0};
-    BIOMemPtr subBio(BIO_new(BIO_s_mem()), BIO_free);
-    // This pointer cannot be freed independantly.
-    X509_NAME* sub = X509_get_subject_name(&cert);
-    X509_NAME_print_ex(subBio.get(), sub, 0, XN_FLAG_SEP_COMMA_PLUS);
-    BIO_read(subBio.get(), subBuffer, maxKeySize);
-    subject(subBuffer);
-
-    char issuerBuffer[maxKeySize] = {0};
-    BIOMemPtr issuerBio(BIO_new(BIO_s_mem()), BIO_free);
-    // This pointer cannot be freed independantly.
-    X509_NAME* issuerName = X509_get_issuer_name(&cert);
-    X509_NAME_print_ex(issuerBio.get(), issuerName, 0, XN_FLAG_SEP_COMMA_PLUS);
-    BIO_read(issuerBio.get(), issuerBuffer, maxKeySize);
-    issuer(issuerBuffer);
-
-    std::vector<std::string> keyUsageList;
-    ASN1_BIT_STRING* usage;
-
-    // Go through each usage in the bit string and convert to
-    // corresponding string value
-    if ((usage = static_cast<ASN1_BIT_STRING*>(
-             X509_get_ext_d2i(&cert, NID_key_usage, nullptr, nullptr))))
-    {
-        for (auto i = 0; i < usage->length; ++i)
-        {
-            for (auto& x : keyUsageToRfStr)
-            {
-                if (x.first & usage->data[i])
-                {
-                    keyUsageList.push_back(x.second);
-                    break;
-                }
-            }
-        }
+    std::string stagedFilePath = stagingPath + '/' + certFileName;
+    std::error_code ec;
+    fs::create_hard_link(getCertFilePath(), stagedFilePath, ec);
+    if (ec)
+    {
+        // Hard links are not supported by every file system
+        copyCertificate(getCertFilePath(), stagedFilePath);
     }
+    linkByHash(stagingPath, stagedFilePath);
+}
 
-    EXTENDED_KEY_USAGE* extUsage;
-    if ((extUsage = static_cast<EXTENDED_KEY_USAGE*>(
-             X509_get_ext_d2i(&cert, NID_ext_key_usage, nullptr, nullptr))))
+void Certificate::linkByHash(const std::string& directory,
+                             const std::string& hashSrcFilePath)
+{
+    std::string certFileX509Path;
+    try
     {
-        for (int i = 0; i < sk_ASN1_OBJECT_num(extUsage); i++)
+        certFileX509Path = generateAuthCertFileX509Path(hashSrcFilePath,
+                                                        directory);
+        fs::path linkTarget(certFileName);
+        if (manager.getStorageFormat() == StorageFormat::der)
         {
-            keyUsageList.push_back(extendedKeyUsageToRfStr[OBJ_obj2nid(
-                sk_ASN1_OBJECT_value(extUsage, i))]);
+            // OpenSSL reads CApath entries as PEM; link to a PEM rendering
+            // outside of the store
+            linkTarget = manager.getPemViewPath() / certFileName;
+            dumpCertificate(encodeCertificate(*loadCert(getCertFilePath()),
+                                              StorageFormat::pem),
+                            linkTarget);
         }
+        fs::create_symlink(linkTarget, fs::path(certFileX509Path));
     }
-    keyUsage(keyUsageList);
-
-    int days = 0;
-    int secs = 0;
-
-    ASN1TimePtr epoch(ASN1_TIME_new(), ASN1_STRING_free);
-    // Set time to 00:00am GMT, Jan 1 1970; format: YYYYMMDDHHMMSSZ
-    ASN1_TIME_set_string(epoch.get(), "19700101000000Z");
-
-    static const uint64_t dayToSeconds = 24 * 60 * 60;
-    ASN1_TIME* notAfter = X509_get_notAfter(&cert);
-    ASN1_TIME_diff(&days, &secs, epoch.get(), notAfter);
-    validNotAfter((days * dayToSeconds) + secs);
+    catch (const std::exception& e)
+    {
+        lg2::error("Failed to create symlink for certificate, ERR:{ERR},"
+                   "FILE:{FILE}, SYMLINK:{SYMLINK}",
+                   "ERR", e, "FILE", certFileName, "SYMLINK",
+                   certFileX509Path);
+        elog<InternalFailure>();
+    }
+}
 
-    ASN1_TIME* notBefore = X509_get_notBefore(&cert);
-    ASN1_TIME_diff(&days, &secs, epoch.get(), notBefore);
-    validNotBefore((days * dayToSeconds) + secs);
+void Certificate::populateProperties(X509& cert)
+{
+    CERTS_PROBE(populate_properties_entry, manager.getObjectPath().c_str(),
+                objectId);
+    CERTS_PROBE_RETURN(populate_properties_return,
+                       manager.getObjectPath().c_str(), objectId);
+    // Update properties if no error thrown
+    auto properties = extractProperties(cert);
+    manager.indexCertificate(objectId, cert, properties);
+    subject(std::move(properties.subject));
+    issuer(std::move(properties.issuer));
+    keyUsage(std::move(properties.keyUsage));
+    validNotAfter(properties.validNotAfter);
+    validNotBefore(properties.validNotBefore);
 }
 
 void Certificate::checkAndAppendPrivateKey(const std::string& filePath)
 {
-    BIOMemPtr keyBio(BIO_new(BIO_s_file()), ::BIO_free);
-    if (!keyBio)
+    EVPPkeyPtr priKey(nullptr, ::EVP_PKEY_free);
     {
-        lg2::error("Error occurred during BIO_s_file call, FILE:{FILE}", "FILE",
-                   filePath);
-        elog<InternalFailure>();
+        // Close the file before appending to it
+        std::optional<FileContent> file;
+        try
+        {
+            file.emplace(filePath);
+        }
+        catch (const std::system_error& e)
+        {
+            lg2::error("Failed to read file, FILE:{FILE}, ERR:{ERR}", "FILE",
+                       filePath, "ERR", e);
+            elog<InternalFailure>();
+        }
+        BIOMemPtr keyBio = file->bio();
+        if (!keyBio)
+        {
+            lg2::error(
+                "Error occurred during BIO_new_mem_buf call, FILE:{FILE}",
+                "FILE", filePath);
+            elog<InternalFailure>();
+        }
+        priKey.reset(PEM_read_bio_PrivateKey(keyBio.get(), nullptr,
+                                             lsp::passwordCallback, nullptr));
     }
-    BIO_read_filename(keyBio.get(), filePath.c_str());
-
-    EVPPkeyPtr priKey(PEM_read_bio_PrivateKey(keyBio.get(), nullptr,
-                                              lsp::passwordCallback, nullptr),
-                      ::EVP_PKEY_free);
     if (!priKey)
     {
         lg2::info("Private key not present in file, FILE:{FILE}", "FILE",
                   filePath);
-        fs::path privateKeyFile = fs::path(certInstallPath).parent_path();
+        fs::path privateKeyFile = fs::path(*certInstallPath).parent_path();
         privateKeyFile = privateKeyFile / defaultPrivateKeyFileName;
         if (!fs::exists(privateKeyFile))
         {
@@ -655,10 +696,23 @@ bool Certificate::compareKeys(const std::string& filePath)
         elog<InternalFailure>();
     }
 
-    BIOMemPtr bioCert(BIO_new_file(filePath.c_str(), "rb"), ::BIO_free);
+    // The certificate and the key are parsed from the same FileContent
+    // buffer, read once
+    std::optional<FileContent> file;
+    try
+    {
+        file.emplace(filePath);
+    }
+    catch (const std::system_error& e)
+    {
+        lg2::error("Failed to read file, FILE:{FILE}, ERR:{ERR}", "FILE",
+                   filePath, "ERR", e);
+        elog<InternalFailure>();
+    }
+    BIOMemPtr bioCert = file->bio();
     if (!bioCert)
     {
-        lg2::error("Error occurred during BIO_new_file call, FILE:{FILE}",
+        lg2::error("Error occurred during BIO_new_mem_buf call, FILE:{FILE}",
                    "FILE", filePath);
         elog<InternalFailure>();
     }
@@ -676,14 +730,13 @@ bool Certificate::compareKeys(const std::string& filePath)
             InvalidCertificate::REASON("Failed to get public key info"));
     }
 
-    BIOMemPtr keyBio(BIO_new(BIO_s_file()), ::BIO_free);
+    BIOMemPtr keyBio = file->bio();
     if (!keyBio)
     {
-        lg2::error("Error occurred during BIO_s_file call, FILE:{FILE}", "FILE",
-                   filePath);
+        lg2::error("Error occurred during BIO_new_mem_buf call, FILE:{FILE}",
+                   "FILE", filePath);
         elog<InternalFailure>();
     }
-    BIO_read_filename(keyBio.get(), filePath.c_str());
 
     EVPPkeyPtr priKey(PEM_read_bio_PrivateKey(keyBio.get(), nullptr,
                                               lsp::passwordCallback, nullptr),
@@ -719,22 +772,98 @@ void Certificate::delete_()
 
 std::string Certificate::getObjectPath() const
 {
-    return objectPath;
+    return manager.getCertificateObjectPath(objectId);
+}
+
+uint64_t Certificate::getObjectId() const
+{
+    return objectId;
+}
+
+void Certificate::setAssociations(const std::optional<std::string>& issuerPath,
+                                  const std::optional<std::string>& revokerPath)
+{
+    if (!associationsIntf)
+    {
+        return;
+    }
+    AssociationList associations;
+    if (issuerPath)
+    {
+        associations.emplace_back("issued_by", "issued", *issuerPath);
+    }
+    if (revokerPath)
+    {
+        associations.emplace_back("revoked_by", "revoked", *revokerPath);
+    }
+    // Unchanged associations emit no signal
+    associationsIntf->associations(std::move(associations));
+}
+
+AssociationList Certificate::getAssociations() const
+{
+    return associationsIntf ? associationsIntf->associations()
+                            : AssociationList{};
 }
 
-std::string Certificate::getCertFilePath()
+std::string Certificate::getCertFilePath() const
 {
-    return certFilePath;
+    if (policy().hashLinked)
+    {
+        return certFileName.empty() ? std::string()
+                                    : *certInstallPath + '/' + certFileName;
+    }
+    if (policy().storedById)
+    {
+        return *certInstallPath + '/' + std::to_string(objectId);
+    }
+    return *certInstallPath;
 }
 
 void Certificate::setCertFilePath(const std::string& path)
 {
-    certFilePath = path;
+    // Only hash linked certificates have a name of their own; it is always
+    // in the install directory
+    if (policy().hashLinked)
+    {
+        certFileName = fs::path(path).filename();
+    }
 }
 
 void Certificate::setCertInstallPath(const std::string& path)
 {
-    certInstallPath = path;
+    certInstallPath = intern(path);
+}
+
+std::string Certificate::certificateString() const
+{
+    return manager.renderPem(getCertFilePath());
+}
+
+size_t Certificate::memoryUsage() const
+{
+    size_t bytes = sizeof(*this) + heapSize(certFileName) +
+                   heapSize(subject()) + heapSize(issuer()) +
+                   heapSize(keyUsage());
+    if (ownerIntf)
+    {
+        bytes += sizeof(*ownerIntf) + heapSize(ownerIntf->uuid());
+    }
+    if (uuidIntf)
+    {
+        bytes += sizeof(*uuidIntf) + heapSize(uuidIntf->uuid());
+    }
+    if (associationsIntf)
+    {
+        bytes += sizeof(*associationsIntf);
+        for (const auto& [forward, reverse, endpoint] :
+             associationsIntf->associations())
+        {
+            bytes += sizeof(AssociationList::value_type) + heapSize(forward) +
+                     heapSize(reverse) + heapSize(endpoint);
+        }
+    }
+    return bytes;
 }
 
 } // namespace phosphor::certs
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "interned_string.hpp"
 #include "uefiSignatureOwnerIntf.hpp"
 #include "watch.hpp"
 
@@ -8,17 +9,20 @@
 
 #include <phosphor-logging/elog.hpp>
 #include <sdbusplus/server/object.hpp>
+#include <xyz/openbmc_project/Association/Definitions/server.hpp>
 #include <xyz/openbmc_project/Certs/Certificate/server.hpp>
 #include <xyz/openbmc_project/Certs/Replace/server.hpp>
 #include <xyz/openbmc_project/Object/Delete/server.hpp>
 
+#include <cstddef>
+#include <cstdint>
 #include <filesystem>
-#include <functional>
 #include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
-#include <unordered_map>
+#include <tuple>
+#include <vector>
 
 namespace phosphor::certs
 {
@@ -78,19 +82,103 @@ inline constexpr CertificateType stringToCertificateType(std::string_view type)
     return CertificateType::unsupported;
 }
 
+/** @brief Type specific behaviour of a certificate
+ */
+struct CertificateTypePolicy
+{
+    /** @brief The type can be installed at all */
+    bool supported;
+
+    /** @brief The certificate is installed together with the endpoint's
+     * private key, which must match its public key
+     */
+    bool pairedWithPrivateKey;
+
+    /** @brief Certificates are stored under unique file names and found by
+     * OpenSSL through subject name hash links
+     */
+    bool hashLinked;
+
+    /** @brief Each certificate is stored in a file named after its object ID
+     */
+    bool storedById;
+
+    /** @brief The object implements UefiSignatureOwner */
+    bool hasOwner;
+
+    /** @brief The object implements Common.UUID */
+    bool hasUUID;
+
+    /** @brief The object implements Association.Definitions, linking it to
+     * the object of its issuer
+     */
+    bool hasAssociations;
+};
+
+inline constexpr CertificateTypePolicy
+    certificateTypePolicy(CertificateType type)
+{
+    switch (type)
+    {
+        case CertificateType::server:
+        case CertificateType::client:
+            return {.supported = true,
+                    .pairedWithPrivateKey = true,
+                    .hashLinked = false,
+                    .storedById = false,
+                    .hasOwner = false,
+                    .hasUUID = false,
+                    .hasAssociations = false};
+        case CertificateType::authority:
+            return {.supported = true,
+                    .pairedWithPrivateKey = false,
+                    .hashLinked = true,
+                    .storedById = false,
+                    .hasOwner = false,
+                    .hasUUID = false,
+                    .hasAssociations = true};
+        case CertificateType::authorityBios:
+            return {.supported = true,
+                    .pairedWithPrivateKey = false,
+                    .hashLinked = true,
+                    .storedById = false,
+                    .hasOwner = false,
+                    .hasUUID = true,
+                    .hasAssociations = true};
+        case CertificateType::securebootDatabase:
+            return {.supported = true,
+                    .pairedWithPrivateKey = false,
+                    .hashLinked = false,
+                    .storedById = true,
+                    .hasOwner = true,
+                    .hasUUID = false,
+                    .hasAssociations = false};
+        default:
+            return {.supported = false,
+                    .pairedWithPrivateKey = false,
+                    .hashLinked = false,
+                    .storedById = false,
+                    .hasOwner = false,
+                    .hasUUID = false,
+                    .hasAssociations = false};
+    }
+}
+
 namespace internal
 {
 using CertificateInterface = sdbusplus::server::object_t<
     sdbusplus::xyz::openbmc_project::Certs::server::Certificate,
     sdbusplus::xyz::openbmc_project::Certs::server::Replace,
     sdbusplus::xyz::openbmc_project::Object::server::Delete>;
-using InstallFunc = std::function<void(const std::string&)>;
-using AppendPrivKeyFunc = std::function<void(const std::string&)>;
 using X509Ptr = std::unique_ptr<X509, decltype(&::X509_free)>;
 } // namespace internal
 
 class Manager; // Forward declaration for Certificate Manager.
 
+/** @brief Associations, as (forward, reverse, endpoint) tuples */
+using AssociationList =
+    std::vector<std::tuple<std::string, std::string, std::string>>;
+
 /** @class Certificate
  *  @brief OpenBMC Certificate entry implementation.
  *  @details A concrete implementation for the
@@ -100,6 +188,8 @@ class Manager; // Forward declaration for Certificate Manager.
 class Certificate : public internal::CertificateInterface
 {
   public:
+    using internal::CertificateInterface::certificateString;
+
     Certificate() = delete;
     Certificate(const Certificate&) = delete;
     Certificate& operator=(const Certificate&) = delete;
@@ -110,6 +200,7 @@ class Certificate : public internal::CertificateInterface
     /** @brief Constructor for the Certificate Object
      *  @param[in] bus - Bus to attach to.
      *  @param[in] objPath - Object path to attach to
+     *  @param[in] id - ID of the certificate, the last element of |objPath|
      *  @param[in] type - Type of the certificate
      *  @param[in] installPath - Path of the certificate to install
      *  @param[in] uploadPath - Path of the certificate file to upload
@@ -117,7 +208,7 @@ class Certificate : public internal::CertificateInterface
      *  @param[in] parent - the manager that owns the certificate
      *  @param[in] restore - the certificate is created in the restore path
      */
-    Certificate(sdbusplus::bus_t& bus, const std::string& objPath,
+    Certificate(sdbusplus::bus_t& bus, const std::string& objPath, uint64_t id,
                 CertificateType type, const std::string& installPath,
                 const std::string& uploadPath, Watch* watch, Manager& parent,
                 bool restore);
@@ -126,22 +217,45 @@ class Certificate : public internal::CertificateInterface
      * list install
      *  @param[in] bus - Bus to attach to.
      *  @param[in] objPath - Object path to attach to
+     *  @param[in] id - ID of the certificate, the last element of |objPath|
      *  @param[in] type - Type of the certificate
      *  @param[in] installPath - Path of the certificate to install
      *  @param[in] x509Store - an initialized X509 store used for certificate
      * validation; Certificate object doesn't own it
-     *  @param[in] pem - Content of the certificate file to upload; it shall be
-     * a single PEM encoded x509 certificate
+     *  @param[in] cert - The certificate to install, one of the list
      *  @param[in] watchPtr - watch on self signed certificate
      *  @param[in] parent - Pointer to the manager which owns the constructed
      * Certificate object
      *  @param[in] restore - the certificate is created in the restore path
+     *
+     *  InterfacesAdded is not emitted; the caller announces the whole list
+     *  once it is committed.
      */
-    Certificate(sdbusplus::bus_t& bus, const std::string& objPath,
+    Certificate(sdbusplus::bus_t& bus, const std::string& objPath, uint64_t id,
                 const CertificateType& type, const std::string& installPath,
-                X509_STORE& x509Store, const std::string& pem, Watch* watchPtr,
+                X509_STORE& x509Store, X509& cert, Watch* watchPtr,
                 Manager& parent, bool restore);
 
+    /** @brief Constructor for the Certificate Object; a variant for the
+     * restore path where the stored file was already loaded and validated by
+     * validateFile()
+     *  @param[in] bus - Bus to attach to.
+     *  @param[in] objPath - Object path to attach to
+     *  @param[in] id - ID of the certificate, the last element of |objPath|
+     *  @param[in] type - Type of the certificate
+     *  @param[in] installPath - Path of the certificate to install
+     *  @param[in] filePath - Path of the stored certificate file
+     *  @param[in] cert - The certificate parsed from |filePath|
+     *  @param[in] watchPtr - watch on self signed certificate
+     *  @param[in] parent - the manager that owns the certificate
+     *
+     *  InterfacesAdded is not emitted; see Manager::createCertificates().
+     */
+    Certificate(sdbusplus::bus_t& bus, const std::string& objPath, uint64_t id,
+                CertificateType type, const std::string& installPath,
+                const std::string& filePath, X509& cert, Watch* watchPtr,
+                Manager& parent);
+
     /** @brief Validate and Replace/Install the certificate file
      *  Install/Replace the existing certificate file with another
      *  (possibly CA signed) Certificate file.
@@ -155,10 +269,10 @@ class Certificate : public internal::CertificateInterface
      *  (possibly CA signed) Certificate file.
      *  @param[in] x509Store - an initialized X509 store used for certificate
      * validation; Certificate object doesn't own it
-     *  @param[in] pem - a string buffer which stores a PEM encoded certificate.
+     *  @param[in] cert - The certificate to install.
      *  @param[in] restore - the certificate is created in the restore path
      */
-    void install(X509_STORE& x509Store, const std::string& pem, bool restore);
+    void install(X509_STORE& x509Store, X509& cert, bool restore);
 
     /** @brief Validate certificate and replace the existing certificate
      *  @param[in] filePath - Certificate file path.
@@ -195,6 +309,14 @@ class Certificate : public internal::CertificateInterface
     void storageUpdate(
         std::optional<std::string> certSrcFilePath = std::nullopt);
 
+    /**
+     * @brief Add the certificate, under its current name, to an authority
+     * store being built; see Manager::publishAuthorities().
+     *
+     * @param[in] stagingPath - Directory of the store being built.
+     */
+    void stage(const std::string& stagingPath);
+
     /**
      * @brief Delete the certificate
      */
@@ -220,15 +342,79 @@ class Certificate : public internal::CertificateInterface
     static void copyCertificate(const std::string& certSrcFilePath,
                                 const std::string& certFilePath);
 
+    /**
+     * @brief Writes encoded certificate data to certFilePath; the file is
+     * replaced atomically
+     *
+     * @param[in] data - Encoded certificate, see encodeCertificate().
+     * @param[in] certFilePath - Path to the destination file.
+     *
+     * @return void
+     */
+    static void dumpCertificate(const std::string& data,
+                                const std::string& certFilePath);
+
+    /**
+     * @brief Load a certificate file and run the type independent checks of
+     * install() on it. No D-Bus state is touched, so it is safe to call from
+     * worker threads.
+     *
+     * @param[in] filePath - Certificate file path.
+     *
+     * @return The parsed certificate.
+     */
+    static internal::X509Ptr validateFile(const std::string& filePath);
+
     /**
      * @brief Returns the associated dbus object path.
      */
     std::string getObjectPath() const;
 
+    /**
+     * @brief Returns the ID the object path was built from.
+     */
+    uint64_t getObjectId() const;
+
+    /**
+     * @brief Link the object to the object of the issuer of the certificate
+     * with an issued_by association, whose reverse is issued, or unlink it;
+     * and to the object revoking it with a revoked_by association, whose
+     * reverse is revoked. See Manager::updateAssociations().
+     *
+     * @param[in] issuerPath - Object path of the issuer, std::nullopt for a
+     * root or an issuer the endpoint doesn't hold.
+     * @param[in] revokerPath - Object path of the issuer of the CRL revoking
+     * the certificate, std::nullopt if it is not revoked.
+     */
+    void setAssociations(const std::optional<std::string>& issuerPath,
+                         const std::optional<std::string>& revokerPath);
+
+    /**
+     * @brief Returns the associations of the object, none if the type has
+     * no Association.Definitions interface.
+     */
+    AssociationList getAssociations() const;
+
     /**
      * @brief Returns the associated cert file path.
      */
-    std::string getCertFilePath();
+    std::string getCertFilePath() const;
+
+    /**
+     * @brief Get the PEM text of the certificate.
+     * @details It is rendered from the certificate file rather than kept in
+     * the property storage, see Manager::renderPem(); empty if the file is
+     * missing.
+     */
+    std::string certificateString() const override;
+
+    /**
+     * @brief Estimate the memory used by the object, the heap memory it owns
+     * included.
+     *
+     * @return Size in bytes.
+     */
+    size_t memoryUsage() const;
 
     /** @brief: Set the data member |certFilePath| to |path|
      */
@@ -239,6 +425,12 @@ class Certificate : public internal::CertificateInterface
     void setCertInstallPath(const std::string& path);
 
   private:
+    /** @brief Type specific behaviour of this certificate */
+    constexpr CertificateTypePolicy policy() const
+    {
+        return certificateTypePolicy(certType);
+    }
+
     /**
      * @brief Populate certificate properties by parsing given certificate
      * object
@@ -249,6 +441,27 @@ class Certificate : public internal::CertificateInterface
      */
     void populateProperties(X509& cert);
 
+    /** @brief Store an already validated certificate and publish its
+     * properties
+     *  @param[in] cert - The validated certificate.
+     *  @param[in] certSrcFilePath - Path of the file |cert| was loaded from.
+     */
+    void installValidated(X509& cert, const std::string& certSrcFilePath);
+
+    /** @brief Store the certificate as a link to the manager's blob store
+     *  @param[in] cert - The validated certificate.
+     *  @return false if the manager has no blob store or linking failed.
+     */
+    bool linkToBlob(X509& cert);
+
+    /** @brief Create the subject hash link OpenSSL looks the certificate up
+     *  by; the link is relative, so that the directory can be renamed
+     *  @param[in] directory - Directory of the certificate file and link.
+     *  @param[in] hashSrcFilePath - File to take the subject hash from.
+     */
+    void linkByHash(const std::string& directory,
+                    const std::string& hashSrcFilePath);
+
     /** @brief Check and append private key to the certificate file
      *         If private key is not present in the certificate file append the
      *         certificate file with private key existing in the system.
@@ -308,27 +521,27 @@ class Certificate : public internal::CertificateInterface
      */
     std::string generateCertFilePath(const std::string& certSrcFilePath);
 
-    /** @brief Type specific function pointer map */
-    std::unordered_map<CertificateType, internal::InstallFunc> typeFuncMap;
-
-    /** @brief object path */
-    std::string objectPath;
+    /** @brief ID of the object, the last element of its object path */
+    uint64_t objectId;
 
     /** @brief Type of the certificate */
     CertificateType certType;
 
-    /** @brief Stores certificate ID */
-    std::string certId;
-
-    /** @brief Stores certificate file path */
-    std::string certFilePath;
+    /** @brief Certificate ID, see generateCertId(); kept as a number as the
+     * string form doesn't fit the inline string buffer
+     */
+    uint64_t certId = 0;
 
-    /** @brief Certificate file installation path */
-    std::string certInstallPath;
+    /** @brief File name of a hash linked certificate, empty until
+     * generated. The file of the other types is found from the install path
+     * and the object ID; see getCertFilePath().
+     */
+    std::string certFileName;
 
-    /** @brief Type specific function pointer map for appending private key */
-    std::unordered_map<CertificateType, internal::AppendPrivKeyFunc>
-        appendKeyMap;
+    /** @brief Certificate file installation path, shared by the whole
+     * endpoint
+     */
+    InternedString certInstallPath;
 
     /** @brief Certificate file create/update watch
      * Note that Certificate object doesn't own the pointer
@@ -344,6 +557,11 @@ class Certificate : public internal::CertificateInterface
     /** @brief Interface of UUID */
     std::unique_ptr<sdbusplus::xyz::openbmc_project::Common::server::UUID>
         uuidIntf;
+
+    /** @brief Interface of the associations */
+    std::unique_ptr<
+        sdbusplus::xyz::openbmc_project::Association::server::Definitions>
+        associationsIntf;
 };
 
 } // namespace phosphor::certs
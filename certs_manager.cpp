@@ -2,19 +2,24 @@
 
 #include "certs_manager.hpp"
 
+#include "dbus_query.hpp"
+#include "file_content.hpp"
+#include "keygen.hpp"
 #include "lsp.hpp"
+#include "memory_usage.hpp"
+#include "metrics.hpp"
+#include "startup_trace.hpp"
+#include "tracepoints.hpp"
+#include "worker_pool.hpp"
 #include "x509_utils.hpp"
 
+#include <fcntl.h>
 #include <openssl/asn1.h>
-#include <openssl/bn.h>
-#include <openssl/ec.h>
 #include <openssl/err.h>
 #include <openssl/evp.h>
-#include <openssl/obj_mac.h>
-#include <openssl/objects.h>
-#include <openssl/opensslv.h>
 #include <openssl/pem.h>
-#include <openssl/rsa.h>
+#include <poll.h>
+#include <sys/resource.h>
 #include <unistd.h>
 
 #include <phosphor-logging/elog-errors.hpp>
@@ -24,6 +29,7 @@
 #include <sdbusplus/bus.hpp>
 #include <sdbusplus/exception.hpp>
 #include <sdbusplus/message.hpp>
+#include <sdbusplus/vtable.hpp>
 #include <sdeventplus/source/base.hpp>
 #include <sdeventplus/source/child.hpp>
 #include <xyz/openbmc_project/Certs/error.hpp>
@@ -39,6 +45,11 @@
 #include <cstring>
 #include <exception>
 #include <fstream>
+#include <map>
+#include <optional>
+#include <set>
+#include <string_view>
+#include <system_error>
 #include <utility>
 namespace phosphor::certs
 {
@@ -63,80 +74,406 @@ using Argument =
 // RAII support for openSSL functions.
 using X509ReqPtr = std::unique_ptr<X509_REQ, decltype(&::X509_REQ_free)>;
 using EVPPkeyPtr = std::unique_ptr<EVP_PKEY, decltype(&::EVP_PKEY_free)>;
-using BignumPtr = std::unique_ptr<BIGNUM, decltype(&::BN_free)>;
 using X509StorePtr = std::unique_ptr<X509_STORE, decltype(&::X509_STORE_free)>;
 
 constexpr int supportedKeyBitLength = 3072;
-constexpr int defaultKeyBitLength = 3072;
-// secp224r1 is equal to RSA 2048 KeyBitLength. Refer RFC 5349
-constexpr auto defaultKeyCurveID = "secp224r1";
-// PEM certificate block markers, defined in go/rfc/7468.
-constexpr std::string_view beginCertificate = "-----BEGIN CERTIFICATE-----";
-constexpr std::string_view endCertificate = "-----END CERTIFICATE-----";
-
-/**
- * @brief Splits the given authorities list file and returns an array of
- * individual PEM encoded x509 certificate.
- *
- * @param[in] sourceFilePath - Path to the authorities list file.
- *
- * @return An array of individual PEM encoded x509 certificate
+// Background RSA key generation runs at the lowest scheduling priority
+constexpr int keyGenNiceness = 19;
+// How long a CSR waits for the background RSA key generation
+constexpr auto keyGenTimeout = std::chrono::milliseconds(120000);
+// Expiry warnings are logged within a minute
+constexpr auto expiryTimerAccuracy =
+    std::chrono::duration_cast<sdeventplus::SdEventDuration>(
+        std::chrono::minutes(1));
+
+using ExpiryTimer = sdeventplus::source::Time<sdeventplus::ClockId::RealTime>;
+
+/** @brief Key of the serial number index; hex digits never contain the
+ * separator
  */
-std::vector<std::string> splitCertificates(const std::string& sourceFilePath)
+std::string serialNumberKey(const std::string& issuer,
+                            const std::string& serialNumber)
 {
-    std::ifstream inputCertFileStream;
-    inputCertFileStream.exceptions(
-        std::ifstream::failbit | std::ifstream::badbit | std::ifstream::eofbit);
+    return serialNumber + ':' + issuer;
+}
 
-    std::stringstream pemStream;
-    std::vector<std::string> certificatesList;
-    try
+/** @brief Warning windows of the expiry index, in seconds */
+std::vector<uint64_t> expiryWindows()
+{
+    std::vector<uint64_t> windows;
+    for (uint64_t days : expiryWarningDays)
     {
-        inputCertFileStream.open(sourceFilePath);
-        pemStream << inputCertFileStream.rdbuf();
-        inputCertFileStream.close();
+        windows.push_back(days * 24 * 60 * 60);
     }
-    catch (const std::exception& e)
+    return windows;
+}
+
+/** @brief Handler of the GetExpiringBefore method of queryInterface */
+int handleGetExpiringBefore(sd_bus_message* msg, void* context,
+                            sd_bus_error* error)
+{
+    const auto* manager = static_cast<const Manager*>(context);
+    return replyToQuery<uint64_t>(msg, error, [manager](uint64_t time) {
+        return manager->getExpiringBefore(time);
+    });
+}
+
+/** @brief Handler of the FindByFingerprint method of queryInterface */
+int handleFindByFingerprint(sd_bus_message* msg, void* context,
+                            sd_bus_error* error)
+{
+    const auto* manager = static_cast<const Manager*>(context);
+    return replyToQuery<std::string>(
+        msg, error, [manager](const std::string& fingerprint) {
+        return manager->findByFingerprint(fingerprint);
+    });
+}
+
+/** @brief Handler of the FindBySubject method of queryInterface */
+int handleFindBySubject(sd_bus_message* msg, void* context,
+                        sd_bus_error* error)
+{
+    const auto* manager = static_cast<const Manager*>(context);
+    return replyToQuery<std::string>(
+        msg, error, [manager](const std::string& subject) {
+        return manager->findBySubject(subject);
+    });
+}
+
+/** @brief Handler of the FindByIssuer method of queryInterface */
+int handleFindByIssuer(sd_bus_message* msg, void* context,
+                       sd_bus_error* error)
+{
+    const auto* manager = static_cast<const Manager*>(context);
+    return replyToQuery<std::string>(
+        msg, error, [manager](const std::string& issuer) {
+        return manager->findByIssuer(issuer);
+    });
+}
+
+/** @brief Handler of the FindBySerialNumber method of queryInterface */
+int handleFindBySerialNumber(sd_bus_message* msg, void* context,
+                             sd_bus_error* error)
+{
+    const auto* manager = static_cast<const Manager*>(context);
+    return replyToQuery<std::string, std::string>(
+        msg, error,
+        [manager](const std::string& issuer, const std::string& serialNumber) {
+        return manager->findBySerialNumber(issuer, serialNumber);
+    });
+}
+
+const sdbusplus::vtable_t queryVtable[] = {
+    sdbusplus::vtable::start(),
+    sdbusplus::vtable::method("GetExpiringBefore", "t", "ao",
+                              handleGetExpiringBefore),
+    sdbusplus::vtable::method("FindByFingerprint", "s", "ao",
+                              handleFindByFingerprint),
+    sdbusplus::vtable::method("FindBySubject", "s", "ao",
+                              handleFindBySubject),
+    sdbusplus::vtable::method("FindByIssuer", "s", "ao", handleFindByIssuer),
+    sdbusplus::vtable::method("FindBySerialNumber", "ss", "ao",
+                              handleFindBySerialNumber),
+    sdbusplus::vtable::signal("ExpiryWindowCrossed", "ott"),
+    sdbusplus::vtable::end()};
+
+/** @brief Handler of the InstallCrl method of revocationInterface */
+int handleInstallCrl(sd_bus_message* msg, void* context, sd_bus_error* error)
+{
+    auto* manager = static_cast<Manager*>(context);
+    return replyToQuery<std::string>(
+        msg, error, [manager](const std::string& filePath) {
+        return manager->installCrl(filePath);
+    });
+}
+
+const sdbusplus::vtable_t revocationVtable[] = {
+    sdbusplus::vtable::start(),
+    sdbusplus::vtable::method("InstallCrl", "s", "ao", handleInstallCrl),
+    sdbusplus::vtable::end()};
+
+/** @brief Getter of the Calls property of metricsInterface */
+int getMetricsCalls(sd_bus*, const char*, const char*, const char*,
+                    sd_bus_message* reply, void*, sd_bus_error* error)
+{
+    return replyWithProperty(reply, error,
+                             metrics::registry().callsByOperation());
+}
+
+/** @brief Getter of the Errors property of metricsInterface */
+int getMetricsErrors(sd_bus*, const char*, const char*, const char*,
+                     sd_bus_message* reply, void*, sd_bus_error* error)
+{
+    return replyWithProperty(reply, error,
+                             metrics::registry().errorsByOperation());
+}
+
+/** @brief Getter of the Latency property of metricsInterface */
+int getMetricsLatency(sd_bus*, const char*, const char*, const char*,
+                      sd_bus_message* reply, void*, sd_bus_error* error)
+{
+    return replyWithProperty(reply, error,
+                             metrics::registry().latencyByOperation());
+}
+
+/** @brief Getter of the Duration property of metricsInterface */
+int getMetricsDuration(sd_bus*, const char*, const char*, const char*,
+                       sd_bus_message* reply, void*, sd_bus_error* error)
+{
+    return replyWithProperty(reply, error,
+                             metrics::registry().durationByOperation());
+}
+
+/** @brief Getter of the Counters property of metricsInterface */
+int getMetricsCounters(sd_bus*, const char*, const char*, const char*,
+                       sd_bus_message* reply, void*, sd_bus_error* error)
+{
+    return replyWithProperty(reply, error,
+                             metrics::registry().countersByName());
+}
+
+// The metrics change on every call; they are read on demand, without
+// PropertiesChanged signals
+const sdbusplus::vtable_t metricsVtable[] = {
+    sdbusplus::vtable::start(),
+    sdbusplus::vtable::property("Calls", "a{st}", getMetricsCalls),
+    sdbusplus::vtable::property("Errors", "a{sa{st}}", getMetricsErrors),
+    sdbusplus::vtable::property("Latency", "a{sat}", getMetricsLatency),
+    sdbusplus::vtable::property("Duration", "a{st}", getMetricsDuration),
+    sdbusplus::vtable::property("Counters", "a{st}", getMetricsCounters),
+    sdbusplus::vtable::end()};
+
+/** @brief Getter of the properties of memoryUsageInterface, by |property|
+ *  name
+ */
+int getMemoryUsage(sd_bus*, const char*, const char*, const char* property,
+                   sd_bus_message* reply, void* context, sd_bus_error* error)
+{
+    const auto usage = static_cast<const Manager*>(context)->memoryUsage();
+    const std::string_view name = property;
+    uint64_t value = usage.residentBytes;
+    if (name == "Certificates")
+    {
+        value = usage.certificates.objects;
+    }
+    else if (name == "CertificateBytes")
+    {
+        value = usage.certificates.bytes;
+    }
+    else if (name == "CertificateIndexBytes")
+    {
+        value = usage.certificates.indexBytes;
+    }
+    else if (name == "Signatures")
+    {
+        value = usage.signatures.objects;
+    }
+    else if (name == "SignatureBytes")
+    {
+        value = usage.signatures.bytes;
+    }
+    else if (name == "SignatureIndexBytes")
+    {
+        value = usage.signatures.indexBytes;
+    }
+    else if (name == "TotalBytes")
     {
-        lg2::error("Failed to read certificates list, ERR:{ERR}, SRC:{SRC}",
-                   "ERR", e, "SRC", sourceFilePath);
+        value = usage.totalBytes;
+    }
+    return replyWithProperty(reply, error, value);
+}
+
+// Estimated on demand, as SIGUSR1 does, without PropertiesChanged signals
+const sdbusplus::vtable_t memoryUsageVtable[] = {
+    sdbusplus::vtable::start(),
+    sdbusplus::vtable::property("Certificates", "t", getMemoryUsage),
+    sdbusplus::vtable::property("CertificateBytes", "t", getMemoryUsage),
+    sdbusplus::vtable::property("CertificateIndexBytes", "t",
+                                getMemoryUsage),
+    sdbusplus::vtable::property("Signatures", "t", getMemoryUsage),
+    sdbusplus::vtable::property("SignatureBytes", "t", getMemoryUsage),
+    sdbusplus::vtable::property("SignatureIndexBytes", "t", getMemoryUsage),
+    sdbusplus::vtable::property("TotalBytes", "t", getMemoryUsage),
+    sdbusplus::vtable::property("ResidentBytes", "t", getMemoryUsage),
+    sdbusplus::vtable::end()};
+
+/** @brief Block SIGCHLD, so that the event loop can handle it
+ */
+void blockChildSignal()
+{
+    sigset_t ss;
+    if (sigemptyset(&ss) < 0)
+    {
+        lg2::error("Unable to initialize signal set");
         elog<InternalFailure>();
     }
-    std::string pem = pemStream.str();
-    size_t begin = 0;
-    // |begin| points to the current start position for searching the next
-    // |beginCertificate| block. When we find the beginning of the certificate,
-    // we extract the content between the beginning and the end of the current
-    // certificate. And finally we move |begin| to the end of the current
-    // certificate to start searching the next potential certificate.
-    for (begin = pem.find(beginCertificate, begin); begin != std::string::npos;
-         begin = pem.find(beginCertificate, begin))
+    if (sigaddset(&ss, SIGCHLD) < 0)
+    {
+        lg2::error("Unable to add signal to signal set");
+        elog<InternalFailure>();
+    }
+    if (sigprocmask(SIG_BLOCK, &ss, nullptr) < 0)
+    {
+        lg2::error("Unable to block signal");
+        elog<InternalFailure>();
+    }
+}
+
+/** @brief Directory |to| is moved to while exchangeDirectories() falls back
+ *  to renames
+ */
+fs::path getRetiredPath(const fs::path& from)
+{
+    fs::path retired = from;
+    retired += ".old";
+    return retired;
+}
+
+/** @brief Flush the files and directories of a tree to storage, symbolic
+ *  links being flushed with their directory
+ */
+void syncTree(const fs::path& directory)
+{
+    try
     {
-        size_t end = pem.find(endCertificate, begin);
-        if (end == std::string::npos)
+        for (const auto& entry : fs::recursive_directory_iterator(directory))
         {
-            lg2::error(
-                "invalid PEM contains a BEGIN identifier without an END");
-            elog<InvalidCertificate>(InvalidCertificateReason(
-                "invalid PEM contains a BEGIN identifier without an END"));
+            if (!entry.is_symlink() &&
+                (entry.is_regular_file() || entry.is_directory()))
+            {
+                syncPath(entry.path());
+            }
         }
-        end += endCertificate.size();
-        certificatesList.emplace_back(pem.substr(begin, end - begin));
-        begin = end;
+        syncPath(directory);
+    }
+    catch (const std::exception& e)
+    {
+        lg2::error("Failed to sync directory, ERR:{ERR}, DIR:{DIR}", "ERR", e,
+                   "DIR", directory);
+        elog<InternalFailure>();
+    }
+}
+
+/** @brief Flush the renames of an exchangeDirectories() call; the swap is
+ *  done, so that a failure is only logged
+ */
+void syncParent(const fs::path& path)
+{
+    try
+    {
+        syncPath(path.parent_path());
+    }
+    catch (const std::system_error& e)
+    {
+        lg2::warning("Failed to sync directory, ERR:{ERR}, DIR:{DIR}", "ERR",
+                     e, "DIR", path.parent_path());
+    }
+}
+
+/** @brief Atomically swap two directories
+ *  @details |from| is flushed first, so that a power loss after the swap
+ *  never publishes truncated files, and the parent directory after it.
+ *  Where the file system can't exchange, falls back to three renames,
+ *  leaving |to| missing for a moment; see recoverExchange().
+ */
+void exchangeDirectories(const fs::path& from, const fs::path& to)
+{
+    syncTree(from);
+    if (renameat2(AT_FDCWD, from.c_str(), AT_FDCWD, to.c_str(),
+                  RENAME_EXCHANGE) == 0)
+    {
+        syncParent(to);
+        return;
+    }
+    if (errno != EINVAL && errno != ENOSYS)
+    {
+        lg2::error("Failed to exchange directories, ERRNO:{ERRNO}, "
+                   "FROM:{FROM}, TO:{TO}",
+                   "ERRNO", errno, "FROM", from, "TO", to);
+        elog<InternalFailure>();
+    }
+    lg2::warning("Directories can't be exchanged atomically, DIR:{DIR}", "DIR",
+                 to);
+    try
+    {
+        fs::path retired = getRetiredPath(from);
+        fs::remove_all(retired);
+        fs::rename(to, retired);
+        fs::rename(from, to);
+        fs::rename(retired, from);
+    }
+    catch (const fs::filesystem_error& e)
+    {
+        lg2::error("Failed to exchange directories, ERR:{ERR}", "ERR", e);
+        elog<InternalFailure>();
+    }
+    syncParent(to);
+}
+
+/** @brief Undo what a power loss left of an exchangeDirectories() call
+ *  @details A generation interrupted before it replaced |to| is dropped,
+ *  one interrupted halfway through the renames rolled back: if |to| was
+ *  already moved aside, it is moved back. |from| is removed in any case.
+ */
+void recoverExchange(const fs::path& from, const fs::path& to)
+{
+    fs::path retired = getRetiredPath(from);
+    if (!fs::exists(to) && fs::is_directory(retired))
+    {
+        lg2::warning("Restoring the store from an interrupted exchange, "
+                     "DIR:{DIR}",
+                     "DIR", to);
+        fs::rename(retired, to);
     }
-    return certificatesList;
+    fs::remove_all(from);
+    fs::remove_all(retired);
 }
 
 } // namespace
 
 Manager::Manager(sdbusplus::bus_t& bus, sdeventplus::Event& event,
                  const char* path, CertificateType type,
-                 const std::string& unit, const std::string& installPath) :
+                 const std::string& unit, const std::string& installPath,
+                 StorageFormat format) :
     internal::ManagerInterface(bus, path),
     bus(bus), event(event), objectPath(path), certType(type),
     unitToRestart(std::move(unit)), certInstallPath(std::move(installPath)),
+    storageFormat(format), expiryIndex(expiryWindows()),
     certParentInstallPath(fs::path(certInstallPath).parent_path())
 {
+    metrics::registry().setEndpoint(objectPath);
+    queryIntf = std::make_unique<sdbusplus::server::interface_t>(
+        bus, objectPath.c_str(), queryInterface, queryVtable, this);
+    metricsIntf = std::make_unique<sdbusplus::server::interface_t>(
+        bus, objectPath.c_str(), metricsInterface, metricsVtable, this);
+    memoryUsageIntf = std::make_unique<sdbusplus::server::interface_t>(
+        bus, objectPath.c_str(), memoryUsageInterface, memoryUsageVtable,
+        this);
+    if (certificateTypePolicy(certType).hashLinked)
+    {
+        revocationIntf = std::make_unique<sdbusplus::server::interface_t>(
+            bus, objectPath.c_str(), revocationInterface, revocationVtable,
+            this);
+    }
+
+    // Server and client files are read by their consumers as they are, the
+    // private key included
+    if (storageFormat != StorageFormat::pem &&
+        (certType == CertificateType::server ||
+         certType == CertificateType::client))
+    {
+        lg2::warning("Storage format not supported for the type, keeping PEM, "
+                     "TYPE:{TYPE}",
+                     "TYPE", certificateTypeToString(certType));
+        storageFormat = StorageFormat::pem;
+    }
+    if (storageFormat == StorageFormat::der &&
+        certificateTypePolicy(certType).hashLinked)
+    {
+        pemViewPath = fs::path(pemViewDirectory) /
+                      fs::path(certInstallPath).relative_path();
+    }
+
     try
     {
         // Create certificate directory if not existing.
@@ -144,6 +481,7 @@ Manager::Manager(sdbusplus::bus_t& bus, sdeventplus::Event& event,
         fs::path certDirectory;
         try
         {
+            trace::Span span("directories");
             if (certType == CertificateType::authority ||
                 certType == CertificateType::authorityBios ||
                 certType == CertificateType::securebootDatabase)
@@ -155,6 +493,12 @@ Manager::Manager(sdbusplus::bus_t& bus, sdeventplus::Event& event,
                 certDirectory = certParentInstallPath;
             }
 
+            // Before anything looks at the store, see publishAuthorities()
+            if (certificateTypePolicy(certType).hashLinked)
+            {
+                recoverExchange(getStagingPath(), certInstallPath);
+            }
+
             if (!fs::exists(certDirectory))
             {
                 fs::create_directories(certDirectory);
@@ -164,6 +508,12 @@ Manager::Manager(sdbusplus::bus_t& bus, sdeventplus::Event& event,
                               fs::perms::owner_exec;
             fs::permissions(certDirectory, permission,
                             fs::perm_options::replace);
+            if (!pemViewPath.empty())
+            {
+                fs::create_directories(pemViewPath);
+                fs::permissions(pemViewPath, permission,
+                                fs::perm_options::replace);
+            }
             storageUpdate();
         }
         catch (const fs::filesystem_error& e)
@@ -174,21 +524,53 @@ Manager::Manager(sdbusplus::bus_t& bus, sdeventplus::Event& event,
             report<InternalFailure>();
         }
 
+        // Share the certificate files with the other endpoints; server and
+        // client files hold the endpoint's private key too
+        if (!std::string_view(blobStoreDirectory).empty() &&
+            !certificateTypePolicy(certType).pairedWithPrivateKey)
+        {
+            try
+            {
+                trace::Span span("blobStore");
+                blobStore = std::make_unique<BlobStore>(blobStoreDirectory);
+            }
+            catch (const fs::filesystem_error& e)
+            {
+                lg2::error("Failed to create the blob store, ERR:{ERR}, "
+                           "DIRECTORY:{DIRECTORY}",
+                           "ERR", e, "DIRECTORY", blobStoreDirectory);
+            }
+        }
+
         // Generating RSA private key file if certificate type is server/client
         if (certType == CertificateType::server ||
             certType == CertificateType::client)
         {
+            trace::Span span("rsaKey");
             createRSAPrivateKeyFile();
         }
 
+        // Index the CRLs first, so that the certificates they revoke are
+        // flagged as they are restored
+        if (certificateTypePolicy(certType).hashLinked)
+        {
+            trace::Span span("crls");
+            restoreCrls();
+        }
+
         // restore any existing certificates
-        createCertificates();
+        trace::Span restoreSpan("restore");
+        metrics::measure(metrics::Operation::restore,
+                         [this] { createCertificates(); });
+        restoreSpan.arg("certificates", installedCerts.size());
+        restoreSpan.end();
 
         // watch is not required for authority certificates
         if (certType == CertificateType::server ||
             certType == CertificateType::client)
         {
             // watch for certificate file create/replace
+            trace::Span span("watch");
             certWatchPtr = std::make_unique<Watch>(event, certInstallPath,
                                                    [this]() {
                 try
@@ -198,7 +580,7 @@ Manager::Manager(sdbusplus::bus_t& bus, sdeventplus::Event& event,
                     {
                         lg2::info("Inotify callback to update "
                                   "certificate properties");
-                        installedCerts[0]->populateProperties();
+                        installedCerts.begin()->second->populateProperties();
                     }
                     else
                     {
@@ -206,6 +588,7 @@ Manager::Manager(sdbusplus::bus_t& bus, sdeventplus::Event& event,
                             "Inotify callback to create certificate object");
                         createCertificates();
                     }
+                    armExpiryTimer();
                 }
                 catch (const InternalFailure& e)
                 {
@@ -222,6 +605,7 @@ Manager::Manager(sdbusplus::bus_t& bus, sdeventplus::Event& event,
         {
             try
             {
+                trace::Span span("legacyMigration");
                 const std::string singleCertPath = "/etc/ssl/certs/Root-CA.pem";
                 if (fs::exists(singleCertPath) && !fs::is_empty(singleCertPath))
                 {
@@ -248,9 +632,13 @@ Manager::Manager(sdbusplus::bus_t& bus, sdeventplus::Event& event,
         }
         else if (certType == CertificateType::securebootDatabase)
         {
+            trace::Span span("signatures");
             sigManager = std::make_unique<phosphor::certs::SigManager>(
                 bus, event, path, certType, certInstallPath + "/signature");
         }
+        restoreExpiryState();
+        armExpiryTimer();
+        updateAssociations();
     }
     catch (const std::exception& ex)
     {
@@ -258,9 +646,24 @@ Manager::Manager(sdbusplus::bus_t& bus, sdeventplus::Event& event,
             "Error in certificate manager constructor, ERROR_STR:{ERROR_STR}",
             "ERROR_STR", ex);
     }
+    restoring = false;
+}
+
+Manager::~Manager()
+{
+    if (keyGenFd >= 0)
+    {
+        close(keyGenFd);
+    }
 }
 
 std::string Manager::install(const std::string filePath)
+{
+    return metrics::measure(metrics::Operation::install,
+                            [&] { return installCertificate(filePath); });
+}
+
+std::string Manager::installCertificate(const std::string& filePath)
 {
     if (certType == CertificateType::server ||
         certType == CertificateType::client)
@@ -283,13 +686,15 @@ std::string Manager::install(const std::string filePath)
         if (certType == CertificateType::securebootDatabase)
         {
             auto certificateId = allocId();
-            certObjectPath = objectPath + "/certs/" +
-                             std::to_string(certificateId);
+            certObjectPath = getCertificateObjectPath(certificateId);
             try
             {
-                installedCerts.emplace_back(std::make_unique<Certificate>(
-                    bus, certObjectPath, certType, certInstallPath, filePath,
-                    certWatchPtr.get(), *this, /*restore=*/false));
+                installedCerts.emplace(
+                    certificateId,
+                    std::make_unique<Certificate>(
+                        bus, certObjectPath, certificateId, certType,
+                        certInstallPath, filePath, certWatchPtr.get(), *this,
+                        /*restore=*/false));
             }
             catch (const std::exception& ex)
             {
@@ -302,16 +707,21 @@ std::string Manager::install(const std::string filePath)
         }
         else
         {
-            certObjectPath = objectPath + '/' + std::to_string(certIdCounter);
-            certIdCounter++;
-            installedCerts.emplace_back(std::make_unique<Certificate>(
-                bus, certObjectPath, certType, certInstallPath, filePath,
-                certWatchPtr.get(), *this, /*restore=*/false));
+            auto certificateId = certIds.allocate();
+            certObjectPath = getCertificateObjectPath(certificateId);
+            installedCerts.emplace(
+                certificateId,
+                std::make_unique<Certificate>(
+                    bus, certObjectPath, certificateId, certType,
+                    certInstallPath, filePath, certWatchPtr.get(), *this,
+                    /*restore=*/false));
         }
+        armExpiryTimer();
+        updateAssociations();
         reloadOrReset(unitToRestart);
         using namespace phosphor::logging;
-        sendEvent(MESSAGE_TYPE::RESOURCE_CREATED, Entry::Level::Informational,
-                  std::vector<std::string>{}, certObjectPath);
+        sendCertificateEvent(MESSAGE_TYPE::RESOURCE_CREATED,
+                             Entry::Level::Informational, {}, certObjectPath);
     }
     else
     {
@@ -324,28 +734,52 @@ std::string Manager::install(const std::string filePath)
 std::vector<sdbusplus::message::object_path>
     Manager::installAll(const std::string filePath)
 {
-    if ((certType != CertificateType::authority) &&
-        (certType != CertificateType::authorityBios))
-    {
-        elog<NotAllowed>(
-            NotAllowedReason("The InstallAll interface is only allowed for "
-                             "Authority certificates"));
-    }
+    return metrics::measure(metrics::Operation::installAll, [&] {
+        if ((certType != CertificateType::authority) &&
+            (certType != CertificateType::authorityBios))
+        {
+            elog<NotAllowed>(
+                NotAllowedReason("The InstallAll interface is only allowed "
+                                 "for Authority certificates"));
+        }
 
-    if (!installedCerts.empty())
-    {
-        elog<NotAllowed>(NotAllowedReason(
-            "There are already root certificates; Call DeleteAll then "
-            "InstallAll, or use ReplaceAll"));
-    }
+        if (!installedCerts.empty())
+        {
+            elog<NotAllowed>(NotAllowedReason(
+                "There are already root certificates; Call DeleteAll then "
+                "InstallAll, or use ReplaceAll"));
+        }
+
+        return publishAuthorities(filePath);
+    });
+}
+
+std::vector<sdbusplus::message::object_path>
+    Manager::replaceAll(std::string filePath)
+{
+    return metrics::measure(metrics::Operation::replaceAll, [&] {
+        if ((certType != CertificateType::authority) &&
+            (certType != CertificateType::authorityBios))
+        {
+            elog<NotAllowed>(
+                NotAllowedReason("The ReplaceAll interface is only allowed "
+                                 "for Authority certificates"));
+        }
 
+        return publishAuthorities(filePath);
+    });
+}
+
+std::vector<sdbusplus::message::object_path>
+    Manager::publishAuthorities(const std::string& filePath)
+{
     fs::path sourceFile(filePath);
     if (!fs::exists(sourceFile))
     {
         lg2::error("File is Missing, FILE:{FILE}", "FILE", filePath);
         elog<InternalFailure>();
     }
-    std::vector<std::string> authorities = splitCertificates(sourceFile);
+    auto authorities = loadCertificates(sourceFile);
     if (authorities.size() > maxNumAuthorityCertificates)
     {
         elog<NotAllowed>(NotAllowedReason("Certificates limit reached"));
@@ -353,54 +787,116 @@ std::vector<sdbusplus::message::object_path>
 
     lg2::info("Starts authority list install");
 
+    // The new generation of the store is built next to the current one, and
+    // swapped with it once complete
     fs::path authorityStore(certInstallPath);
-    fs::path authoritiesListFile = authorityStore /
-                                   defaultAuthoritiesListFileName;
-
-    // Atomically install all the certificates
-    fs::path tempPath = Certificate::generateUniqueFilePath(authorityStore);
-    fs::create_directory(tempPath);
-    // Copies the authorities list
-    Certificate::copyCertificate(sourceFile,
-                                 tempPath / defaultAuthoritiesListFileName);
-    std::vector<std::unique_ptr<Certificate>> tempCertificates;
-    uint64_t tempCertIdCounter = certIdCounter;
-    X509StorePtr x509Store = getX509Store(sourceFile);
-    for (const auto& authority : authorities)
-    {
-        std::string certObjectPath = objectPath + '/' +
-                                     std::to_string(tempCertIdCounter);
-        tempCertificates.emplace_back(std::make_unique<Certificate>(
-            bus, certObjectPath, certType, tempPath, *x509Store, authority,
-            certWatchPtr.get(), *this, /*restore=*/false));
-        tempCertIdCounter++;
-    }
-
-    // We are good now, issue swap
-    installedCerts = std::move(tempCertificates);
-    certIdCounter = tempCertIdCounter;
-    // Rename all the certificates including the authorities list
-    for (const fs::path& f : fs::directory_iterator(tempPath))
-    {
-        if (fs::is_symlink(f))
+    fs::path stagingStore = getStagingPath();
+    // Left over by a failed install
+    fs::remove_all(stagingStore);
+    fs::create_directory(stagingStore);
+    fs::permissions(stagingStore, fs::status(authorityStore).permissions(),
+                    fs::perm_options::replace);
+
+    CertificateMap addedCertificates;
+    std::vector<uint64_t> addedCertIdList;
+    std::set<uint64_t> keptCertIds;
+    IdAllocator generationCertIds = certIds;
+    try
+    {
+        // Copies the authorities list, in the storage format
+        fs::path stagedList = stagingStore / defaultAuthoritiesListFileName;
+        if (getFileStorageFormat(sourceFile) == storageFormat)
         {
+            Certificate::copyCertificate(sourceFile, stagedList);
+        }
+        else
+        {
+            std::string list;
+            for (const auto& authority : authorities)
+            {
+                list += encodeCertificate(*authority, storageFormat);
+            }
+            Certificate::dumpCertificate(list, stagedList);
+        }
+
+        X509StorePtr x509Store = getX509Store(authorities);
+        for (const auto& authority : authorities)
+        {
+            // The certificates of both generations keep their objects
+            auto matches = fingerprintIndex.find(
+                generateFingerprint(*authority));
+            if (auto kept = std::find_if(matches.begin(), matches.end(),
+                                         [&](uint64_t certificateId) {
+                return installedCerts.contains(certificateId) &&
+                       !keptCertIds.contains(certificateId);
+            });
+                kept != matches.end())
+            {
+                installedCerts.at(*kept)->stage(stagingStore);
+                keptCertIds.emplace(*kept);
+                continue;
+            }
+            // IDs of the current generation are still in use; the new
+            // objects have to coexist with them until the swap
+            auto certificateId = generationCertIds.allocate();
+            std::string certObjectPath =
+                getCertificateObjectPath(certificateId);
+            addedCertificates.emplace(
+                certificateId,
+                std::make_unique<Certificate>(
+                    bus, certObjectPath, certificateId, certType,
+                    stagingStore, *x509Store, *authority, certWatchPtr.get(),
+                    *this, /*restore=*/false));
+            addedCertIdList.emplace_back(certificateId);
+        }
+
+        exchangeDirectories(stagingStore, authorityStore);
+    }
+    catch (...)
+    {
+        addedCertificates.clear();
+        std::error_code ec;
+        fs::remove_all(stagingStore, ec);
+        throw;
+    }
+
+    // The staging path holds the retired generation now; the removed
+    // certificates delete their files there
+    CertificateMap removedCertificates;
+    for (auto it = installedCerts.begin(); it != installedCerts.end();)
+    {
+        if (keptCertIds.contains(it->first))
+        {
+            ++it;
             continue;
         }
-        fs::rename(/*from=*/f, /*to=*/certInstallPath / f.filename());
+        it->second->setCertInstallPath(stagingStore);
+        generationCertIds.release(it->first);
+        removedCertificates.emplace(it->first, std::move(it->second));
+        it = installedCerts.erase(it);
     }
-    // Update file locations and create symbol links
-    for (const auto& cert : installedCerts)
+    for (auto& [certificateId, cert] : addedCertificates)
     {
         cert->setCertInstallPath(certInstallPath);
-        cert->setCertFilePath(certInstallPath /
-                              fs::path(cert->getCertFilePath()).filename());
-        cert->storageUpdate();
     }
-    // Remove the temporary folder
-    fs::remove_all(tempPath);
+    installedCerts.merge(addedCertificates);
+    certIds = std::move(generationCertIds);
+    removedCertificates.clear();
+    fs::remove_all(stagingStore);
+    prunePemViews();
+    if (blobStore)
+    {
+        blobStore->collectGarbage();
+    }
+    pruneCrls();
+    // Link the objects to their issuers before they are announced
+    updateAssociations();
+    // Announce the new objects only once the generation is published
+    announceCertificates(addedCertIdList);
+    armExpiryTimer();
 
     std::vector<sdbusplus::message::object_path> objects;
-    for (const auto& certificate : installedCerts)
+    for (const auto& [certificateId, certificate] : installedCerts)
     {
         objects.emplace_back(certificate->getObjectPath());
     }
@@ -410,16 +906,198 @@ std::vector<sdbusplus::message::object_path>
     return objects;
 }
 
-std::vector<sdbusplus::message::object_path>
-    Manager::replaceAll(std::string filePath)
+fs::path Manager::getStagingPath() const
 {
-    installedCerts.clear();
-    certIdCounter = 1;
-    storageUpdate();
-    return installAll(std::move(filePath));
+    fs::path stagingPath(certInstallPath);
+    stagingPath += ".staging";
+    return stagingPath;
+}
+
+std::string Manager::renderPem(const std::string& filePath)
+{
+    auto stamp = getFileStamp(filePath);
+    if (!stamp)
+    {
+        return {};
+    }
+    if (pemRenderingPath == filePath && pemRenderingStamp == stamp)
+    {
+        return pemRendering;
+    }
+    try
+    {
+        pemRendering = encodeCertificate(*loadCert(filePath),
+                                         StorageFormat::pem);
+    }
+    catch (const std::exception& e)
+    {
+        lg2::error("Unable to render the certificate, FILE:{FILE}, ERR:{ERR}",
+                   "FILE", filePath, "ERR", e);
+        pemRenderingStamp.reset();
+        return {};
+    }
+    pemRenderingPath = filePath;
+    pemRenderingStamp = stamp;
+    return pemRendering;
+}
+
+fs::path Manager::getCrlPath() const
+{
+    fs::path crlPath(certInstallPath);
+    crlPath += ".crl";
+    return crlPath;
+}
+
+void Manager::restoreCrls()
+{
+    fs::path crlPath = getCrlPath();
+    if (!fs::is_directory(crlPath))
+    {
+        return;
+    }
+    for (auto& path : fs::directory_iterator(crlPath))
+    {
+        // A ".tmp" file is an interrupted writeFileAtomically()
+        if (!fs::is_regular_file(path) || path.path().extension() == ".tmp")
+        {
+            continue;
+        }
+        try
+        {
+            // Their signatures were verified when they were installed
+            for (const auto& crl : loadCrls(path.path()))
+            {
+                crlFiles.insert_or_assign(indexCrl(*crl), path.path());
+            }
+        }
+        catch (const std::exception& e)
+        {
+            lg2::error("Failed to restore CRL, FILE:{FILE}, ERR:{ERR}", "FILE",
+                       path.path(), "ERR", e);
+        }
+    }
+    lg2::info("CRLs restored, ENDPOINT:{ENDPOINT}, ISSUERS:{ISSUERS}, "
+              "SERIALS:{SERIALS}",
+              "ENDPOINT", objectPath, "ISSUERS", crlFiles.size(), "SERIALS",
+              revocations.size());
+}
+
+std::string Manager::indexCrl(X509_CRL& crl)
+{
+    std::string issuer = formatName(*X509_CRL_get_issuer(&crl));
+    std::vector<std::string> serialNumbers;
+    STACK_OF(X509_REVOKED)* revoked = X509_CRL_get_REVOKED(&crl);
+    serialNumbers.reserve(static_cast<size_t>(sk_X509_REVOKED_num(revoked)));
+    for (int i = 0; i < sk_X509_REVOKED_num(revoked); ++i)
+    {
+        const X509_REVOKED* entry = sk_X509_REVOKED_value(revoked, i);
+        serialNumbers.emplace_back(
+            getSerialNumberBytes(*X509_REVOKED_get0_serialNumber(entry)));
+    }
+    revocations.set(issuer, std::move(serialNumbers));
+    return issuer;
+}
+
+bool Manager::isCrlIssuerInstalled(X509_CRL& crl) const
+{
+    for (auto certificateId :
+         subjectIndex.find(formatName(*X509_CRL_get_issuer(&crl))))
+    {
+        auto it = installedCerts.find(certificateId);
+        if (it == installedCerts.end())
+        {
+            continue;
+        }
+        auto cert = loadCert(it->second->getCertFilePath());
+        EVP_PKEY* key = X509_get0_pubkey(cert.get());
+        if (key != nullptr && X509_CRL_verify(&crl, key) == 1)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool Manager::isNewerThanStoredCrl(X509_CRL& crl) const
+{
+    auto it = crlFiles.find(formatName(*X509_CRL_get_issuer(&crl)));
+    if (it == crlFiles.end())
+    {
+        return true;
+    }
+    try
+    {
+        return isNewerCrl(crl, *loadCrls(it->second).front());
+    }
+    catch (const std::exception& e)
+    {
+        // An unreadable CRL is replaced by any other
+        lg2::warning("Unable to read the stored CRL, FILE:{FILE}, ERR:{ERR}",
+                     "FILE", it->second, "ERR", e);
+        return true;
+    }
+}
+
+void Manager::pruneCrls()
+{
+    for (auto it = crlFiles.begin(); it != crlFiles.end();)
+    {
+        const auto& [issuer, crlFile] = *it;
+        auto issuerIds = subjectIndex.find(issuer);
+        if (std::any_of(issuerIds.begin(), issuerIds.end(),
+                        [this](uint64_t certificateId) {
+            return installedCerts.contains(certificateId);
+        }))
+        {
+            ++it;
+            continue;
+        }
+        std::error_code ec;
+        fs::remove(crlFile, ec);
+        if (ec)
+        {
+            lg2::warning("Unable to remove the CRL, FILE:{FILE}, ERR:{ERR}",
+                         "FILE", crlFile, "ERR", ec.message());
+        }
+        for (auto certificateId : issuerIndex.find(issuer))
+        {
+            revokedCertIds.erase(certificateId);
+            staleAssociations.emplace(certificateId);
+        }
+        revocations.erase(issuer);
+        lg2::info("CRL removed with its issuer, ISSUER:{ISSUER}", "ISSUER",
+                  issuer);
+        it = crlFiles.erase(it);
+    }
+}
+
+void Manager::prunePemViews()
+{
+    if (pemViewPath.empty() || !fs::is_directory(pemViewPath))
+    {
+        return;
+    }
+    std::set<fs::path> names;
+    for (const auto& [certificateId, cert] : installedCerts)
+    {
+        names.emplace(fs::path(cert->getCertFilePath()).filename());
+    }
+    for (auto& viewPath : fs::directory_iterator(pemViewPath))
+    {
+        if (!names.contains(viewPath.path().filename()))
+        {
+            fs::remove(viewPath);
+        }
+    }
 }
 
 void Manager::deleteAll()
+{
+    metrics::measure(metrics::Operation::deleteAll,
+                     [this] { deleteAllCertificates(); });
+}
+
+void Manager::deleteAllCertificates()
 {
     // TODO: #Issue 4 when a certificate is deleted system auto generates
     // certificate file. At present we are not supporting creation of
@@ -438,14 +1116,12 @@ void Manager::deleteAll()
             fs::remove(authoritiesList);
         }
     }
-    certIdCounter = 1;
+    certIds.reset();
     storageUpdate();
+    armExpiryTimer();
+    pruneCrls();
+    updateAssociations();
     reloadOrReset(unitToRestart);
-    if (certType == CertificateType::securebootDatabase)
-    {
-        certIdUnused.clear();
-        certIdCounter = 1;
-    }
 
     if (sigManager)
     {
@@ -455,27 +1131,24 @@ void Manager::deleteAll()
 
 void Manager::deleteCertificate(const Certificate* const certificate)
 {
-    const std::vector<std::unique_ptr<Certificate>>::iterator& certIt =
-        std::find_if(installedCerts.begin(), installedCerts.end(),
-                     [certificate](const std::unique_ptr<Certificate>& cert) {
-        return (cert.get() == certificate);
-    });
-    if (certIt != installedCerts.end())
+    auto certIt = installedCerts.find(certificate->getObjectId());
+    if (certIt != installedCerts.end() && certIt->second.get() == certificate)
     {
         if (certType == CertificateType::securebootDatabase)
         {
-            auto certificateId =
-                std::stoull(fs::path(certificate->getObjectPath()).filename());
-            releaseId(certificateId);
+            releaseId(certIt->first);
         }
         auto objectPath = certificate->getObjectPath();
         installedCerts.erase(certIt);
         storageUpdate();
+        armExpiryTimer();
+        pruneCrls();
+        updateAssociations();
         reloadOrReset(unitToRestart);
         // send an event
         using namespace phosphor::logging;
-        sendEvent(MESSAGE_TYPE::RESOURCE_DELETED, Entry::Level::Informational,
-                  std::vector<std::string>{}, objectPath);
+        sendCertificateEvent(MESSAGE_TYPE::RESOURCE_DELETED,
+                             Entry::Level::Informational, {}, objectPath);
     }
     else
     {
@@ -492,12 +1165,16 @@ void Manager::replaceCertificate(Certificate* const certificate,
     {
         certificate->install(filePath, false);
         storageUpdate();
+        armExpiryTimer();
+        pruneCrls();
+        updateAssociations();
         reloadOrReset(unitToRestart);
 
         // send an event
         using namespace phosphor::logging;
-        sendEvent(MESSAGE_TYPE::RESOURCE_CREATED, Entry::Level::Informational,
-                  std::vector<std::string>{}, certificate->getObjectPath());
+        sendCertificateEvent(MESSAGE_TYPE::RESOURCE_CREATED,
+                             Entry::Level::Informational, {},
+                             certificate->getObjectPath());
     }
     else
     {
@@ -514,8 +1191,24 @@ std::string Manager::generateCSR(
     std::string organization, std::string organizationalUnit, std::string state,
     std::string surname, std::string unstructuredName)
 {
+    // Times the fork only; the CSR is generated by the child
+    metrics::Timer timer(metrics::Operation::generateCSR);
     // We support only one CSR.
     csrPtr.reset(nullptr);
+    if (keyPairAlgorithm == "RSA" && keyGenFd < 0)
+    {
+        // Decrypt the key once in this process; CSR processes inherit it
+        try
+        {
+            refreshRSAKeyCache();
+        }
+        catch (const InternalFailure& e)
+        {
+            // The CSR process reads the file itself and reports the error
+            rsaKeyCache.reset();
+            rsaKeyStamp.reset();
+        }
+    }
     auto pid = fork();
     if (pid == -1)
     {
@@ -566,43 +1259,485 @@ std::string Manager::generateCSR(
         };
         try
         {
-            sigset_t ss;
-            if (sigemptyset(&ss) < 0)
+            blockChildSignal();
+            if (childPtr)
             {
-                lg2::error("Unable to initialize signal set");
-                elog<InternalFailure>();
+                childPtr.reset();
             }
-            if (sigaddset(&ss, SIGCHLD) < 0)
+            childPtr = std::make_unique<Child>(event, pid, WEXITED | WSTOPPED,
+                                               std::move(callback));
+        }
+        catch (const InternalFailure& e)
+        {
+            commit<InternalFailure>();
+        }
+    }
+    auto csrObjectPath = objectPath + '/' + "csr";
+    return csrObjectPath;
+}
+
+CertificateMap& Manager::getCertificates()
+{
+    return installedCerts;
+}
+
+const std::string& Manager::getObjectPath() const
+{
+    return objectPath;
+}
+
+std::string Manager::getCertificateObjectPath(uint64_t id) const
+{
+    if (certType == CertificateType::securebootDatabase)
+    {
+        return objectPath + "/certs/" + std::to_string(id);
+    }
+    return objectPath + '/' + std::to_string(id);
+}
+
+std::vector<std::string>
+    Manager::getObjectPaths(const std::vector<uint64_t>& ids) const
+{
+    std::vector<std::string> paths;
+    for (auto certificateId : ids)
+    {
+        if (auto it = installedCerts.find(certificateId);
+            it != installedCerts.end())
+        {
+            paths.emplace_back(it->second->getObjectPath());
+        }
+    }
+    return paths;
+}
+
+std::vector<std::string> Manager::getExpiringBefore(uint64_t time) const
+{
+    return getObjectPaths(expiryIndex.expiringBefore(time));
+}
+
+std::vector<std::string>
+    Manager::findByFingerprint(const std::string& fingerprint) const
+{
+    return getObjectPaths(fingerprintIndex.find(fingerprint));
+}
+
+std::vector<std::string>
+    Manager::findBySubject(const std::string& subject) const
+{
+    return getObjectPaths(subjectIndex.find(subject));
+}
+
+std::vector<std::string> Manager::findByIssuer(const std::string& issuer) const
+{
+    return getObjectPaths(issuerIndex.find(issuer));
+}
+
+std::vector<std::string>
+    Manager::findBySerialNumber(const std::string& issuer,
+                                const std::string& serialNumber) const
+{
+    return getObjectPaths(
+        serialNumberIndex.find(serialNumberKey(issuer, serialNumber)));
+}
+
+std::optional<std::string> Manager::getIssuerPath(uint64_t id) const
+{
+    auto issuer = issuerGraph.issuerOf(id);
+    if (!issuer)
+    {
+        return std::nullopt;
+    }
+    auto paths = getObjectPaths({*issuer});
+    if (paths.empty())
+    {
+        return std::nullopt;
+    }
+    return paths.front();
+}
+
+std::vector<std::string> Manager::installCrl(const std::string& filePath)
+{
+    if (!certificateTypePolicy(certType).hashLinked)
+    {
+        elog<NotAllowed>(NotAllowedReason(
+            "CRLs are only allowed for Authority certificates"));
+    }
+    if (!fs::exists(filePath))
+    {
+        lg2::error("File is Missing, FILE:{FILE}", "FILE", filePath);
+        elog<InternalFailure>();
+    }
+    auto crls = loadCrls(filePath);
+    for (const auto& crl : crls)
+    {
+        if (!isCrlIssuerInstalled(*crl))
+        {
+            lg2::error("CRL issuer is not installed, ISSUER:{ISSUER}",
+                       "ISSUER", formatName(*X509_CRL_get_issuer(crl.get())));
+            elog<InvalidCertificate>(InvalidCertificateReason(
+                "CRL is not signed by an installed certificate"));
+        }
+        if (!isNewerThanStoredCrl(*crl))
+        {
+            lg2::error("CRL is not newer than the installed one, "
+                       "ISSUER:{ISSUER}",
+                       "ISSUER", formatName(*X509_CRL_get_issuer(crl.get())));
+            elog<InvalidCertificate>(InvalidCertificateReason(
+                "CRL is not newer than the installed one"));
+        }
+    }
+
+    fs::path crlPath = getCrlPath();
+    if (!fs::exists(crlPath))
+    {
+        fs::create_directories(crlPath);
+        fs::permissions(crlPath,
+                        fs::perms::owner_read | fs::perms::owner_write |
+                            fs::perms::owner_exec,
+                        fs::perm_options::replace);
+    }
+    std::set<std::string> updatedIssuers;
+    for (const auto& crl : crls)
+    {
+        // One file per issuer, named after the hash of its name, with a
+        // suffix telling apart the issuers whose names hash alike
+        std::string issuer = formatName(*X509_CRL_get_issuer(crl.get()));
+        fs::path crlFile;
+        if (auto it = crlFiles.find(issuer); it != crlFiles.end())
+        {
+            crlFile = it->second;
+        }
+        else
+        {
+            std::array<char, 9> hash{};
+            std::snprintf(hash.data(), hash.size(), "%08lx",
+                          X509_NAME_hash(X509_CRL_get_issuer(crl.get())));
+            for (int i = 0; crlFile.empty() || fs::exists(crlFile); ++i)
             {
-                lg2::error("Unable to add signal to signal set");
-                elog<InternalFailure>();
+                crlFile = crlPath /
+                          (std::string(hash.data()) + ".r" + std::to_string(i));
             }
+        }
+        Certificate::dumpCertificate(encodeCrl(*crl), crlFile);
+        crlFiles.insert_or_assign(indexCrl(*crl), crlFile);
+        updatedIssuers.emplace(issuer);
+    }
 
-            // Block SIGCHLD first, so that the event loop can handle it
-            if (sigprocmask(SIG_BLOCK, &ss, nullptr) < 0)
+    // Only the certificates of the issuers of the new CRLs change
+    std::vector<uint64_t> revokedIds;
+    for (const auto& issuer : updatedIssuers)
+    {
+        for (auto certificateId : issuerIndex.find(issuer))
+        {
+            auto it = installedCerts.find(certificateId);
+            if (it == installedCerts.end())
             {
-                lg2::error("Unable to block signal");
-                elog<InternalFailure>();
+                continue;
             }
-            if (childPtr)
+            staleAssociations.emplace(certificateId);
+            auto cert = loadCert(it->second->getCertFilePath());
+            if (!revocations.isRevoked(
+                    issuer,
+                    getSerialNumberBytes(*X509_get0_serialNumber(cert.get()))))
             {
-                childPtr.reset();
+                revokedCertIds.erase(certificateId);
+                continue;
             }
-            childPtr = std::make_unique<Child>(event, pid, WEXITED | WSTOPPED,
-                                               std::move(callback));
+            if (revokedCertIds.emplace(certificateId).second)
+            {
+                lg2::warning(
+                    "Certificate is revoked, CERTIFICATE:{CERTIFICATE}",
+                    "CERTIFICATE", it->second->getObjectPath());
+            }
+            revokedIds.push_back(certificateId);
         }
-        catch (const InternalFailure& e)
+    }
+    updateAssociations();
+    std::sort(revokedIds.begin(), revokedIds.end());
+    lg2::info("CRLs installed, ENDPOINT:{ENDPOINT}, CRLS:{CRLS}, "
+              "REVOKED:{REVOKED}",
+              "ENDPOINT", objectPath, "CRLS", crls.size(), "REVOKED",
+              revokedIds.size());
+    return getObjectPaths(revokedIds);
+}
+
+bool Manager::isRevoked(uint64_t id) const
+{
+    return revokedCertIds.contains(id);
+}
+
+void Manager::validateRevocation(X509& cert) const
+{
+    // Certificates stored before the CRL of their issuer are kept, flagged
+    if (restoring)
+    {
+        return;
+    }
+    if (revocations.isRevoked(
+            formatName(*X509_get_issuer_name(&cert)),
+            getSerialNumberBytes(*X509_get0_serialNumber(&cert))))
+    {
+        lg2::error("Certificate is revoked, SUBJECT:{SUBJECT}", "SUBJECT",
+                   formatName(*X509_get_subject_name(&cert)));
+        elog<InvalidCertificate>(
+            InvalidCertificateReason("Certificate is revoked"));
+    }
+}
+
+void Manager::indexCertificate(uint64_t id, X509& cert,
+                               const CertificateProperties& properties)
+{
+    // The certificates issued by its previous subject lose their issuer, and
+    // those issued by its subject may gain it
+    if (const auto* subject = subjectIndex.get(id);
+        subject != nullptr && *subject != properties.subject)
+    {
+        markIssuedBy(*subject);
+    }
+    markIssuedBy(properties.subject);
+    staleAssociations.emplace(id);
+    fingerprintIndex.set(id, generateFingerprint(cert));
+    subjectIndex.set(id, properties.subject);
+    issuerIndex.set(id, properties.issuer);
+    serialNumberIndex.set(
+        id, serialNumberKey(properties.issuer, formatSerialNumber(cert)));
+    issuerGraph.set(id, getSubjectKeyId(cert), getAuthorityKeyId(cert));
+    expiryIndex.update(id, properties.validNotAfter);
+    if (!revocations.isRevoked(
+            properties.issuer,
+            getSerialNumberBytes(*X509_get0_serialNumber(&cert))))
+    {
+        revokedCertIds.erase(id);
+    }
+    else if (revokedCertIds.emplace(id).second)
+    {
+        lg2::warning("Certificate is revoked, ENDPOINT:{ENDPOINT}, ID:{ID}",
+                     "ENDPOINT", objectPath, "ID", id);
+    }
+}
+
+void Manager::unindexCertificate(uint64_t id)
+{
+    if (const auto* subject = subjectIndex.get(id); subject != nullptr)
+    {
+        markIssuedBy(*subject);
+    }
+    staleAssociations.erase(id);
+    fingerprintIndex.erase(id);
+    subjectIndex.erase(id);
+    issuerIndex.erase(id);
+    serialNumberIndex.erase(id);
+    issuerGraph.erase(id);
+    expiryIndex.erase(id);
+    revokedCertIds.erase(id);
+}
+
+void Manager::armExpiryTimer()
+{
+    auto next = expiryIndex.nextCrossing();
+    if (!next)
+    {
+        if (expiryTimer)
+        {
+            expiryTimer->set_enabled(sdeventplus::source::Enabled::Off);
+        }
+        return;
+    }
+    ExpiryTimer::TimePoint time{std::chrono::seconds(*next)};
+    if (expiryTimer)
+    {
+        expiryTimer->set_time(time);
+    }
+    else
+    {
+        expiryTimer = std::make_unique<ExpiryTimer>(
+            event, time, expiryTimerAccuracy,
+            [this](ExpiryTimer&, ExpiryTimer::TimePoint) { checkExpiry(); });
+    }
+    expiryTimer->set_enabled(sdeventplus::source::Enabled::OneShot);
+}
+
+void Manager::markIssuedBy(const std::string& subject)
+{
+    for (auto certificateId : issuerIndex.find(subject))
+    {
+        staleAssociations.emplace(certificateId);
+    }
+}
+
+void Manager::updateAssociations()
+{
+    if (!certificateTypePolicy(certType).hasAssociations)
+    {
+        staleAssociations.clear();
+        return;
+    }
+    for (auto stale = staleAssociations.begin();
+         stale != staleAssociations.end();)
+    {
+        // Certificates not installed yet, e.g. staged or being restored,
+        // stay out of date until they are; unindexCertificate() drops them
+        auto certificateId = *stale;
+        auto it = installedCerts.find(certificateId);
+        if (it == installedCerts.end())
+        {
+            ++stale;
+            continue;
+        }
+        stale = staleAssociations.erase(stale);
+        const auto& cert = it->second;
+        auto issuerPath = getIssuerPath(certificateId);
+        // The CRL issuer is the certificate issuer; should its object not
+        // be resolved, the collection stands for it
+        std::optional<std::string> revokerPath;
+        if (isRevoked(certificateId))
+        {
+            revokerPath = issuerPath.value_or(objectPath);
+        }
+        cert->setAssociations(issuerPath, revokerPath);
+    }
+}
+
+void Manager::checkExpiry()
+{
+    auto now = std::chrono::duration_cast<std::chrono::seconds>(
+                   std::chrono::system_clock::now().time_since_epoch())
+                   .count();
+    auto crossings = expiryIndex.due(static_cast<uint64_t>(now));
+    for (const auto& crossing : crossings)
+    {
+        std::string certObjectPath =
+            installedCerts.at(crossing.id)->getObjectPath();
+        uint64_t days = crossing.window / (24 * 60 * 60);
+        if (crossing.window == 0)
+        {
+            lg2::error("Certificate expired, OBJECT_PATH:{OBJECT_PATH}, "
+                       "NOT_AFTER:{NOT_AFTER}",
+                       "OBJECT_PATH", certObjectPath, "NOT_AFTER",
+                       crossing.notAfter);
+        }
+        else
+        {
+            lg2::warning("Certificate expires within {DAYS} days, "
+                         "OBJECT_PATH:{OBJECT_PATH}, NOT_AFTER:{NOT_AFTER}",
+                         "DAYS", days, "OBJECT_PATH", certObjectPath,
+                         "NOT_AFTER", crossing.notAfter);
+        }
+        // A D-Bus signal rather than a Redfish event: the events sent are of
+        // the resource created and deleted types only
+        sendExpirySignal(certObjectPath, crossing.notAfter, days);
+    }
+    if (!crossings.empty())
+    {
+        saveExpiryState();
+    }
+    armExpiryTimer();
+}
+
+fs::path Manager::getExpiryStatePath() const
+{
+    fs::path statePath(certInstallPath);
+    statePath += ".expiry";
+    return statePath;
+}
+
+void Manager::restoreExpiryState()
+{
+    std::ifstream file(getExpiryStatePath());
+    std::string fingerprint;
+    uint64_t notAfter = 0;
+    uint64_t window = 0;
+    while (file >> fingerprint >> notAfter >> window)
+    {
+        for (auto certificateId : fingerprintIndex.find(fingerprint))
+        {
+            auto it = installedCerts.find(certificateId);
+            if (it != installedCerts.end() &&
+                it->second->validNotAfter() == notAfter)
+            {
+                expiryIndex.markCrossed(certificateId, window);
+            }
+        }
+    }
+}
+
+void Manager::saveExpiryState() const
+{
+    std::string state;
+    for (const auto& crossing : expiryIndex.crossed())
+    {
+        const auto* fingerprint = fingerprintIndex.get(crossing.id);
+        if (fingerprint != nullptr)
         {
-            commit<InternalFailure>();
+            state += *fingerprint + ' ' + std::to_string(crossing.notAfter) +
+                     ' ' + std::to_string(crossing.window) + '\n';
         }
     }
-    auto csrObjectPath = objectPath + '/' + "csr";
-    return csrObjectPath;
+    try
+    {
+        writeFileAtomically(getExpiryStatePath(), state);
+    }
+    catch (const std::system_error& e)
+    {
+        lg2::error("Failed to write file, FILE:{FILE}, ERR:{ERR}", "FILE",
+                   getExpiryStatePath(), "ERR", e);
+    }
 }
 
-std::vector<std::unique_ptr<Certificate>>& Manager::getCertificates()
+EndpointMemoryUsage Manager::memoryUsage() const
 {
-    return installedCerts;
+    EndpointMemoryUsage usage;
+    for (const auto& [certificateId, certificate] : installedCerts)
+    {
+        usage.certificates.objects++;
+        usage.certificates.bytes += certificate->memoryUsage();
+    }
+    usage.certificates.indexBytes =
+        fingerprintIndex.memoryUsage() + subjectIndex.memoryUsage() +
+        issuerIndex.memoryUsage() + serialNumberIndex.memoryUsage() +
+        issuerGraph.memoryUsage() + revocations.memoryUsage() +
+        expiryIndex.memoryUsage() + treeSize(revokedCertIds) +
+        treeSize(crlFiles) + installedCerts.memoryUsage();
+    for (const auto& [issuer, crlFile] : crlFiles)
+    {
+        usage.certificates.indexBytes += heapSize(issuer) +
+                                         heapSize(crlFile.native());
+    }
+    if (sigManager)
+    {
+        usage.signatures = sigManager->memoryUsage();
+    }
+    usage.totalBytes = sizeof(*this) + usage.certificates.bytes +
+                       usage.certificates.indexBytes + usage.signatures.bytes +
+                       usage.signatures.indexBytes + heapSize(pemRendering) +
+                       heapSize(pemRenderingPath);
+
+    std::ifstream statm("/proc/self/statm");
+    size_t totalPages = 0;
+    size_t residentPages = 0;
+    if (statm >> totalPages >> residentPages)
+    {
+        usage.residentBytes = residentPages * sysconf(_SC_PAGESIZE);
+    }
+    return usage;
+}
+
+void Manager::logMemoryUsage() const
+{
+    const auto usage = memoryUsage();
+    lg2::info(
+        "Memory usage, ENDPOINT:{ENDPOINT}, CERTIFICATES:{CERTIFICATES}, "
+        "CERTIFICATE_BYTES:{CERTIFICATE_BYTES}, "
+        "CERTIFICATE_INDEX_BYTES:{CERTIFICATE_INDEX_BYTES}, "
+        "SIGNATURES:{SIGNATURES}, SIGNATURE_BYTES:{SIGNATURE_BYTES}, "
+        "SIGNATURE_INDEX_BYTES:{SIGNATURE_INDEX_BYTES}, "
+        "TOTAL_BYTES:{TOTAL_BYTES}, RSS_BYTES:{RSS_BYTES}",
+        "ENDPOINT", objectPath, "CERTIFICATES", usage.certificates.objects,
+        "CERTIFICATE_BYTES", usage.certificates.bytes,
+        "CERTIFICATE_INDEX_BYTES", usage.certificates.indexBytes, "SIGNATURES",
+        usage.signatures.objects, "SIGNATURE_BYTES", usage.signatures.bytes,
+        "SIGNATURE_INDEX_BYTES", usage.signatures.indexBytes, "TOTAL_BYTES",
+        usage.totalBytes, "RSS_BYTES", usage.residentBytes);
 }
 
 void Manager::generateCSRHelper(
@@ -667,10 +1802,12 @@ void Manager::generateCSRHelper(
         pKey = getRSAKeyPair(keyBitLength);
     else if ((keyPairAlgorithm == "EC") || (keyPairAlgorithm.empty()))
         pKey = generateECKeyPair(keyCurveId);
+    else if (keyPairAlgorithm == "Ed25519")
+        pKey = generateEd25519KeyPair();
     else
     {
         lg2::error("Given Key pair algorithm is not supported. Supporting "
-                   "RSA and EC only");
+                   "RSA, EC and Ed25519 only");
         elog<InvalidArgument>(
             Argument::ARGUMENT_NAME("KEYPAIRALGORITHM"),
             Argument::ARGUMENT_VALUE(keyPairAlgorithm.c_str()));
@@ -687,8 +1824,9 @@ void Manager::generateCSRHelper(
     // Write private key to file
     writePrivateKey(pKey, defaultPrivateKeyFileName);
 
-    // set sign key of x509 req
-    ret = X509_REQ_sign(x509Req.get(), pKey.get(), EVP_sha256());
+    // set sign key of x509 req; Ed25519 signs without a separate digest
+    ret = X509_REQ_sign(x509Req.get(), pKey.get(),
+                        getSigningDigest(*pKey));
     if (ret == 0)
     {
         lg2::error("Error occurred while signing key of x509");
@@ -711,201 +1849,6 @@ bool Manager::isExtendedKeyUsage(const std::string& usage)
         [&usage](const char* s) { return (strcmp(s, usage.c_str()) == 0); });
     return it != usageList.end();
 }
-EVPPkeyPtr Manager::generateRSAKeyPair(const int64_t keyBitLength)
-{
-    int64_t keyBitLen = keyBitLength;
-    // set keybit length to default value if not set
-    if (keyBitLen <= 0)
-    {
-        lg2::info("KeyBitLength is not given.Hence, using default KeyBitLength:"
-                  "{DEFAULTKEYBITLENGTH}",
-                  "DEFAULTKEYBITLENGTH", defaultKeyBitLength);
-        keyBitLen = defaultKeyBitLength;
-    }
-
-#if (OPENSSL_VERSION_NUMBER < 0x30000000L)
-
-    // generate rsa key
-    BignumPtr bne(BN_new(), ::BN_free);
-    auto ret = BN_set_word(bne.get(), RSA_F4);
-    if (ret == 0)
-    {
-        lg2::error("Error occurred during BN_set_word call");
-        ERR_print_errors_fp(stderr);
-        elog<InternalFailure>();
-    }
-    using RSAPtr = std::unique_ptr<RSA, decltype(&::RSA_free)>;
-    RSAPtr rsa(RSA_new(), ::RSA_free);
-    ret = RSA_generate_key_ex(rsa.get(), keyBitLen, bne.get(), nullptr);
-    if (ret != 1)
-    {
-        lg2::error(
-            "Error occurred during RSA_generate_key_ex call: {KEYBITLENGTH}",
-            "KEYBITLENGTH", keyBitLen);
-        ERR_print_errors_fp(stderr);
-        elog<InternalFailure>();
-    }
-
-    // set public key of x509 req
-    EVPPkeyPtr pKey(EVP_PKEY_new(), ::EVP_PKEY_free);
-    ret = EVP_PKEY_assign_RSA(pKey.get(), rsa.get());
-    if (ret == 0)
-    {
-        lg2::error("Error occurred during assign rsa key into EVP");
-        ERR_print_errors_fp(stderr);
-        elog<InternalFailure>();
-    }
-    // Now |rsa| is managed by |pKey|
-    rsa.release();
-    return pKey;
-
-#else
-    auto ctx = std::unique_ptr<EVP_PKEY_CTX, decltype(&::EVP_PKEY_CTX_free)>(
-        EVP_PKEY_CTX_new_id(EVP_PKEY_RSA, nullptr), &::EVP_PKEY_CTX_free);
-    if (!ctx)
-    {
-        lg2::error("Error occurred creating EVP_PKEY_CTX from algorithm");
-        ERR_print_errors_fp(stderr);
-        elog<InternalFailure>();
-    }
-
-    if ((EVP_PKEY_keygen_init(ctx.get()) <= 0) ||
-        (EVP_PKEY_CTX_set_rsa_keygen_bits(ctx.get(), keyBitLen) <= 0))
-
-    {
-        lg2::error("Error occurred initializing keygen context");
-        ERR_print_errors_fp(stderr);
-        elog<InternalFailure>();
-    }
-
-    EVP_PKEY* pKey = nullptr;
-    if (EVP_PKEY_keygen(ctx.get(), &pKey) <= 0)
-    {
-        lg2::error("Error occurred during generate EC key");
-        ERR_print_errors_fp(stderr);
-        elog<InternalFailure>();
-    }
-
-    return {pKey, &::EVP_PKEY_free};
-#endif
-}
-
-EVPPkeyPtr Manager::generateECKeyPair(const std::string& curveId)
-{
-    std::string curId(curveId);
-
-    if (curId.empty())
-    {
-        lg2::info("KeyCurveId is not given. Hence using default curve id,"
-                  "DEFAULTKEYCURVEID:{DEFAULTKEYCURVEID}",
-                  "DEFAULTKEYCURVEID", defaultKeyCurveID);
-        curId = defaultKeyCurveID;
-    }
-
-    int ecGrp = OBJ_txt2nid(curId.c_str());
-    if (ecGrp == NID_undef)
-    {
-        lg2::error(
-            "Error occurred during convert the curve id string format into NID,"
-            "KEYCURVEID:{KEYCURVEID}",
-            "KEYCURVEID", curId);
-        elog<InternalFailure>();
-    }
-
-#if (OPENSSL_VERSION_NUMBER < 0x30000000L)
-
-    EC_KEY* ecKey = EC_KEY_new_by_curve_name(ecGrp);
-
-    if (ecKey == nullptr)
-    {
-        lg2::error(
-            "Error occurred during create the EC_Key object from NID, ECGROUP:{ECGROUP}",
-            "ECGROUP", ecGrp);
-        ERR_print_errors_fp(stderr);
-        elog<InternalFailure>();
-    }
-
-    // If you want to save a key and later load it with
-    // SSL_CTX_use_PrivateKey_file, then you must set the OPENSSL_EC_NAMED_CURVE
-    // flag on the key.
-    EC_KEY_set_asn1_flag(ecKey, OPENSSL_EC_NAMED_CURVE);
-
-    int ret = EC_KEY_generate_key(ecKey);
-
-    if (ret == 0)
-    {
-        EC_KEY_free(ecKey);
-        lg2::error("Error occurred during generate EC key");
-        ERR_print_errors_fp(stderr);
-        elog<InternalFailure>();
-    }
-
-    EVPPkeyPtr pKey(EVP_PKEY_new(), ::EVP_PKEY_free);
-    ret = EVP_PKEY_assign_EC_KEY(pKey.get(), ecKey);
-    if (ret == 0)
-    {
-        EC_KEY_free(ecKey);
-        lg2::error("Error occurred during assign EC Key into EVP");
-        ERR_print_errors_fp(stderr);
-        elog<InternalFailure>();
-    }
-
-    return pKey;
-
-#else
-    auto holderOfKey = [](EVP_PKEY* key) {
-        return std::unique_ptr<EVP_PKEY, decltype(&::EVP_PKEY_free)>{
-            key, &::EVP_PKEY_free};
-    };
-
-    // Create context to set up curve parameters.
-    auto ctx = std::unique_ptr<EVP_PKEY_CTX, decltype(&::EVP_PKEY_CTX_free)>(
-        EVP_PKEY_CTX_new_id(EVP_PKEY_EC, nullptr), &::EVP_PKEY_CTX_free);
-    if (!ctx)
-    {
-        lg2::error("Error occurred creating EVP_PKEY_CTX for params");
-        ERR_print_errors_fp(stderr);
-        elog<InternalFailure>();
-    }
-
-    // Set up curve parameters.
-    EVP_PKEY* params = nullptr;
-
-    if ((EVP_PKEY_paramgen_init(ctx.get()) <= 0) ||
-        (EVP_PKEY_CTX_set_ec_param_enc(ctx.get(), OPENSSL_EC_NAMED_CURVE) <=
-         0) ||
-        (EVP_PKEY_CTX_set_ec_paramgen_curve_nid(ctx.get(), ecGrp) <= 0) ||
-        (EVP_PKEY_paramgen(ctx.get(), &params) <= 0))
-    {
-        lg2::error("Error occurred setting curve parameters");
-        ERR_print_errors_fp(stderr);
-        elog<InternalFailure>();
-    }
-
-    // Move parameters to RAII holder.
-    auto pparms = holderOfKey(params);
-
-    // Create new context for key.
-    ctx.reset(EVP_PKEY_CTX_new_from_pkey(nullptr, params, nullptr));
-
-    if (!ctx || (EVP_PKEY_keygen_init(ctx.get()) <= 0))
-    {
-        lg2::error("Error occurred initializing keygen context");
-        ERR_print_errors_fp(stderr);
-        elog<InternalFailure>();
-    }
-
-    EVP_PKEY* pKey = nullptr;
-    if (EVP_PKEY_keygen(ctx.get(), &pKey) <= 0)
-    {
-        lg2::error("Error occurred during generate EC key");
-        ERR_print_errors_fp(stderr);
-        elog<InternalFailure>();
-    }
-
-    return holderOfKey(pKey);
-#endif
-}
 
 void Manager::writePrivateKey(const EVPPkeyPtr& pKey,
                               const std::string& privKeyFileName)
@@ -997,8 +1940,6 @@ void Manager::writeCSR(const std::string& filePath, const X509ReqPtr& x509Req)
 
 void Manager::createCertificates()
 {
-    auto certObjectPath = objectPath + '/';
-
     if ((certType == CertificateType::authority) ||
         (certType == CertificateType::authorityBios))
     {
@@ -1027,20 +1968,42 @@ void Manager::createCertificates()
             return;
         }
 
+        // Assume here any regular file located in certificate directory
+        // contains certificates body. Do not want to use soft links
+        // would add value.
+        std::vector<std::string> certFiles;
         for (auto& path : fs::directory_iterator(certInstallPath))
+        {
+            // A ".tmp" file is an interrupted writeFileAtomically()
+            if (fs::is_regular_file(path) && path.path().extension() != ".tmp")
+            {
+                certFiles.emplace_back(path.path());
+            }
+        }
+        std::sort(certFiles.begin(), certFiles.end());
+
+        // Load and validate concurrently, publish in order
+        auto loaded = parallelMap(certFiles, maxRestoreWorkers,
+                                  &Certificate::validateFile);
+        std::vector<uint64_t> restoredIds;
+        for (size_t i = 0; i < certFiles.size(); ++i)
         {
             try
             {
-                // Assume here any regular file located in certificate directory
-                // contains certificates body. Do not want to use soft links
-                // would add value.
-                if (fs::is_regular_file(path))
+                if (loaded[i].error)
                 {
-                    installedCerts.emplace_back(std::make_unique<Certificate>(
-                        bus, certObjectPath + std::to_string(certIdCounter++),
-                        certType, certInstallPath, path.path(),
-                        certWatchPtr.get(), *this, /*restore=*/true));
+                    std::rethrow_exception(loaded[i].error);
                 }
+                trace::Span span("publish");
+                span.arg("file", certFiles[i]);
+                auto certificateId = certIds.allocate();
+                installedCerts.emplace(
+                    certificateId,
+                    std::make_unique<Certificate>(
+                        bus, getCertificateObjectPath(certificateId),
+                        certificateId, certType, certInstallPath, certFiles[i],
+                        **loaded[i].value, certWatchPtr.get(), *this));
+                restoredIds.emplace_back(certificateId);
             }
             catch (const InternalFailure& e)
             {
@@ -1052,6 +2015,7 @@ void Manager::createCertificates()
                     "Existing certificate file is corrupted"));
             }
         }
+        announceCertificates(restoredIds);
     }
     else if (certType == CertificateType::securebootDatabase)
     {
@@ -1064,62 +2028,79 @@ void Manager::createCertificates()
             return;
         }
 
+        // Assume here any regular file without extension located in
+        // certificate directory contains certificates body, and is named
+        // after its ID. Do not want to use soft links would add value.
+        std::map<uint64_t, std::string> certFilesById;
         for (auto& path : fs::directory_iterator(certInstallPath))
         {
             try
             {
-                // Assume here any regular file located in certificate directory
-                // contains certificates body. Do not want to use soft links
-                // would add value.
-                if (fs::is_regular_file(path))
+                if (fs::is_regular_file(path) &&
+                    path.path().extension().empty())
                 {
-                    if (!path.path().extension().empty())
-                    {
-                        continue;
-                    }
-                    auto certificateId = std::stoull(path.path().filename());
-                    allocId(certificateId);
-                    certObjectPath = objectPath + "/certs/" +
-                                     std::to_string(certificateId);
-                    try
-                    {
-                        installedCerts.emplace_back(
-                            std::make_unique<Certificate>(
-                                bus, certObjectPath, certType, certInstallPath,
-                                path.path(), certWatchPtr.get(), *this,
-                                /*restore=*/false));
-                    }
-                    catch (const std::exception& ex)
-                    {
-                        lg2::error(
-                            "Error in certificate constructor,ERROR_STR:{ERROR_STR}",
-                            "ERROR_STR", ex);
-                        releaseId(certificateId);
-                    }
+                    auto certificateId =
+                        allocId(std::stoull(path.path().filename()));
+                    certFilesById.emplace(certificateId, path.path());
                 }
             }
-            catch (const InternalFailure& e)
+            catch (const std::logic_error& e)
             {
+                // Not a decimal ID, or one out of the ID range
                 report<InternalFailure>();
             }
-            catch (const InvalidCertificate& e)
+        }
+        std::vector<uint64_t> certIdList;
+        std::vector<std::string> certFiles;
+        for (const auto& [certificateId, path] : certFilesById)
+        {
+            certIdList.emplace_back(certificateId);
+            certFiles.emplace_back(path);
+        }
+
+        // Load and validate concurrently, publish in order
+        auto loaded = parallelMap(certFiles, maxRestoreWorkers,
+                                  &Certificate::validateFile);
+        std::vector<uint64_t> restoredIds;
+        for (size_t i = 0; i < certFiles.size(); ++i)
+        {
+            auto certificateId = certIdList[i];
+            auto certObjectPath = getCertificateObjectPath(certificateId);
+            try
             {
-                report<InvalidCertificate>(InvalidCertificateReason(
-                    "Existing certificate file is corrupted"));
+                if (loaded[i].error)
+                {
+                    std::rethrow_exception(loaded[i].error);
+                }
+                trace::Span span("publish");
+                span.arg("file", certFiles[i]);
+                installedCerts.emplace(
+                    certificateId,
+                    std::make_unique<Certificate>(
+                        bus, certObjectPath, certificateId, certType,
+                        certInstallPath, certFiles[i], **loaded[i].value,
+                        certWatchPtr.get(), *this));
+                restoredIds.emplace_back(certificateId);
             }
-            catch (const std::invalid_argument& e)
+            catch (const std::exception& ex)
             {
-                report<InternalFailure>();
+                lg2::error(
+                    "Error in certificate constructor,ERROR_STR:{ERROR_STR}",
+                    "ERROR_STR", ex);
+                releaseId(certificateId);
             }
         }
+        announceCertificates(restoredIds);
     }
     else if (fs::exists(certInstallPath))
     {
         try
         {
-            installedCerts.emplace_back(std::make_unique<Certificate>(
-                bus, certObjectPath + '1', certType, certInstallPath,
-                certInstallPath, certWatchPtr.get(), *this, /*restore=*/false));
+            installedCerts.emplace(
+                1, std::make_unique<Certificate>(
+                       bus, getCertificateObjectPath(1), 1, certType,
+                       certInstallPath, certInstallPath, certWatchPtr.get(),
+                       *this, /*restore=*/false));
         }
         catch (const InternalFailure& e)
         {
@@ -1138,17 +2119,81 @@ void Manager::createRSAPrivateKeyFile()
     fs::path rsaPrivateKeyFileName = certParentInstallPath /
                                      defaultRSAPrivateKeyFileName;
 
-    try
+    if (fs::exists(rsaPrivateKeyFileName))
+    {
+        return;
+    }
+
+    // Generating the key takes seconds on BMC cores. Do it in a low priority
+    // child process, so that the service takes its bus name right away.
+    // Only that process holds the write end of the pipe, which closes when
+    // it exits.
+    int fds[2];
+    if (pipe2(fds, O_CLOEXEC) != 0)
     {
-        if (!fs::exists(rsaPrivateKeyFileName))
+        lg2::error("Error occurred during pipe creation, ERRNO:{ERRNO}",
+                   "ERRNO", errno);
+        report<InternalFailure>();
+        return;
+    }
+    auto pid = fork();
+    if (pid == -1)
+    {
+        lg2::error("Error occurred during forking process");
+        close(fds[0]);
+        close(fds[1]);
+        report<InternalFailure>();
+        return;
+    }
+    else if (pid == 0)
+    {
+        close(fds[0]);
+        std::string tmpFileName = std::string(defaultRSAPrivateKeyFileName) +
+                                  ".tmp";
+        try
         {
+            setpriority(PRIO_PROCESS, 0, keyGenNiceness);
             writePrivateKey(generateRSAKeyPair(supportedKeyBitLength),
-                            defaultRSAPrivateKeyFileName);
+                            tmpFileName);
+            // Readers never see a partially written key
+            fs::rename(certParentInstallPath / tmpFileName,
+                       rsaPrivateKeyFileName);
+            exit(EXIT_SUCCESS);
+        }
+        catch (const std::exception& e)
+        {
+            lg2::error("Failed to generate RSA private key, ERR:{ERR}", "ERR",
+                       e);
+            std::error_code ec;
+            fs::remove(certParentInstallPath / tmpFileName, ec);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    close(fds[1]);
+    keyGenFd = fds[0];
+    using namespace sdeventplus::source;
+    Child::Callback callback = [this](Child&, const siginfo_t* si) {
+        close(keyGenFd);
+        keyGenFd = -1;
+        if (si->si_status != 0)
+        {
+            report<InternalFailure>();
+        }
+        else
+        {
+            lg2::info("RSA private key generated");
         }
+    };
+    try
+    {
+        blockChildSignal();
+        keyGenChildPtr = std::make_unique<Child>(event, pid, WEXITED,
+                                                 std::move(callback));
     }
     catch (const InternalFailure& e)
     {
-        report<InternalFailure>();
+        commit<InternalFailure>();
     }
 }
 
@@ -1168,32 +2213,97 @@ EVPPkeyPtr Manager::getRSAKeyPair(const int64_t keyBitLength)
     fs::path rsaPrivateKeyFileName = certParentInstallPath /
                                      defaultRSAPrivateKeyFileName;
 
-    FILE* privateKeyFile = std::fopen(rsaPrivateKeyFileName.c_str(), "r");
-    if (!privateKeyFile)
+    // The key may still be in the making, see createRSAPrivateKeyFile().
+    // The pipe hangs up as soon as that process exits, whether it wrote the
+    // key or not.
+    if (keyGenFd >= 0)
+    {
+        pollfd keyGen{keyGenFd, POLLIN, 0};
+        int ret = 0;
+        do
+        {
+            ret = poll(&keyGen, 1, static_cast<int>(keyGenTimeout.count()));
+        } while (ret < 0 && errno == EINTR);
+    }
+
+    // Use the key decrypted by refreshRSAKeyCache() if the file didn't
+    // change since
+    if (rsaKeyCache && rsaKeyStamp &&
+        rsaKeyStamp == getFileStamp(rsaPrivateKeyFileName))
+    {
+        EVP_PKEY_up_ref(rsaKeyCache.get());
+        return EVPPkeyPtr(rsaKeyCache.get(), ::EVP_PKEY_free);
+    }
+    return readRSAKeyFile();
+}
+
+EVPPkeyPtr Manager::readRSAKeyFile()
+{
+    fs::path rsaPrivateKeyFileName = certParentInstallPath /
+                                     defaultRSAPrivateKeyFileName;
+
+    std::optional<FileContent> privateKeyFile;
+    try
+    {
+        privateKeyFile.emplace(rsaPrivateKeyFileName);
+    }
+    catch (const std::system_error& e)
     {
         lg2::error(
             "Unable to open RSA private key file to read, RSAKEYFILE:{RSAKEYFILE},"
             "ERRORREASON:{ERRORREASON}",
-            "RSAKEYFILE", rsaPrivateKeyFileName, "ERRORREASON",
-            strerror(errno));
+            "RSAKEYFILE", rsaPrivateKeyFileName, "ERRORREASON", e);
         elog<InternalFailure>();
     }
 
-    EVPPkeyPtr privateKey(PEM_read_PrivateKey(privateKeyFile, nullptr,
-                                              lsp::passwordCallback, nullptr),
+    auto keyBio = privateKeyFile->bio();
+    if (!keyBio)
+    {
+        lg2::error("Error occurred during BIO_new_mem_buf call");
+        elog<InternalFailure>();
+    }
+    EVPPkeyPtr privateKey(PEM_read_bio_PrivateKey(keyBio.get(), nullptr,
+                                                  lsp::passwordCallback,
+                                                  nullptr),
                           ::EVP_PKEY_free);
-    std::fclose(privateKeyFile);
 
     if (!privateKey)
     {
-        lg2::error("Error occurred during PEM_read_PrivateKey call");
+        lg2::error("Error occurred during PEM_read_bio_PrivateKey call");
         elog<InternalFailure>();
     }
     return privateKey;
 }
 
+void Manager::refreshRSAKeyCache()
+{
+    auto stamp = getFileStamp(certParentInstallPath /
+                              defaultRSAPrivateKeyFileName);
+    if (!stamp)
+    {
+        rsaKeyCache.reset();
+        rsaKeyStamp.reset();
+        return;
+    }
+    if (rsaKeyCache && rsaKeyStamp == stamp)
+    {
+        return;
+    }
+
+    // Freeing the key clears its private components
+    rsaKeyCache.reset();
+    rsaKeyStamp.reset();
+    rsaKeyCache = readRSAKeyFile();
+    rsaKeyStamp = stamp;
+    lg2::info("RSA private key loaded into the key cache");
+}
+
 void Manager::storageUpdate()
 {
+    CERTS_PROBE(storage_update_entry, objectPath.c_str(),
+                installedCerts.size());
+    CERTS_PROBE_RETURN(storage_update_return, objectPath.c_str());
+
     if ((certType == CertificateType::authority) ||
         (certType == CertificateType::authorityBios))
     {
@@ -1215,16 +2325,59 @@ void Manager::storageUpdate()
                 elog<InternalFailure>();
             }
         }
+        // and the PEM renderings they pointed to
+        if (!pemViewPath.empty() && fs::is_directory(pemViewPath))
+        {
+            for (auto& viewPath : fs::directory_iterator(pemViewPath))
+            {
+                fs::remove(viewPath);
+            }
+        }
     }
 
-    for (const auto& cert : installedCerts)
+    for (const auto& [certificateId, cert] : installedCerts)
     {
         cert->storageUpdate();
     }
+
+    // Drop the blobs of the certificates removed or replaced
+    if (blobStore)
+    {
+        blobStore->collectGarbage();
+    }
+}
+
+void Manager::sendCertificateEvent(phosphor::logging::MESSAGE_TYPE type,
+                                   phosphor::logging::Entry::Level level,
+                                   const std::vector<std::string>& args,
+                                   const std::string& path)
+{
+    phosphor::logging::sendEvent(type, level, args, path);
+}
+
+void Manager::sendExpirySignal(const std::string& path, uint64_t notAfter,
+                               uint64_t windowDays)
+{
+    try
+    {
+        auto signal = queryIntf->new_signal("ExpiryWindowCrossed");
+        signal.append(sdbusplus::message::object_path(path), notAfter,
+                      windowDays);
+        signal.signal_send();
+    }
+    catch (const sdbusplus::exception_t& e)
+    {
+        lg2::error("Failed to emit the expiry signal, "
+                   "OBJECT_PATH:{OBJECT_PATH}, ERR:{ERR}",
+                   "OBJECT_PATH", path, "ERR", e);
+    }
 }
 
 void Manager::reloadOrReset(const std::string& unit)
 {
+    CERTS_PROBE(reload_entry, objectPath.c_str(), unit.c_str());
+    CERTS_PROBE_RETURN(reload_return, objectPath.c_str(), unit.c_str());
+
     if (!unit.empty())
     {
         try
@@ -1239,6 +2392,7 @@ void Manager::reloadOrReset(const std::string& unit)
                 defaultSystemdInterface, "ReloadOrRestartUnit");
             method.append(unit, "replace");
             bus.call_noreply(method);
+            metrics::count(metrics::Counter::reloads);
         }
         catch (const sdbusplus::exception_t& e)
         {
@@ -1253,17 +2407,40 @@ void Manager::reloadOrReset(const std::string& unit)
 bool Manager::isCertificateUnique(const std::string& filePath,
                                   const Certificate* const certToDrop)
 {
-    if (std::any_of(
-            installedCerts.begin(), installedCerts.end(),
-            [&filePath, certToDrop](const std::unique_ptr<Certificate>& cert) {
-        return cert.get() != certToDrop && cert->isSame(filePath);
-    }))
+    if (installedCerts.empty())
     {
-        return false;
+        return true;
     }
-    else
+    // Same subject, issuer and serial number, as generateCertId() hashes
+    auto cert = loadCert(filePath);
+    std::string subject = formatName(*X509_get_subject_name(cert.get()));
+    std::string issuer = formatName(*X509_get_issuer_name(cert.get()));
+    auto ids = serialNumberIndex.find(
+        serialNumberKey(issuer, formatSerialNumber(*cert)));
+    return std::none_of(ids.begin(), ids.end(), [&](uint64_t certificateId) {
+        auto it = installedCerts.find(certificateId);
+        if (it == installedCerts.end() || it->second.get() == certToDrop)
+        {
+            return false;
+        }
+        const auto* certSubject = subjectIndex.get(certificateId);
+        return certSubject != nullptr && *certSubject == subject;
+    });
+}
+
+void Manager::announceCertificates(const std::vector<uint64_t>& ids)
+{
+    // The initial restore runs before the service owns its bus name, and
+    // clients enumerate the objects with GetManagedObjects once it does, so
+    // one signal per object would only wake every ObjectManager consumer up
+    // for nothing.
+    if (restoring)
     {
-        return true;
+        return;
+    }
+    for (auto id : ids)
+    {
+        installedCerts.at(id)->emit_object_added();
     }
 }
 
@@ -1272,31 +2449,16 @@ uint64_t Manager::allocId(uint64_t id)
     // Have designated ID
     if (id != 0)
     {
-        // Update the Unused IDs
-        for (; certIdCounter <= id; certIdCounter++)
-        {
-            certIdUnused.insert(certIdCounter);
-        }
-        certIdUnused.erase(id);
-        return id;
+        return certIds.reserve(id);
     }
 
     // No designated ID
-    if (!certIdUnused.empty())
-    {
-        id = *certIdUnused.begin();
-        certIdUnused.erase(id);
-        return id;
-    }
-    else
-    {
-        return certIdCounter++;
-    }
+    return certIds.allocate();
 }
 
 void Manager::releaseId(uint64_t id)
 {
-    certIdUnused.insert(id);
+    certIds.release(id);
 }
 
 } // namespace phosphor::certs
@@ -1,17 +1,31 @@
 #pragma once
 
+#include "blob_store.hpp"
 #include "certificate.hpp"
 #include "csr.hpp"
+#include "expiry_index.hpp"
+#include "file_content.hpp"
+#include "id_allocator.hpp"
+#include "issuer_graph.hpp"
+#include "key_index.hpp"
+#include "memory_usage.hpp"
+#include "object_map.hpp"
+#include "revocation_index.hpp"
 #include "signature_manager.hpp"
 #include "watch.hpp"
+#include "x509_utils.hpp"
 
 #include <openssl/evp.h>
 #include <openssl/ossl_typ.h>
 #include <openssl/x509.h>
 
+#include <phosphor-logging/redfish_event_log.hpp>
+#include <sdbusplus/server/interface.hpp>
 #include <sdbusplus/server/object.hpp>
+#include <sdeventplus/clock.hpp>
 #include <sdeventplus/source/child.hpp>
 #include <sdeventplus/source/event.hpp>
+#include <sdeventplus/source/time.hpp>
 #include <xyz/openbmc_project/Certs/CSR/Create/server.hpp>
 #include <xyz/openbmc_project/Certs/Install/server.hpp>
 #include <xyz/openbmc_project/Certs/InstallAll/server.hpp>
@@ -20,7 +34,10 @@
 
 #include <cstdint>
 #include <filesystem>
+#include <map>
 #include <memory>
+#include <optional>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -37,6 +54,9 @@ using ManagerInterface = sdbusplus::server::object_t<
     sdbusplus::xyz::openbmc_project::Certs::server::ReplaceAll>;
 }
 
+/** @brief Certificates keyed by their object ID, in ascending ID order */
+using CertificateMap = ObjectMap<Certificate>;
+
 class Manager : public internal::ManagerInterface
 {
   public:
@@ -55,7 +75,7 @@ class Manager : public internal::ManagerInterface
     Manager& operator=(const Manager&) = delete;
     Manager(Manager&&) = delete;
     Manager& operator=(Manager&&) = delete;
-    virtual ~Manager() = default;
+    virtual ~Manager();
 
     /** @brief Constructor to put object onto bus at a dbus path.
      *  @param[in] bus - Bus to attach to.
@@ -64,10 +84,13 @@ class Manager : public internal::ManagerInterface
      *  @param[in] type - Type of the certificate.
      *  @param[in] unit - Unit consumed by this certificate.
      *  @param[in] installPath - Certificate installation path.
+     *  @param[in] format - Encoding of the stored certificates; server and
+     *  client certificates are always stored as PEM.
      */
     Manager(sdbusplus::bus_t& bus, sdeventplus::Event& event, const char* path,
             CertificateType type, const std::string& unit,
-            const std::string& installPath);
+            const std::string& installPath,
+            StorageFormat format = StorageFormat::pem);
 
     /** @brief Implementation for Install
      *  Replace the existing certificate key file with another
@@ -92,6 +115,7 @@ class Manager : public internal::ManagerInterface
 
     /** @brief Implementation for ReplaceAll
      *  Replace the current authority lists and restart the associated services.
+     *  The store is swapped at once, see publishAuthorities().
      *
      *  @param[in] path - Path of file that contains multiple root certificates.
      *
@@ -200,7 +224,148 @@ class Manager : public internal::ManagerInterface
      *
      *  @return Reference to certificates' collection
      */
-    std::vector<std::unique_ptr<Certificate>>& getCertificates();
+    CertificateMap& getCertificates();
+
+    /** @brief Get the object path of the collection
+     *
+     *  @return Object path.
+     */
+    const std::string& getObjectPath() const;
+
+    /** @brief Get the object path of a certificate of the collection
+     *
+     *  @param[in] id - ID of the certificate.
+     *
+     *  @return Object path.
+     */
+    std::string getCertificateObjectPath(uint64_t id) const;
+
+    /** @brief Get the certificates expiring before a time, without going
+     *  through all of them; the GetExpiringBefore method of queryInterface
+     *
+     *  @param[in] time - Seconds since the Epoch, as ValidNotAfter.
+     *
+     *  @return Object paths of the certificates, soonest expiry first.
+     */
+    std::vector<std::string> getExpiringBefore(uint64_t time) const;
+
+    /** @brief Find the certificates with a SHA-256 fingerprint; this and
+     *  the following lookups are the Find* methods of queryInterface
+     *
+     *  @param[in] fingerprint - Lower case hex, see generateFingerprint().
+     *
+     *  @return Object paths of the certificates, by ascending ID.
+     */
+    std::vector<std::string>
+        findByFingerprint(const std::string& fingerprint) const;
+
+    /** @brief Find the certificates with a subject, as the Subject property
+     *  renders it
+     *
+     *  @return Object paths of the certificates, by ascending ID.
+     */
+    std::vector<std::string> findBySubject(const std::string& subject) const;
+
+    /** @brief Find the certificates with an issuer, as the Issuer property
+     *  renders it
+     *
+     *  @return Object paths of the certificates, by ascending ID.
+     */
+    std::vector<std::string> findByIssuer(const std::string& issuer) const;
+
+    /** @brief Find the certificates with a serial number from an issuer
+     *
+     *  @param[in] issuer - Issuer, as the Issuer property renders it.
+     *  @param[in] serialNumber - Upper case hex, see formatSerialNumber().
+     *
+     *  @return Object paths of the certificates, by ascending ID.
+     */
+    std::vector<std::string>
+        findBySerialNumber(const std::string& issuer,
+                           const std::string& serialNumber) const;
+
+    /** @brief Install certificate revocation lists
+     *  @details Only authority endpoints take CRLs, and only CRLs signed by
+     *  one of their certificates. A CRL replaces the previous CRL of its
+     *  issuer; it is stored next to the install path, see getCrlPath(), and
+     *  its serial numbers indexed, so that installs are checked against it
+     *  without parsing it again.
+     *
+     *  @param[in] filePath - Local path of PEM CRLs, or of concatenated DER
+     *  CRLs.
+     *
+     *  @return Object paths of the installed certificates the CRLs revoke.
+     */
+    std::vector<std::string> installCrl(const std::string& filePath);
+
+    /** @brief Check that a certificate about to be installed is not revoked
+     *  by the CRL of its issuer; restored certificates are only flagged
+     *
+     *  @param[in] cert - The certificate.
+     */
+    void validateRevocation(X509& cert) const;
+
+    /** @brief Add a certificate to the lookup indexes, or update it; called
+     *  as the certificate properties are populated
+     *
+     *  @param[in] id - Object ID of the certificate.
+     *  @param[in] cert - The certificate.
+     *  @param[in] properties - Its properties, as extracted from it.
+     */
+    void indexCertificate(uint64_t id, X509& cert,
+                          const CertificateProperties& properties);
+
+    /** @brief Remove a certificate from the lookup indexes; called as the
+     *  certificate is destroyed
+     *
+     *  @param[in] id - Object ID of the certificate.
+     */
+    void unindexCertificate(uint64_t id);
+
+    /** @brief Get the encoding of the stored certificates */
+    StorageFormat getStorageFormat() const
+    {
+        return storageFormat;
+    }
+
+    /** @brief Get the directory holding the PEM renderings that the
+     *  OpenSSL CApath links point to when authorities are stored as DER
+     */
+    const std::filesystem::path& getPemViewPath() const
+    {
+        return pemViewPath;
+    }
+
+    /** @brief Render a certificate file as PEM, for the CertificateString
+     *  property of its object
+     *  @details The last rendering is kept with the identity of its file, so
+     *  that the reads of an object parse its file once, without a PEM copy
+     *  per object.
+     *
+     *  @param[in] filePath - The certificate file.
+     *
+     *  @return The PEM text, empty if the file is missing or unreadable.
+     */
+    std::string renderPem(const std::string& filePath);
+
+    /** @brief Get the store certificate files are shared through
+     *
+     *  @return The store, nullptr if files are not shared.
+     */
+    const BlobStore* getBlobStore() const
+    {
+        return blobStore.get();
+    }
+
+    /** @brief Estimate the memory used by the objects of this endpoint,
+     *  per object type
+     *
+     *  @return The estimate, and the resident set size of the process.
+     */
+    EndpointMemoryUsage memoryUsage() const;
+
+    /** @brief Log memoryUsage() to the journal */
+    void logMemoryUsage() const;
 
     /** @brief Systemd unit reload or reset helper function
      *  Reload if the unit supports it and use a restart otherwise.
@@ -208,6 +373,26 @@ class Manager : public internal::ManagerInterface
      */
     virtual void reloadOrReset(const std::string& unit);
 
+    /** @brief Send a Redfish event about a certificate
+     *  @param[in] type - Type of the event.
+     *  @param[in] level - Severity of the event.
+     *  @param[in] args - Arguments of the event message.
+     *  @param[in] path - Object path of the certificate.
+     */
+    virtual void sendCertificateEvent(phosphor::logging::MESSAGE_TYPE type,
+                                      phosphor::logging::Entry::Level level,
+                                      const std::vector<std::string>& args,
+                                      const std::string& path);
+
+    /** @brief Emit the ExpiryWindowCrossed signal of the queryInterface
+     *  @param[in] path - Object path of the certificate.
+     *  @param[in] notAfter - Its ValidNotAfter time.
+     *  @param[in] windowDays - Days of the warning window it entered, 0 if
+     *  it expired.
+     */
+    virtual void sendExpirySignal(const std::string& path, uint64_t notAfter,
+                                  uint64_t windowDays);
+
   private:
     void generateCSRHelper(std::vector<std::string> alternativeNames,
                            std::string challengePassword, std::string city,
@@ -221,20 +406,6 @@ class Manager : public internal::ManagerInterface
                            std::string organizationalUnit, std::string state,
                            std::string surname, std::string unstructuredName);
 
-    /** @brief Generate RSA Key pair and get private key from key pair
-     *  @param[in]  keyBitLength - KeyBit length.
-     *  @return     Pointer to RSA private key
-     */
-    std::unique_ptr<EVP_PKEY, decltype(&::EVP_PKEY_free)>
-        generateRSAKeyPair(const int64_t keyBitLength);
-
-    /** @brief Generate EC Key pair and get private key from key pair
-     *  @param[in]  p_KeyCurveId - Curve ID
-     *  @return     Pointer to EC private key
-     */
-    std::unique_ptr<EVP_PKEY, decltype(&::EVP_PKEY_free)>
-        generateECKeyPair(const std::string& pKeyCurveId);
-
     /** @brief Write private key data to file
      *
      *  @param[in] pKey     - pointer to private key
@@ -277,8 +448,78 @@ class Manager : public internal::ManagerInterface
      */
     void createCertificates();
 
+    /** @brief Emit InterfacesAdded for the given certificates, unless the
+     * initial restore is in progress
+     *  @param[in] ids - IDs of the certificates to announce
+     */
+    void announceCertificates(const std::vector<uint64_t>& ids);
+
+    /** @brief Get the object paths of installed certificates
+     *  @param[in] ids - Object IDs; IDs of other certificates, e.g. staged
+     *  ones, are skipped.
+     */
+    std::vector<std::string>
+        getObjectPaths(const std::vector<uint64_t>& ids) const;
+
+    /** @brief Arm the expiry timer for the next crossing of the expiry
+     * index, which the certificates keep up to date, see indexCertificate()
+     */
+    void armExpiryTimer();
+
+    /** @brief Get the issuer of a certificate, see IssuerGraph
+     *
+     *  @param[in] id - Object ID of the certificate.
+     *
+     *  @return Object path of the issuer, std::nullopt for a root or if this
+     *  endpoint doesn't hold it.
+     */
+    std::optional<std::string> getIssuerPath(uint64_t id) const;
+
+    /** @brief Link the certificates of |staleAssociations| to their
+     * issuer, and to the issuer of the CRL revoking them if any, through the
+     * associations of the objects, as installs, removals and CRLs change
+     * them
+     */
+    void updateAssociations();
+
+    /** @brief Add the certificates issued by a subject to
+     * |staleAssociations|, as a certificate of that subject comes or goes
+     *
+     *  @param[in] subject - Subject, as the Subject property renders it.
+     */
+    void markIssuedBy(const std::string& subject);
+
+    /** @brief Tell if a certificate is revoked by the CRL of its issuer
+     *
+     *  @param[in] id - Object ID of the certificate.
+     */
+    bool isRevoked(uint64_t id) const;
+
+    /** @brief Log and send events about the certificates which entered a
+     * warning window or expired, see expiryWarningDays, and save the windows
+     * crossed
+     */
+    void checkExpiry();
+
+    /** @brief Get the file the windows crossed are saved to, next to the
+     * install path, so that a restart doesn't report them again
+     */
+    std::filesystem::path getExpiryStatePath() const;
+
+    /** @brief Mark the windows saved by a previous run as crossed, for the
+     * certificates still installed with the same validity
+     */
+    void restoreExpiryState();
+
+    /** @brief Save the last window crossed by each certificate, by
+     * fingerprint, as IDs change across restarts
+     */
+    void saveExpiryState() const;
+
     /** @brief Create RSA private key file
-     *  Create RSA private key file by generating rsa key if not created
+     *  Create RSA private key file by generating rsa key if not created. The
+     *  key is generated by a low priority child process; the call does not
+     *  wait for it.
      */
     void createRSAPrivateKeyFile();
 
@@ -290,11 +531,85 @@ class Manager : public internal::ManagerInterface
     std::unique_ptr<EVP_PKEY, decltype(&::EVP_PKEY_free)>
         getRSAKeyPair(const int64_t keyBitLength);
 
+    /** @brief Read and decrypt the RSA private key file
+     *  @return     Pointer to RSA key
+     */
+    std::unique_ptr<EVP_PKEY, decltype(&::EVP_PKEY_free)> readRSAKeyFile();
+
+    /** @brief Load the RSA private key into |rsaKeyCache|, unless it is
+     * already there and the key file didn't change since
+     */
+    void refreshRSAKeyCache();
+
     /** @brief Update certificate storage (remove outdated files, recreate
      * symbolic links, etc.).
      */
     void storageUpdate();
 
+    /** @brief Install a certificate; see install()
+     *  @param[in] filePath - Certificate file path.
+     *  @return Certificate object path.
+     */
+    std::string installCertificate(const std::string& filePath);
+
+    /** @brief Delete all the certificates; see deleteAll()
+     */
+    void deleteAllCertificates();
+
+    /** @brief Publish the authorities list as a new generation of the store
+     *  @details The new generation is built and validated in the staging
+     *  directory, then swapped with the current one in a single rename, so
+     *  that consumers never see a partial store. Certificates in both
+     *  generations keep their objects and paths; the units are reloaded once.
+     *
+     *  @param[in] filePath - Path of the authorities list.
+     *
+     *  @return D-Bus object paths of the certificates of the new generation.
+     */
+    std::vector<sdbusplus::message::object_path>
+        publishAuthorities(const std::string& filePath);
+
+    /** @brief Get the directory new generations of the store are built in,
+     * next to the install path
+     */
+    std::filesystem::path getStagingPath() const;
+
+    /** @brief Remove the PEM renderings of certificates no longer installed
+     */
+    void prunePemViews();
+
+    /** @brief Get the directory the CRLs are stored in, next to the install
+     * path, so that new generations of the store leave them alone
+     */
+    std::filesystem::path getCrlPath() const;
+
+    /** @brief Index the stored CRLs
+     */
+    void restoreCrls();
+
+    /** @brief Add the serial numbers of a CRL to |revocations|, replacing
+     * those of the previous CRL of its issuer
+     *  @param[in] crl - The CRL.
+     *  @return The issuer, as the Issuer property renders it.
+     */
+    std::string indexCrl(X509_CRL& crl);
+
+    /** @brief Tell if a CRL is signed by an installed certificate
+     *  @param[in] crl - The CRL.
+     */
+    bool isCrlIssuerInstalled(X509_CRL& crl) const;
+
+    /** @brief Tell if a CRL is newer than the stored CRL of its issuer, see
+     * isNewerCrl(); true if there is none
+     *  @param[in] crl - The CRL.
+     */
+    bool isNewerThanStoredCrl(X509_CRL& crl) const;
+
+    /** @brief Remove the CRLs whose issuer is no longer installed, and
+     * their revocations
+     */
+    void pruneCrls();
+
     /** @brief Check if provided certificate is unique across all certificates
      * on the internal list.
      *  @param[in] certFilePath - Path to the file with certificate for
@@ -336,8 +651,48 @@ class Manager : public internal::ManagerInterface
     /** @brief Certificate file installation path **/
     std::string certInstallPath;
 
+    /** @brief Encoding of the stored certificates */
+    StorageFormat storageFormat;
+
+    /** @brief PEM renderings of DER stored authorities, see getPemViewPath()
+     */
+    std::filesystem::path pemViewPath;
+
+    /** @brief Store of the certificate files shared with other endpoints */
+    std::unique_ptr<BlobStore> blobStore;
+
+    /** @brief Certificates by fingerprint, subject, issuer, and serial
+     * number and issuer; see indexCertificate(). They outlive
+     * |installedCerts|, whose certificates remove themselves from them.
+     */
+    KeyIndex<std::string> fingerprintIndex;
+    KeyIndex<std::string> subjectIndex;
+    KeyIndex<std::string> issuerIndex;
+    KeyIndex<std::string> serialNumberIndex;
+
+    /** @brief Issuers of the certificates, see updateAssociations() */
+    IssuerGraph issuerGraph{subjectIndex, issuerIndex};
+
+    /** @brief Serial numbers revoked by the stored CRLs */
+    RevocationIndex revocations;
+
+    /** @brief Stored CRL file of each issuer */
+    std::map<std::string, std::filesystem::path> crlFiles;
+
+    /** @brief IDs of the certificates revoked by the CRL of their issuer */
+    std::set<uint64_t> revokedCertIds;
+
+    /** @brief IDs of the certificates whose associations are out of date:
+     * those indexed, those issued by a subject indexed or unindexed, and
+     * those whose revocation changed; see updateAssociations()
+     */
+    std::set<uint64_t> staleAssociations;
+
+    /** @brief Installed certificates by expiry; see indexCertificate() */
+    ExpiryIndex expiryIndex;
+
     /** @brief Collection of pointers to certificate */
-    std::vector<std::unique_ptr<Certificate>> installedCerts;
+    CertificateMap installedCerts;
 
     /** @brief pointer to CSR */
     std::unique_ptr<CSR> csrPtr = nullptr;
@@ -345,6 +700,29 @@ class Manager : public internal::ManagerInterface
     /** @brief SDEventPlus child pointer added to event loop */
     std::unique_ptr<sdeventplus::source::Child> childPtr = nullptr;
 
+    /** @brief Event source of the background RSA key generation */
+    std::unique_ptr<sdeventplus::source::Child> keyGenChildPtr = nullptr;
+
+    /** @brief Read end of a pipe to the process generating the RSA private
+     * key in the background, -1 when there is none; CSR processes forked
+     * meanwhile wait for it to hang up
+     */
+    int keyGenFd = -1;
+
+    /** @brief Decrypted RSA private key; the private components live in the
+     * OpenSSL secure heap when it is initialized, see mainapp.cpp
+     */
+    std::unique_ptr<EVP_PKEY, decltype(&::EVP_PKEY_free)> rsaKeyCache{
+        nullptr, ::EVP_PKEY_free};
+
+    /** @brief Identity of the file |rsaKeyCache| was loaded from */
+    std::optional<FileStamp> rsaKeyStamp;
+
+    /** @brief Last PEM rendering of renderPem(), and its file */
+    std::string pemRendering;
+    std::string pemRenderingPath;
+    std::optional<FileStamp> pemRenderingStamp;
+
     /** @brief Watch on self signed certificates */
     std::unique_ptr<Watch> certWatchPtr = nullptr;
 
@@ -352,10 +730,30 @@ class Manager : public internal::ManagerInterface
     std::filesystem::path certParentInstallPath;
 
     /** @brief Certificate ID pool */
-    uint64_t certIdCounter = 1;
+    IdAllocator certIds;
+
+    /** @brief Timer of the next crossing of |expiryIndex|, on the wall
+     * clock, so that it follows the clock when it is set
+     */
+    std::unique_ptr<sdeventplus::source::Time<sdeventplus::ClockId::RealTime>>
+        expiryTimer;
+
+    /** @brief The queryInterface of the collection */
+    std::unique_ptr<sdbusplus::server::interface_t> queryIntf;
+
+    /** @brief The metricsInterface of the collection */
+    std::unique_ptr<sdbusplus::server::interface_t> metricsIntf;
+
+    /** @brief The memoryUsageInterface of the collection */
+    std::unique_ptr<sdbusplus::server::interface_t> memoryUsageIntf;
+
+    /** @brief The revocationInterface of the collection, on the endpoints
+     * taking CRLs
+     */
+    std::unique_ptr<sdbusplus::server::interface_t> revocationIntf;
 
-    /** @brief Unused Certificate ID pool */
-    std::set<uint64_t> certIdUnused;
+    /** @brief Set while the constructor restores stored certificates */
+    bool restoring = true;
 
     /** @brief Signature Manager */
     std::unique_ptr<phosphor::certs::SigManager> sigManager;
@@ -2,6 +2,8 @@
 
 #include "csr.hpp"
 
+#include "file_content.hpp"
+
 #include <openssl/bio.h>
 #include <openssl/buffer.h>
 #include <openssl/ossl_typ.h>
@@ -17,6 +19,7 @@
 #include <cstdio>
 #include <filesystem>
 #include <memory>
+#include <system_error>
 #include <utility>
 
 namespace phosphor::certs
@@ -35,6 +38,27 @@ CSR::CSR(sdbusplus::bus_t& bus, const char* path, std::string&& installPath,
                            internal::CSRInterface::action::defer_emit),
     objectPath(path), certInstallPath(std::move(installPath)), csrStatus(status)
 {
+    if (csrStatus == Status::success)
+    {
+        // Render the PEM text now, so that the first read is served from
+        // memory as well. Failures are reported when the CSR is read.
+        fs::path csrFilePath =
+            fs::path(certInstallPath).parent_path() / defaultCSRFileName;
+        auto stamp = getFileStamp(csrFilePath);
+        if (stamp)
+        {
+            try
+            {
+                loadCSR(csrFilePath, *stamp);
+            }
+            catch (const InternalFailure& e)
+            {
+                csrPem.clear();
+                csrStamp.reset();
+            }
+        }
+    }
+
     // Emit deferred signal.
     this->emit_object_added();
 }
@@ -48,27 +72,45 @@ std::string CSR::csr()
     }
     fs::path csrFilePath = certInstallPath;
     csrFilePath = csrFilePath.parent_path() / defaultCSRFileName;
-    if (!fs::exists(csrFilePath))
+    auto stamp = getFileStamp(csrFilePath);
+    if (!stamp)
     {
         lg2::error("CSR file doesn't exists, FILENAME:{FILENAME}", "FILENAME",
                    csrFilePath);
         elog<InternalFailure>();
     }
 
-    FILE* fp = std::fopen(csrFilePath.c_str(), "r");
-    X509ReqPtr x509Req(PEM_read_X509_REQ(fp, nullptr, nullptr, nullptr),
-                       ::X509_REQ_free);
-    if (x509Req == nullptr || fp == nullptr)
+    if (csrStamp != stamp)
     {
-        if (fp != nullptr)
+        loadCSR(csrFilePath, *stamp);
+    }
+    return csrPem;
+}
+
+void CSR::loadCSR(const fs::path& csrFilePath, const FileStamp& stamp)
+{
+    X509ReqPtr x509Req(nullptr, ::X509_REQ_free);
+    try
+    {
+        FileContent file(csrFilePath);
+        auto fileBio = file.bio();
+        if (fileBio)
         {
-            std::fclose(fp);
+            x509Req.reset(PEM_read_bio_X509_REQ(fileBio.get(), nullptr, nullptr,
+                                                nullptr));
         }
+    }
+    catch (const std::system_error& e)
+    {
+        lg2::error("Failed to read file, FILE:{FILE}, ERR:{ERR}", "FILE",
+                   csrFilePath, "ERR", e);
+    }
+    if (x509Req == nullptr)
+    {
         lg2::error("ERROR occurred while reading CSR file, FILENAME:{FILENAME}",
                    "FILENAME", csrFilePath);
         elog<InternalFailure>();
     }
-    std::fclose(fp);
 
     BIOPtr bio(BIO_new(BIO_s_mem()), ::BIO_free_all);
     int ret = PEM_write_bio_X509_REQ(bio.get(), x509Req.get());
@@ -80,8 +122,8 @@ std::string CSR::csr()
 
     BUF_MEM* mem = nullptr;
     BIO_get_mem_ptr(bio.get(), &mem);
-    std::string pem(mem->data, mem->length);
-    return pem;
+    csrPem.assign(mem->data, mem->length);
+    csrStamp = stamp;
 }
 
 } // namespace phosphor::certs
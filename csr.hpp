@@ -1,7 +1,11 @@
 #pragma once
+#include "file_content.hpp"
+
 #include <sdbusplus/server/object.hpp>
 #include <xyz/openbmc_project/Certs/CSR/server.hpp>
 
+#include <filesystem>
+#include <optional>
 #include <string>
 
 namespace phosphor::certs
@@ -21,6 +25,8 @@ using CSRInterface = sdbusplus::server::object_t<
 
 /** @class CSR
  *  @brief To read CSR certificate
+ *  @details The PEM text is rendered once and served from memory until the
+ *  CSR file changes, as clients poll the property until the CSR is ready.
  */
 class CSR : public internal::CSRInterface
 {
@@ -45,6 +51,13 @@ class CSR : public internal::CSRInterface
     std::string csr() override;
 
   private:
+    /** @brief Parse the CSR file and cache its PEM text
+     *  @param[in] csrFilePath - Path of the CSR file.
+     *  @param[in] stamp - Identity of the CSR file content.
+     */
+    void loadCSR(const std::filesystem::path& csrFilePath,
+                 const FileStamp& stamp);
+
     /** @brief object path */
     std::string objectPath;
 
@@ -53,5 +66,11 @@ class CSR : public internal::CSRInterface
 
     /** @brief Status of GenerateCSR request */
     Status csrStatus;
+
+    /** @brief PEM text of the CSR, empty until loaded */
+    std::string csrPem;
+
+    /** @brief Identity of the CSR file |csrPem| was rendered from */
+    std::optional<FileStamp> csrStamp;
 };
 } // namespace phosphor::certs
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <systemd/sd-bus.h>
+
+#include <sdbusplus/exception.hpp>
+#include <sdbusplus/message.hpp>
+
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace phosphor::certs
+{
+
+/** @brief D-Bus interface of the lookups the managers answer from their
+ *  indexes, which the phosphor-dbus-interfaces Certs interfaces don't cover;
+ *  see README.md
+ */
+inline constexpr auto queryInterface = "com.nvidia.Certs.Query";
+
+/** @brief D-Bus interface of the lookups of the signatures of a secure boot
+ *  database, on the same object as its queryInterface
+ */
+inline constexpr auto signatureQueryInterface =
+    "com.nvidia.Certs.SignatureQuery";
+
+/** @brief D-Bus interface of the revocation lists of the authority
+ *  managers, on the same object as their queryInterface
+ */
+inline constexpr auto revocationInterface = "com.nvidia.Certs.Revocation";
+
+/** @brief D-Bus interface of the read-only metrics of the endpoint, see
+ *  metrics::Registry, on the same object as its queryInterface
+ */
+inline constexpr auto metricsInterface = "com.nvidia.Certs.Metrics";
+
+/** @brief D-Bus interface of the read-only memory usage of the endpoint,
+ *  see Manager::memoryUsage(), on the same object as its queryInterface
+ */
+inline constexpr auto memoryUsageInterface = "com.nvidia.Certs.MemoryUsage";
+
+/** @brief Handle a get of a read-only property of the interfaces above
+ *  @details Appends |value| to |reply|; the D-Bus errors thrown are returned
+ *  to the caller.
+ *
+ *  @param[in] reply - The reply to the get.
+ *  @param[out] error - The error replied, if any.
+ *  @param[in] value - Value of the property.
+ *
+ *  @return What an sd-bus property getter returns.
+ */
+template <typename Value>
+int replyWithProperty(sd_bus_message* reply, sd_bus_error* error,
+                      const Value& value)
+{
+    try
+    {
+        sdbusplus::message_t message(reply);
+        message.append(value);
+        return 1;
+    }
+    catch (const sdbusplus::exception_t& e)
+    {
+        return sd_bus_error_set(error, e.name(), e.description());
+    }
+}
+
+/** @brief Handle a method call replying with object paths, e.g. of the
+ *  query interface
+ *  @details Reads the arguments of |msg|, of types |Args|, and replies with
+ *  the object paths |query| returns for them. The D-Bus errors |query|
+ *  throws, e.g. through elog(), are returned to the caller.
+ *
+ *  @param[in] msg - The method call.
+ *  @param[out] error - The error replied, if any.
+ *  @param[in] query - Callable taking |Args| and returning a vector of
+ *  object paths, as strings.
+ *
+ *  @return What an sd-bus method handler returns.
+ */
+template <typename... Args, typename Query>
+int replyToQuery(sd_bus_message* msg, sd_bus_error* error, Query&& query)
+{
+    try
+    {
+        sdbusplus::message_t call(msg);
+        std::tuple<Args...> args;
+        std::apply([&](auto&... arg) { call.read(arg...); }, args);
+        std::vector<sdbusplus::message::object_path> paths;
+        for (auto& path : std::apply(std::forward<Query>(query), args))
+        {
+            paths.emplace_back(std::move(path));
+        }
+        auto reply = call.new_method_return();
+        reply.append(paths);
+        reply.method_return();
+        return 1;
+    }
+    catch (const sdbusplus::exception_t& e)
+    {
+        return sd_bus_error_set(error, e.name(), e.description());
+    }
+}
+
+} // namespace phosphor::certs
@@ -0,0 +1,175 @@
+#include "expiry_index.hpp"
+
+#include "memory_usage.hpp"
+
+#include <algorithm>
+#include <iterator>
+
+namespace phosphor::certs
+{
+
+ExpiryIndex::ExpiryIndex(std::vector<uint64_t> windows) :
+    windows(std::move(windows))
+{
+    std::erase(this->windows, 0);
+    std::sort(this->windows.begin(), this->windows.end(), std::greater<>());
+    this->windows.erase(
+        std::unique(this->windows.begin(), this->windows.end()),
+        this->windows.end());
+    this->windows.push_back(0);
+}
+
+uint64_t ExpiryIndex::crossingTime(const Entry& entry) const
+{
+    uint64_t window = windows[entry.next];
+    return entry.notAfter > window ? entry.notAfter - window : 0;
+}
+
+void ExpiryIndex::update(uint64_t id, uint64_t notAfter)
+{
+    if (auto it = entries.find(id); it != entries.end())
+    {
+        if (it->second.notAfter == notAfter)
+        {
+            return;
+        }
+        erase(id);
+    }
+    Entry entry{notAfter, 0};
+    byNotAfter.emplace(notAfter, id);
+    crossings.emplace(crossingTime(entry), id);
+    entries.emplace(id, entry);
+}
+
+void ExpiryIndex::erase(uint64_t id)
+{
+    auto it = entries.find(id);
+    if (it == entries.end())
+    {
+        return;
+    }
+    byNotAfter.erase({it->second.notAfter, id});
+    if (it->second.next < windows.size())
+    {
+        crossings.erase({crossingTime(it->second), id});
+    }
+    entries.erase(it);
+}
+
+void ExpiryIndex::retain(const std::function<bool(uint64_t id)>& keep)
+{
+    std::vector<uint64_t> removed;
+    for (const auto& [id, entry] : entries)
+    {
+        if (!keep(id))
+        {
+            removed.push_back(id);
+        }
+    }
+    for (auto id : removed)
+    {
+        erase(id);
+    }
+}
+
+void ExpiryIndex::clear()
+{
+    entries.clear();
+    byNotAfter.clear();
+    crossings.clear();
+}
+
+std::vector<uint64_t> ExpiryIndex::expiringBefore(uint64_t time) const
+{
+    std::vector<uint64_t> ids;
+    auto end = byNotAfter.lower_bound({time, 0});
+    ids.reserve(static_cast<size_t>(std::distance(byNotAfter.begin(), end)));
+    for (auto it = byNotAfter.begin(); it != end; ++it)
+    {
+        ids.push_back(it->second);
+    }
+    return ids;
+}
+
+void ExpiryIndex::markCrossed(uint64_t id, uint64_t window)
+{
+    auto it = entries.find(id);
+    if (it == entries.end())
+    {
+        return;
+    }
+    Entry& entry = it->second;
+    // Windows are by descending size: skip those at least |window| long
+    size_t next = static_cast<size_t>(
+        std::upper_bound(windows.begin(), windows.end(), window,
+                         std::greater<>()) -
+        windows.begin());
+    if (next <= entry.next)
+    {
+        return;
+    }
+    if (entry.next < windows.size())
+    {
+        crossings.erase({crossingTime(entry), id});
+    }
+    entry.next = next;
+    if (entry.next < windows.size())
+    {
+        crossings.emplace(crossingTime(entry), id);
+    }
+}
+
+std::vector<ExpiryIndex::Crossing> ExpiryIndex::crossed() const
+{
+    std::vector<Crossing> crossed;
+    for (const auto& [id, entry] : entries)
+    {
+        if (entry.next > 0)
+        {
+            crossed.push_back({id, entry.notAfter, windows[entry.next - 1]});
+        }
+    }
+    std::sort(crossed.begin(), crossed.end(),
+              [](const Crossing& a, const Crossing& b) { return a.id < b.id; });
+    return crossed;
+}
+
+std::optional<uint64_t> ExpiryIndex::nextCrossing() const
+{
+    if (crossings.empty())
+    {
+        return std::nullopt;
+    }
+    return crossings.begin()->first;
+}
+
+std::vector<ExpiryIndex::Crossing> ExpiryIndex::due(uint64_t now)
+{
+    std::vector<Crossing> due;
+    while (!crossings.empty() && crossings.begin()->first <= now)
+    {
+        uint64_t id = crossings.begin()->second;
+        crossings.erase(crossings.begin());
+        Entry& entry = entries.at(id);
+        // Skip to the last window crossed
+        while (entry.next + 1 < windows.size() &&
+               crossingTime({entry.notAfter, entry.next + 1}) <= now)
+        {
+            ++entry.next;
+        }
+        due.push_back({id, entry.notAfter, windows[entry.next]});
+        if (++entry.next < windows.size())
+        {
+            crossings.emplace(crossingTime(entry), id);
+        }
+    }
+    return due;
+}
+
+size_t ExpiryIndex::memoryUsage() const
+{
+    return windows.capacity() * sizeof(uint64_t) + hashTableSize(entries) +
+           treeSize(byNotAfter) + treeSize(crossings);
+}
+
+} // namespace phosphor::certs
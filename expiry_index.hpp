@@ -0,0 +1,124 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace phosphor::certs
+{
+
+/** @class ExpiryIndex
+ *  @brief Certificates of an endpoint ordered by the end of their validity,
+ *  and the next warning window each of them enters.
+ *  @details Times are seconds since the Epoch, as in the ValidNotAfter
+ *  property. A certificate crosses each window, |window| seconds before its
+ *  notAfter time, once, then expires at notAfter: a window of 0. Updates,
+ *  removals and crossings are O(log n) in the number of certificates; the
+ *  next crossing is O(1), so that a single timer can be armed for it.
+ */
+class ExpiryIndex
+{
+  public:
+    /** @brief A certificate which entered a warning window, or expired */
+    struct Crossing
+    {
+        uint64_t id;
+        uint64_t notAfter;
+        /** @brief Seconds before notAfter, 0 if the certificate expired */
+        uint64_t window;
+    };
+
+    /** @brief Constructor
+     *  @param[in] windows - Warning windows, in seconds before notAfter, in
+     *  any order.
+     */
+    explicit ExpiryIndex(std::vector<uint64_t> windows);
+
+    /** @brief Add a certificate, or update its notAfter time. Updating a
+     *  certificate to the same time keeps the windows it already crossed.
+     *  @param[in] id - Certificate ID.
+     *  @param[in] notAfter - End of the validity of the certificate.
+     */
+    void update(uint64_t id, uint64_t notAfter);
+
+    /** @brief Remove a certificate; removing an unknown ID is a no-op */
+    void erase(uint64_t id);
+
+    /** @brief Remove the certificates |keep| returns false for */
+    void retain(const std::function<bool(uint64_t id)>& keep);
+
+    /** @brief Remove all the certificates */
+    void clear();
+
+    /** @brief Get the certificates whose notAfter time is before |time|
+     *  @return Their IDs, by ascending notAfter time.
+     */
+    std::vector<uint64_t> expiringBefore(uint64_t time) const;
+
+    /** @brief Mark the windows of a certificate down to |window| as
+     *  crossed, e.g. as a previous run recorded them; marking an unknown ID,
+     *  or windows already crossed, is a no-op.
+     *  @param[in] id - Certificate ID.
+     *  @param[in] window - Last window crossed, 0 if the certificate expired.
+     */
+    void markCrossed(uint64_t id, uint64_t window);
+
+    /** @brief Get the last window crossed by each certificate which crossed
+     *  one, so that it can be restored with markCrossed()
+     *  @return The crossings, by ascending ID.
+     */
+    std::vector<Crossing> crossed() const;
+
+    /** @brief Get the time of the next crossing, if any certificate has a
+     *  window left to cross
+     */
+    std::optional<uint64_t> nextCrossing() const;
+
+    /** @brief Take the crossings due at |now|
+     *  @details A certificate which crossed several windows since the last
+     *  call, e.g. after the clock was set, is reported once, for the last of
+     *  them.
+     *  @return The crossings, by ascending time.
+     */
+    std::vector<Crossing> due(uint64_t now);
+
+    /** @brief Number of certificates in the index */
+    size_t size() const
+    {
+        return entries.size();
+    }
+
+    /** @brief Estimate the heap memory of the index */
+    size_t memoryUsage() const;
+
+  private:
+    struct Entry
+    {
+        uint64_t notAfter;
+        /** @brief Index in |windows| of the next window to cross */
+        size_t next;
+    };
+
+    /** @brief Time the certificate crosses |windows[next]| at */
+    uint64_t crossingTime(const Entry& entry) const;
+
+    /** @brief Warning windows by descending size, then 0 for the expiry */
+    std::vector<uint64_t> windows;
+
+    std::unordered_map<uint64_t, Entry> entries;
+
+    /** @brief (notAfter, ID) of every certificate */
+    std::set<std::pair<uint64_t, uint64_t>> byNotAfter;
+
+    /** @brief (time, ID) of the next crossing of every certificate with a
+     *  window left to cross
+     */
+    std::set<std::pair<uint64_t, uint64_t>> crossings;
+};
+
+} // namespace phosphor::certs
@@ -0,0 +1,169 @@
+#include "file_content.hpp"
+
+#include "metrics.hpp"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <climits>
+#include <string>
+#include <system_error>
+
+namespace phosphor::certs
+{
+
+namespace
+{
+
+/** @brief RAII wrapper of a file descriptor */
+struct FileDescriptor
+{
+    explicit FileDescriptor(int fd) : fd(fd) {}
+    FileDescriptor(const FileDescriptor&) = delete;
+    FileDescriptor& operator=(const FileDescriptor&) = delete;
+    ~FileDescriptor()
+    {
+        if (fd >= 0)
+        {
+            ::close(fd);
+        }
+    }
+    int fd;
+};
+
+[[noreturn]] void throwErrno(const std::string& what)
+{
+    throw std::system_error(errno, std::generic_category(), what);
+}
+
+} // namespace
+
+FileContent::FileContent(const std::string& path)
+{
+    FileDescriptor file(::open(path.c_str(), O_RDONLY | O_CLOEXEC));
+    if (file.fd < 0)
+    {
+        throwErrno("open " + path);
+    }
+
+    struct stat st{};
+    if (::fstat(file.fd, &st) != 0)
+    {
+        throwErrno("fstat " + path);
+    }
+
+    // One byte more than the size, so that the end of a regular file is seen
+    // without growing the buffer; files on procfs or sysfs report no size.
+    size_t length = 0;
+    buffer.resize(S_ISREG(st.st_mode) && st.st_size > 0
+                      ? static_cast<size_t>(st.st_size) + 1
+                      : 4096);
+    while (true)
+    {
+        if (length == buffer.size())
+        {
+            buffer.resize(buffer.size() * 2);
+        }
+        ssize_t n = ::read(file.fd, buffer.data() + length,
+                           buffer.size() - length);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            throwErrno("read " + path);
+        }
+        if (n == 0)
+        {
+            break;
+        }
+        length += static_cast<size_t>(n);
+    }
+    buffer.resize(length);
+    if (length > INT_MAX)
+    {
+        throw std::system_error(EFBIG, std::generic_category(), path);
+    }
+    metrics::count(metrics::Counter::bytesRead, length);
+}
+
+std::unique_ptr<BIO, decltype(&::BIO_free)> FileContent::bio() const
+{
+    return {BIO_new_mem_buf(buffer.data(), static_cast<int>(buffer.size())),
+            ::BIO_free};
+}
+
+std::optional<FileStamp> getFileStamp(const std::string& path)
+{
+    struct stat st{};
+    if (stat(path.c_str(), &st) != 0)
+    {
+        return std::nullopt;
+    }
+    return FileStamp{st.st_dev, st.st_ino, st.st_size,
+                     static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 +
+                         st.st_mtim.tv_nsec};
+}
+
+void syncPath(const std::string& path)
+{
+    FileDescriptor file(::open(path.c_str(), O_RDONLY | O_CLOEXEC));
+    if (file.fd < 0)
+    {
+        throwErrno("open " + path);
+    }
+    if (::fsync(file.fd) != 0)
+    {
+        throwErrno("fsync " + path);
+    }
+}
+
+void writeFileAtomically(const std::string& path, std::string_view data)
+{
+    // Named after the process, so that instances sharing a directory, as
+    // with the blob store, don't write the same temporary file
+    std::string tempPath = path + '.' + std::to_string(::getpid()) + ".tmp";
+    try
+    {
+        FileDescriptor file(::open(tempPath.c_str(),
+                                   O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+                                   0666));
+        if (file.fd < 0)
+        {
+            throwErrno("open " + tempPath);
+        }
+        while (!data.empty())
+        {
+            ssize_t n = ::write(file.fd, data.data(), data.size());
+            if (n < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                throwErrno("write " + tempPath);
+            }
+            data.remove_prefix(static_cast<size_t>(n));
+        }
+        if (::fsync(file.fd) != 0)
+        {
+            throwErrno("fsync " + tempPath);
+        }
+        if (::rename(tempPath.c_str(), path.c_str()) != 0)
+        {
+            throwErrno("rename " + tempPath);
+        }
+    }
+    catch (const std::system_error&)
+    {
+        ::unlink(tempPath.c_str());
+        throw;
+    }
+    std::string directory = path.substr(0, path.rfind('/') + 1);
+    syncPath(directory.empty() ? "." : directory);
+}
+
+} // namespace phosphor::certs
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <openssl/bio.h>
+#include <sys/types.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace phosphor::certs
+{
+
+/** @class FileContent
+ *  @brief Content of a certificate, key or CSR file.
+ *  @details The file is read in one go into a buffer sized from its status,
+ *  so OpenSSL parses it through a memory BIO instead of copying it through
+ *  stdio buffers. The file is not mapped: other processes may rewrite or
+ *  truncate it in place while it is parsed.
+ */
+class FileContent
+{
+  public:
+    FileContent() = delete;
+    FileContent(const FileContent&) = delete;
+    FileContent& operator=(const FileContent&) = delete;
+    FileContent(FileContent&&) = delete;
+    FileContent& operator=(FileContent&&) = delete;
+    ~FileContent() = default;
+
+    /** @brief Read a file
+     *  @param[in] path - Path of the file.
+     *  @throws std::system_error if the file can't be opened or read.
+     */
+    explicit FileContent(const std::string& path);
+
+    /** @brief Content of the file */
+    std::string_view view() const
+    {
+        return buffer;
+    }
+
+    /** @brief Create a read-only memory BIO over the content of the file.
+     *  The BIO must not outlive this object.
+     *  @return The BIO, or nullptr if OpenSSL failed to allocate it.
+     */
+    std::unique_ptr<BIO, decltype(&::BIO_free)> bio() const;
+
+  private:
+    std::string buffer;
+};
+
+/** @brief Identity of a file's content, used to tell whether data derived
+ *  from the file is still current
+ */
+struct FileStamp
+{
+    dev_t device;
+    ino_t inode;
+    off_t size;
+    int64_t modifiedNs;
+
+    bool operator==(const FileStamp&) const = default;
+};
+
+/** @brief Get the identity of a file's content
+ *  @param[in] path - Path of the file.
+ *  @return The identity, std::nullopt if the file doesn't exist
+ */
+std::optional<FileStamp> getFileStamp(const std::string& path);
+
+/** @brief Flush a file or a directory to storage, e.g. a directory after a
+ *  rename in it
+ *  @param[in] path - Path of the file or directory.
+ *  @throws std::system_error on failure.
+ */
+void syncPath(const std::string& path);
+
+/** @brief Replace the content of a file so that, across a power loss too,
+ *  it holds either its previous content or the new one
+ *  @details Writes "<path>.<pid>.tmp", flushes it, renames it over |path|
+ *  and flushes the directory; without the flushes, ext4, UBIFS and JFFS2 may
+ *  commit the rename before the data and leave an empty file.
+ *  @param[in] path - Path of the file.
+ *  @param[in] data - New content.
+ *  @throws std::system_error on failure; the file is left as it was.
+ */
+void writeFileAtomically(const std::string& path, std::string_view data);
+
+} // namespace phosphor::certs
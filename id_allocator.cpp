@@ -0,0 +1,163 @@
+#include "id_allocator.hpp"
+
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+
+namespace phosphor::certs
+{
+
+uint64_t IdAllocator::allocate()
+{
+    if (freeRanges.empty())
+    {
+        if (next == std::numeric_limits<uint64_t>::max())
+        {
+            throw std::out_of_range("ID space exhausted");
+        }
+        return next++;
+    }
+
+    auto it = freeRanges.begin();
+    uint64_t id = it->first;
+    if (it->first == it->second)
+    {
+        freeRanges.erase(it);
+    }
+    else
+    {
+        // Shrink the interval from the front; it stays the first one.
+        auto node = freeRanges.extract(it);
+        node.key()++;
+        freeRanges.insert(freeRanges.begin(), std::move(node));
+    }
+    return id;
+}
+
+uint64_t IdAllocator::reserve(uint64_t id)
+{
+    if (id == 0 || id == std::numeric_limits<uint64_t>::max())
+    {
+        throw std::out_of_range("ID out of range");
+    }
+
+    if (id >= next)
+    {
+        // Everything between the frontier and the designated ID becomes a
+        // gap. The last interval never ends at next - 1, so the new one can
+        // be appended without merging.
+        if (id > next)
+        {
+            freeRanges.emplace_hint(freeRanges.end(), next, id - 1);
+        }
+        next = id + 1;
+        return id;
+    }
+
+    auto it = freeRanges.upper_bound(id);
+    if (it == freeRanges.begin())
+    {
+        return id;
+    }
+    --it;
+    if (it->second < id)
+    {
+        return id;
+    }
+
+    // Split the interval containing |id|.
+    uint64_t first = it->first;
+    uint64_t last = it->second;
+    it = freeRanges.erase(it);
+    if (id < last)
+    {
+        it = freeRanges.emplace_hint(it, id + 1, last);
+    }
+    if (first < id)
+    {
+        freeRanges.emplace_hint(it, first, id - 1);
+    }
+    return id;
+}
+
+void IdAllocator::release(uint64_t id)
+{
+    if (id == 0 || id >= next || !isAllocated(id))
+    {
+        return;
+    }
+
+    if (id == next - 1)
+    {
+        // Move the frontier back, absorbing a trailing interval if any.
+        next = id;
+        if (!freeRanges.empty())
+        {
+            auto last = std::prev(freeRanges.end());
+            if (last->second == next - 1)
+            {
+                next = last->first;
+                freeRanges.erase(last);
+            }
+        }
+        return;
+    }
+
+    auto after = freeRanges.upper_bound(id);
+    bool mergeAfter = after != freeRanges.end() && after->first == id + 1;
+    auto before = after;
+    bool mergeBefore = false;
+    if (before != freeRanges.begin())
+    {
+        --before;
+        mergeBefore = before->second + 1 == id;
+    }
+
+    if (mergeBefore && mergeAfter)
+    {
+        before->second = after->second;
+        freeRanges.erase(after);
+    }
+    else if (mergeBefore)
+    {
+        before->second = id;
+    }
+    else if (mergeAfter)
+    {
+        uint64_t last = after->second;
+        after = freeRanges.erase(after);
+        freeRanges.emplace_hint(after, id, last);
+    }
+    else
+    {
+        freeRanges.emplace_hint(after, id, id);
+    }
+}
+
+void IdAllocator::reset()
+{
+    freeRanges.clear();
+    next = 1;
+}
+
+bool IdAllocator::isAllocated(uint64_t id) const
+{
+    if (id == 0 || id >= next)
+    {
+        return false;
+    }
+    auto it = freeRanges.upper_bound(id);
+    if (it == freeRanges.begin())
+    {
+        return true;
+    }
+    --it;
+    return it->second < id;
+}
+
+size_t IdAllocator::gaps() const
+{
+    return freeRanges.size();
+}
+
+} // namespace phosphor::certs
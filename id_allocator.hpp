@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+
+namespace phosphor::certs
+{
+
+/** @class IdAllocator
+ *  @brief Allocator of the numeric IDs used in D-Bus object paths.
+ *  @details Every ID at or above |next| is free. Free IDs below it (released
+ *  ones, or ones skipped over by a designated ID) are kept as disjoint,
+ *  non-adjacent closed intervals, so memory is proportional to the number of
+ *  gaps and not to the ID values. All operations are O(log n) in the number
+ *  of gaps. IDs start from 1; 0 is never allocated.
+ */
+class IdAllocator
+{
+  public:
+    /** @brief Allocate the smallest free ID.
+     *  @return Allocated ID.
+     */
+    uint64_t allocate();
+
+    /** @brief Reserve a designated ID, e.g. one recovered from a file name.
+     *  Reserving an ID that is already allocated is a no-op.
+     *  @param[in] id - The designated ID; must not be 0.
+     *  @return The designated ID.
+     */
+    uint64_t reserve(uint64_t id);
+
+    /** @brief Release an allocated ID so it can be handed out again.
+     *  Releasing an ID which is not allocated is a no-op.
+     *  @param[in] id - ID to be released.
+     */
+    void release(uint64_t id);
+
+    /** @brief Release all IDs.
+     */
+    void reset();
+
+    /** @brief Check if an ID is currently allocated.
+     *  @param[in] id - ID to check.
+     *  @return True if allocated, false if not.
+     */
+    bool isAllocated(uint64_t id) const;
+
+    /** @brief Number of free intervals below the allocation frontier.
+     */
+    size_t gaps() const;
+
+  private:
+    /** @brief Free intervals: first ID mapped to last ID (inclusive) */
+    std::map<uint64_t, uint64_t> freeRanges;
+
+    /** @brief Smallest ID from which all IDs are free */
+    uint64_t next = 1;
+};
+
+} // namespace phosphor::certs
@@ -0,0 +1,51 @@
+#include "interned_string.hpp"
+
+#include <cstddef>
+#include <mutex>
+#include <unordered_map>
+
+namespace phosphor::certs
+{
+
+namespace
+{
+
+std::mutex poolMutex;
+
+// There are only a few distinct values (one per install directory), so the
+// keys are plain copies; a view of the pooled string would dangle as soon as
+// its last holder drops it.
+std::unordered_map<std::string, std::weak_ptr<const std::string>> pool;
+
+// Pool size after the last sweep of expired entries
+size_t sweptSize = 0;
+
+} // namespace
+
+InternedString intern(const std::string& value)
+{
+    std::lock_guard lock(poolMutex);
+    if (auto it = pool.find(value); it != pool.end())
+    {
+        if (auto shared = it->second.lock())
+        {
+            return shared;
+        }
+        pool.erase(it);
+    }
+
+    // Sweep expired entries once the pool has doubled, so that the cost is
+    // amortized over the insertions
+    if (pool.size() >= 2 * sweptSize)
+    {
+        std::erase_if(pool,
+                      [](const auto& entry) { return entry.second.expired(); });
+        sweptSize = pool.size() + 1;
+    }
+
+    auto shared = std::make_shared<const std::string>(value);
+    pool.emplace(value, shared);
+    return shared;
+}
+
+} // namespace phosphor::certs
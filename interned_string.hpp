@@ -0,0 +1,21 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+namespace phosphor::certs
+{
+
+/** @brief Immutable string shared by all the objects which hold an equal one,
+ *  e.g. the install directory of every certificate of an endpoint.
+ */
+using InternedString = std::shared_ptr<const std::string>;
+
+/** @brief Get the shared copy of a string, creating it if there is none.
+ *  Thread safe. Copies are released when the last holder drops them.
+ *  @param[in] value - String to intern.
+ *  @return The shared copy.
+ */
+InternedString intern(const std::string& value);
+
+} // namespace phosphor::certs
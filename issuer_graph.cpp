@@ -0,0 +1,95 @@
+#include "issuer_graph.hpp"
+
+#include <algorithm>
+
+namespace phosphor::certs
+{
+
+void IssuerGraph::set(uint64_t id,
+                      const std::optional<std::string>& subjectKeyId,
+                      const std::optional<std::string>& authorityKeyId)
+{
+    if (subjectKeyId)
+    {
+        subjectKeyIds.set(id, *subjectKeyId);
+    }
+    else
+    {
+        subjectKeyIds.erase(id);
+    }
+    if (authorityKeyId)
+    {
+        authorityKeyIds.set(id, *authorityKeyId);
+    }
+    else
+    {
+        authorityKeyIds.erase(id);
+    }
+}
+
+void IssuerGraph::erase(uint64_t id)
+{
+    subjectKeyIds.erase(id);
+    authorityKeyIds.erase(id);
+}
+
+void IssuerGraph::clear()
+{
+    subjectKeyIds.clear();
+    authorityKeyIds.clear();
+}
+
+bool IssuerGraph::isRoot(uint64_t id, const std::string& issuer) const
+{
+    const auto* subject = subjects.get(id);
+    if (subject == nullptr || *subject != issuer)
+    {
+        return false;
+    }
+    const auto* subjectKeyId = subjectKeyIds.get(id);
+    const auto* authorityKeyId = authorityKeyIds.get(id);
+    return subjectKeyId == nullptr || authorityKeyId == nullptr ||
+           *subjectKeyId == *authorityKeyId;
+}
+
+std::optional<uint64_t> IssuerGraph::issuerOf(uint64_t id) const
+{
+    const auto* issuer = issuers.get(id);
+    if (issuer == nullptr || isRoot(id, *issuer))
+    {
+        return std::nullopt;
+    }
+    const auto* authorityKeyId = authorityKeyIds.get(id);
+    auto isIssuer = [&](uint64_t candidate) {
+        const auto* subject = subjects.get(candidate);
+        if (candidate == id || subject == nullptr || *subject != *issuer)
+        {
+            return false;
+        }
+        const auto* subjectKeyId = subjectKeyIds.get(candidate);
+        return authorityKeyId == nullptr || subjectKeyId == nullptr ||
+               *subjectKeyId == *authorityKeyId;
+    };
+
+    // Most certificates identify the key of their issuer, which narrows the
+    // candidates down to one, renewals with the same key aside
+    if (authorityKeyId != nullptr)
+    {
+        auto candidates = subjectKeyIds.find(*authorityKeyId);
+        auto it = std::find_if(candidates.begin(), candidates.end(),
+                               isIssuer);
+        if (it != candidates.end())
+        {
+            return *it;
+        }
+    }
+    auto candidates = subjects.find(*issuer);
+    auto it = std::find_if(candidates.begin(), candidates.end(), isIssuer);
+    if (it != candidates.end())
+    {
+        return *it;
+    }
+    return std::nullopt;
+}
+
+} // namespace phosphor::certs
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "key_index.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+namespace phosphor::certs
+{
+
+/** @class IssuerGraph
+ *  @brief Which certificate of an endpoint issued which, by key identifier
+ *  and name, so that issuers are found without verifying signatures.
+ *  @details The issuer of a certificate is a certificate whose subject is
+ *  its issuer and, when both key identifiers are present, whose subject key
+ *  identifier is its authority key identifier; as OpenSSL looks issuers up.
+ *  Self-issued certificates with their own key are roots. The subjects and
+ *  issuers are those of the indexes the graph is built on; the graph only
+ *  keeps the key identifiers. Issuers are looked up on each call rather than
+ *  stored, so that adding or removing a certificate is O(1) on average and
+ *  never updates the certificates it issued: an issuer lookup is O(k) in the
+ *  number of candidates with the same key identifier or subject.
+ */
+class IssuerGraph
+{
+  public:
+    /** @brief Constructor
+     *  @param[in] subjects - Certificates by subject; must outlive the graph.
+     *  @param[in] issuers - Certificates by issuer; must outlive the graph.
+     */
+    IssuerGraph(const KeyIndex<std::string>& subjects,
+                const KeyIndex<std::string>& issuers) :
+        subjects(subjects), issuers(issuers)
+    {}
+
+    /** @brief Set the key identifiers of a certificate
+     *  @param[in] id - Certificate ID.
+     *  @param[in] subjectKeyId - See getSubjectKeyId().
+     *  @param[in] authorityKeyId - See getAuthorityKeyId().
+     */
+    void set(uint64_t id, const std::optional<std::string>& subjectKeyId,
+             const std::optional<std::string>& authorityKeyId);
+
+    /** @brief Remove a certificate; removing an unknown ID is a no-op */
+    void erase(uint64_t id);
+
+    /** @brief Remove all the certificates */
+    void clear();
+
+    /** @brief Get the issuer of a certificate
+     *  @return Its ID, the lowest if several match; std::nullopt for a root,
+     *  or if the issuer is not in the graph.
+     */
+    std::optional<uint64_t> issuerOf(uint64_t id) const;
+
+    /** @brief Estimate the heap memory of the graph, without the indexes it
+     *  is built on
+     */
+    size_t memoryUsage() const
+    {
+        return subjectKeyIds.memoryUsage() + authorityKeyIds.memoryUsage();
+    }
+
+  private:
+    /** @brief Tells if a certificate is self-issued with its own key */
+    bool isRoot(uint64_t id, const std::string& issuer) const;
+
+    const KeyIndex<std::string>& subjects;
+    const KeyIndex<std::string>& issuers;
+    KeyIndex<std::string> subjectKeyIds;
+    KeyIndex<std::string> authorityKeyIds;
+};
+
+} // namespace phosphor::certs
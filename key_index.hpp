@@ -0,0 +1,115 @@
+#pragma once
+
+#include "memory_usage.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace phosphor::certs
+{
+
+/** @class KeyIndex
+ *  @brief Object IDs by a key, e.g. certificates by subject, so that objects
+ *  are found without going through all of them.
+ *  @details Each ID has at most one key, and a key any number of IDs. Keys
+ *  are stored once: the ID to key map points to the keys of the key to ID
+ *  map, whose elements do not move on a rehash. Setting, erasing and finding
+ *  are O(1) on average, and O(n) in the number of IDs sharing the key.
+ */
+template <typename Key>
+class KeyIndex
+{
+  public:
+    /** @brief Set the key of an ID, replacing its previous one */
+    void set(uint64_t id, const Key& key)
+    {
+        if (auto it = keys.find(id); it != keys.end())
+        {
+            if (*it->second == key)
+            {
+                return;
+            }
+            erase(id);
+        }
+        auto it = ids.emplace(key, id);
+        keys.emplace(id, &it->first);
+    }
+
+    /** @brief Remove an ID; removing an unknown ID is a no-op */
+    void erase(uint64_t id)
+    {
+        auto key = keys.find(id);
+        if (key == keys.end())
+        {
+            return;
+        }
+        auto [begin, end] = ids.equal_range(*key->second);
+        auto it = std::find_if(begin, end, [id](const auto& entry) {
+            return entry.second == id;
+        });
+        keys.erase(key);
+        ids.erase(it);
+    }
+
+    /** @brief Remove all the IDs */
+    void clear()
+    {
+        keys.clear();
+        ids.clear();
+    }
+
+    /** @brief Get the IDs of a key
+     *  @return The IDs, in ascending order.
+     */
+    std::vector<uint64_t> find(const Key& key) const
+    {
+        std::vector<uint64_t> found;
+        auto [begin, end] = ids.equal_range(key);
+        for (auto it = begin; it != end; ++it)
+        {
+            found.push_back(it->second);
+        }
+        std::sort(found.begin(), found.end());
+        return found;
+    }
+
+    /** @brief Get the key of an ID
+     *  @return The key, nullptr if the ID has none.
+     */
+    const Key* get(uint64_t id) const
+    {
+        auto it = keys.find(id);
+        return it != keys.end() ? it->second : nullptr;
+    }
+
+    /** @brief Number of IDs in the index */
+    size_t size() const
+    {
+        return keys.size();
+    }
+
+    /** @brief Estimate the heap memory of the index, the keys included */
+    size_t memoryUsage() const
+    {
+        size_t bytes = hashTableSize(ids) + hashTableSize(keys);
+        if constexpr (std::is_same_v<Key, std::string>)
+        {
+            for (const auto& [key, id] : ids)
+            {
+                bytes += heapSize(key);
+            }
+        }
+        return bytes;
+    }
+
+  private:
+    std::unordered_multimap<Key, uint64_t> ids;
+    std::unordered_map<uint64_t, const Key*> keys;
+};
+
+} // namespace phosphor::certs
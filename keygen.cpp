@@ -0,0 +1,284 @@
+#include "keygen.hpp"
+
+#include <openssl/bn.h>
+#include <openssl/ec.h>
+#include <openssl/err.h>
+#include <openssl/obj_mac.h>
+#include <openssl/opensslv.h>
+#include <openssl/rsa.h>
+
+#include <phosphor-logging/elog-errors.hpp>
+#include <phosphor-logging/elog.hpp>
+#include <phosphor-logging/lg2.hpp>
+#include <xyz/openbmc_project/Common/error.hpp>
+
+#include <array>
+#include <cstdio>
+#include <optional>
+#include <string_view>
+
+namespace phosphor::certs
+{
+
+namespace
+{
+
+using ::phosphor::logging::elog;
+using ::sdbusplus::xyz::openbmc_project::Common::Error::InternalFailure;
+using ::sdbusplus::xyz::openbmc_project::Common::Error::InvalidArgument;
+using Argument =
+    ::phosphor::logging::xyz::openbmc_project::Common::InvalidArgument;
+
+// RAII support for openSSL functions.
+using EVPPkeyPtr = std::unique_ptr<EVP_PKEY, decltype(&::EVP_PKEY_free)>;
+using EVPPkeyCtxPtr =
+    std::unique_ptr<EVP_PKEY_CTX, decltype(&::EVP_PKEY_CTX_free)>;
+using BignumPtr = std::unique_ptr<BIGNUM, decltype(&::BN_free)>;
+
+constexpr int defaultKeyBitLength = 3072;
+// secp224r1 is equal to RSA 2048 KeyBitLength. Refer RFC 5349
+constexpr auto defaultKeyCurveID = "secp224r1";
+
+struct Curve
+{
+    std::string_view name;
+    std::string_view nistName;
+    int nid;
+};
+
+// Curves a CSR key can be generated on. Anything else is rejected before
+// OpenSSL gets to see the name.
+constexpr std::array<Curve, 4> supportedCurves = {{
+    {"secp224r1", "P-224", NID_secp224r1},
+    {"prime256v1", "P-256", NID_X9_62_prime256v1},
+    {"secp384r1", "P-384", NID_secp384r1},
+    {"secp521r1", "P-521", NID_secp521r1},
+}};
+
+std::optional<int> findCurve(std::string_view curveId)
+{
+    for (const auto& curve : supportedCurves)
+    {
+        if (curveId == curve.name || curveId == curve.nistName)
+        {
+            return curve.nid;
+        }
+    }
+    return std::nullopt;
+}
+
+} // namespace
+
+EVPPkeyPtr generateRSAKeyPair(int64_t keyBitLength)
+{
+    int64_t keyBitLen = keyBitLength;
+    // set keybit length to default value if not set
+    if (keyBitLen <= 0)
+    {
+        lg2::info("KeyBitLength is not given.Hence, using default KeyBitLength:"
+                  "{DEFAULTKEYBITLENGTH}",
+                  "DEFAULTKEYBITLENGTH", defaultKeyBitLength);
+        keyBitLen = defaultKeyBitLength;
+    }
+
+#if (OPENSSL_VERSION_NUMBER < 0x30000000L)
+
+    // generate rsa key
+    BignumPtr bne(BN_new(), ::BN_free);
+    auto ret = BN_set_word(bne.get(), RSA_F4);
+    if (ret == 0)
+    {
+        lg2::error("Error occurred during BN_set_word call");
+        ERR_print_errors_fp(stderr);
+        elog<InternalFailure>();
+    }
+    using RSAPtr = std::unique_ptr<RSA, decltype(&::RSA_free)>;
+    RSAPtr rsa(RSA_new(), ::RSA_free);
+    ret = RSA_generate_key_ex(rsa.get(), keyBitLen, bne.get(), nullptr);
+    if (ret != 1)
+    {
+        lg2::error(
+            "Error occurred during RSA_generate_key_ex call: {KEYBITLENGTH}",
+            "KEYBITLENGTH", keyBitLen);
+        ERR_print_errors_fp(stderr);
+        elog<InternalFailure>();
+    }
+
+    // set public key of x509 req
+    EVPPkeyPtr pKey(EVP_PKEY_new(), ::EVP_PKEY_free);
+    ret = EVP_PKEY_assign_RSA(pKey.get(), rsa.get());
+    if (ret == 0)
+    {
+        lg2::error("Error occurred during assign rsa key into EVP");
+        ERR_print_errors_fp(stderr);
+        elog<InternalFailure>();
+    }
+    // Now |rsa| is managed by |pKey|
+    rsa.release();
+    return pKey;
+
+#else
+    EVPPkeyCtxPtr ctx(EVP_PKEY_CTX_new_id(EVP_PKEY_RSA, nullptr),
+                      &::EVP_PKEY_CTX_free);
+    if (!ctx)
+    {
+        lg2::error("Error occurred creating EVP_PKEY_CTX from algorithm");
+        ERR_print_errors_fp(stderr);
+        elog<InternalFailure>();
+    }
+
+    if ((EVP_PKEY_keygen_init(ctx.get()) <= 0) ||
+        (EVP_PKEY_CTX_set_rsa_keygen_bits(ctx.get(), keyBitLen) <= 0))
+
+    {
+        lg2::error("Error occurred initializing keygen context");
+        ERR_print_errors_fp(stderr);
+        elog<InternalFailure>();
+    }
+
+    EVP_PKEY* pKey = nullptr;
+    if (EVP_PKEY_keygen(ctx.get(), &pKey) <= 0)
+    {
+        lg2::error("Error occurred during generate RSA key");
+        ERR_print_errors_fp(stderr);
+        elog<InternalFailure>();
+    }
+
+    return {pKey, &::EVP_PKEY_free};
+#endif
+}
+
+EVPPkeyPtr generateECKeyPair(const std::string& curveId)
+{
+    std::string curId(curveId);
+
+    if (curId.empty())
+    {
+        lg2::info("KeyCurveId is not given. Hence using default curve id,"
+                  "DEFAULTKEYCURVEID:{DEFAULTKEYCURVEID}",
+                  "DEFAULTKEYCURVEID", defaultKeyCurveID);
+        curId = defaultKeyCurveID;
+    }
+
+    auto curve = findCurve(curId);
+    if (!curve)
+    {
+        lg2::error("Given key curve id is not supported, KEYCURVEID:"
+                   "{KEYCURVEID}",
+                   "KEYCURVEID", curId);
+        elog<InvalidArgument>(Argument::ARGUMENT_NAME("KEYCURVEID"),
+                              Argument::ARGUMENT_VALUE(curId.c_str()));
+    }
+    int ecGrp = *curve;
+
+#if (OPENSSL_VERSION_NUMBER < 0x30000000L)
+
+    EC_KEY* ecKey = EC_KEY_new_by_curve_name(ecGrp);
+
+    if (ecKey == nullptr)
+    {
+        lg2::error(
+            "Error occurred during create the EC_Key object from NID, ECGROUP:{ECGROUP}",
+            "ECGROUP", ecGrp);
+        ERR_print_errors_fp(stderr);
+        elog<InternalFailure>();
+    }
+
+    // If you want to save a key and later load it with
+    // SSL_CTX_use_PrivateKey_file, then you must set the OPENSSL_EC_NAMED_CURVE
+    // flag on the key.
+    EC_KEY_set_asn1_flag(ecKey, OPENSSL_EC_NAMED_CURVE);
+
+    int ret = EC_KEY_generate_key(ecKey);
+
+    if (ret == 0)
+    {
+        EC_KEY_free(ecKey);
+        lg2::error("Error occurred during generate EC key");
+        ERR_print_errors_fp(stderr);
+        elog<InternalFailure>();
+    }
+
+    EVPPkeyPtr pKey(EVP_PKEY_new(), ::EVP_PKEY_free);
+    ret = EVP_PKEY_assign_EC_KEY(pKey.get(), ecKey);
+    if (ret == 0)
+    {
+        EC_KEY_free(ecKey);
+        lg2::error("Error occurred during assign EC Key into EVP");
+        ERR_print_errors_fp(stderr);
+        elog<InternalFailure>();
+    }
+
+    return pKey;
+
+#else
+    // The curve is a named one, so the key can be generated directly; no
+    // separate parameter generation round trip is needed.
+    EVPPkeyCtxPtr ctx(EVP_PKEY_CTX_new_id(EVP_PKEY_EC, nullptr),
+                      &::EVP_PKEY_CTX_free);
+    if (!ctx || (EVP_PKEY_keygen_init(ctx.get()) <= 0) ||
+        (EVP_PKEY_CTX_set_ec_paramgen_curve_nid(ctx.get(), ecGrp) <= 0) ||
+        (EVP_PKEY_CTX_set_ec_param_enc(ctx.get(), OPENSSL_EC_NAMED_CURVE) <=
+         0))
+    {
+        lg2::error("Error occurred initializing keygen context");
+        ERR_print_errors_fp(stderr);
+        elog<InternalFailure>();
+    }
+
+    EVP_PKEY* pKey = nullptr;
+    if (EVP_PKEY_keygen(ctx.get(), &pKey) <= 0)
+    {
+        lg2::error("Error occurred during generate EC key");
+        ERR_print_errors_fp(stderr);
+        elog<InternalFailure>();
+    }
+
+    return {pKey, &::EVP_PKEY_free};
+#endif
+}
+
+EVPPkeyPtr generateEd25519KeyPair()
+{
+    EVPPkeyCtxPtr ctx(EVP_PKEY_CTX_new_id(EVP_PKEY_ED25519, nullptr),
+                      &::EVP_PKEY_CTX_free);
+    if (!ctx || (EVP_PKEY_keygen_init(ctx.get()) <= 0))
+    {
+        lg2::error("Error occurred initializing keygen context");
+        ERR_print_errors_fp(stderr);
+        elog<InternalFailure>();
+    }
+
+    EVP_PKEY* pKey = nullptr;
+    if (EVP_PKEY_keygen(ctx.get(), &pKey) <= 0)
+    {
+        lg2::error("Error occurred during generate Ed25519 key");
+        ERR_print_errors_fp(stderr);
+        elog<InternalFailure>();
+    }
+
+    return {pKey, &::EVP_PKEY_free};
+}
+
+const EVP_MD* getSigningDigest(const EVP_PKEY& pKey)
+{
+    switch (EVP_PKEY_id(&pKey))
+    {
+        case EVP_PKEY_ED25519:
+            return nullptr;
+        case EVP_PKEY_EC:
+            if (EVP_PKEY_bits(&pKey) > 384)
+            {
+                return EVP_sha512();
+            }
+            if (EVP_PKEY_bits(&pKey) > 256)
+            {
+                return EVP_sha384();
+            }
+            return EVP_sha256();
+        default:
+            return EVP_sha256();
+    }
+}
+
+} // namespace phosphor::certs
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <openssl/evp.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace phosphor::certs
+{
+
+/** @brief Generate RSA Key pair and get private key from key pair
+ *  @param[in]  keyBitLength - KeyBit length; the default one if not positive.
+ *  @return     Pointer to RSA private key
+ */
+std::unique_ptr<EVP_PKEY, decltype(&::EVP_PKEY_free)>
+    generateRSAKeyPair(int64_t keyBitLength);
+
+/** @brief Generate EC Key pair and get private key from key pair
+ *  @details Only the curves listed in keygen.cpp are accepted, by either
+ *  their OpenSSL or their NIST name (e.g. "secp384r1" or "P-384"). An empty
+ *  curve ID selects the default curve.
+ *  @param[in]  curveId - Curve ID
+ *  @return     Pointer to EC private key
+ */
+std::unique_ptr<EVP_PKEY, decltype(&::EVP_PKEY_free)>
+    generateECKeyPair(const std::string& curveId);
+
+/** @brief Generate Ed25519 Key pair and get private key from key pair
+ *  @return     Pointer to Ed25519 private key
+ */
+std::unique_ptr<EVP_PKEY, decltype(&::EVP_PKEY_free)> generateEd25519KeyPair();
+
+/** @brief Get the digest to sign a CSR with the given key
+ *  @details Ed25519 hashes the message itself and must be given no digest,
+ *  EC keys get the digest matching their curve size and RSA keys SHA-256.
+ *  @param[in]  pKey - Signing key
+ *  @return     Digest to pass to X509_REQ_sign(), possibly nullptr
+ */
+const EVP_MD* getSigningDigest(const EVP_PKEY& pKey);
+
+} // namespace phosphor::certs
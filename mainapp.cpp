@@ -19,17 +19,30 @@
 #include "argument.hpp"
 #include "certificate.hpp"
 #include "certs_manager.hpp"
+#include "metrics.hpp"
+#include "startup_trace.hpp"
+#include "x509_utils.hpp"
 
+#include <openssl/crypto.h>
 #include <systemd/sd-event.h>
 
+#include <phosphor-logging/lg2.hpp>
 #include <sdbusplus/bus.hpp>
 #include <sdbusplus/server/manager.hpp>
 #include <sdeventplus/event.hpp>
+#include <sdeventplus/source/signal.hpp>
 
 #include <cctype>
+#include <csignal>
+#include <cstddef>
 #include <string>
 #include <utility>
 
+// Size of the OpenSSL secure heap, which holds the private components of
+// cached keys. It is locked in memory and excluded from core dumps.
+constexpr size_t secureHeapSize = 32 * 1024;
+constexpr size_t secureHeapMinAllocation = 32;
+
 inline std::string capitalize(const std::string& s)
 {
     std::string res = s;
@@ -48,6 +61,21 @@ int main(int argc, char** argv)
         std::exit(EXIT_FAILURE);
     }
 
+    if (!arguments.startupTrace.empty())
+    {
+        phosphor::certs::trace::start(arguments.startupTrace,
+                                      arguments.typeStr + '/' +
+                                          arguments.endpoint);
+    }
+    // Until the service owns its bus name, and so is ready for clients
+    phosphor::certs::trace::Span startup("startup");
+
+    if (CRYPTO_secure_malloc_init(secureHeapSize, secureHeapMinAllocation) ==
+        0)
+    {
+        lg2::warning("Unable to initialize the OpenSSL secure heap");
+    }
+
     auto bus = sdbusplus::bus::new_default();
     auto objPath = std::string(objectNamePrefix) + '/' + arguments.typeStr +
                    '/' + arguments.endpoint;
@@ -71,15 +99,37 @@ int main(int argc, char** argv)
     // Add sdbusplus ObjectManager
     sdbusplus::server::manager_t objManager(bus, objPath.c_str());
 
-    phosphor::certs::Manager manager(bus, event, objPath.c_str(),
-                                     certificateType, arguments.unit,
-                                     arguments.path);
+    // Set before the restore, which is timed too
+    phosphor::certs::metrics::registry().setExportPath(arguments.metricsFile);
+
+    // SIGUSR1 dumps the memory usage and the metrics to the journal. Block it
+    // before the manager starts its restore threads, so that they inherit the
+    // mask.
+    sigset_t ss;
+    sigemptyset(&ss);
+    sigaddset(&ss, SIGUSR1);
+    sigprocmask(SIG_BLOCK, &ss, nullptr);
+
+    phosphor::certs::Manager manager(
+        bus, event, objPath.c_str(), certificateType, arguments.unit,
+        arguments.path,
+        *phosphor::certs::stringToStorageFormat(arguments.format));
+
+    sdeventplus::source::Signal memoryDump(
+        event, SIGUSR1,
+        [&manager](sdeventplus::source::Signal&,
+                   const struct signalfd_siginfo*) {
+            manager.logMemoryUsage();
+            phosphor::certs::metrics::registry().log();
+        });
 
     // Adjusting Interface name as per std convention
     auto busName = std::string(busNamePrefix) + '.' +
                    capitalize(arguments.typeStr) + '.' +
                    capitalize(arguments.endpoint);
     bus.request_name(busName.c_str());
+    startup.end();
+    phosphor::certs::trace::finish();
     event.loop();
     return 0;
 }
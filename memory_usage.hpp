@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace phosphor::certs
+{
+
+/** @brief Heap memory held by a string, 0 if it fits the inline buffer
+ *  @param[in] value - The string.
+ *  @return Size of the heap allocation in bytes.
+ */
+inline size_t heapSize(const std::string& value)
+{
+    return value.capacity() > std::string().capacity() ? value.capacity() + 1
+                                                       : 0;
+}
+
+/** @brief Heap memory held by a list of strings
+ *  @param[in] values - The strings.
+ *  @return Size of the heap allocations in bytes.
+ */
+inline size_t heapSize(const std::vector<std::string>& values)
+{
+    size_t bytes = values.capacity() * sizeof(std::string);
+    for (const auto& value : values)
+    {
+        bytes += heapSize(value);
+    }
+    return bytes;
+}
+
+/** @brief Heap memory of the nodes and buckets of a hash container, e.g.
+ *  std::unordered_map, not counting what its elements own
+ *  @details A node holds the element, the next node pointer and, as
+ *  libstdc++ caches it for strings, the hash.
+ *  @param[in] container - The container.
+ *  @return Estimated size in bytes.
+ */
+template <typename Container>
+size_t hashTableSize(const Container& container)
+{
+    return container.size() *
+               (sizeof(typename Container::value_type) + 2 * sizeof(void*)) +
+           container.bucket_count() * sizeof(void*);
+}
+
+/** @brief Heap memory of the nodes of a tree container, e.g. std::set, not
+ *  counting what its elements own
+ *  @details A node holds the element, three links and the color.
+ *  @param[in] container - The container.
+ *  @return Estimated size in bytes.
+ */
+template <typename Container>
+size_t treeSize(const Container& container)
+{
+    return container.size() *
+           (sizeof(typename Container::value_type) + 4 * sizeof(void*));
+}
+
+/** @brief Memory used by a collection of D-Bus objects */
+struct MemoryUsage
+{
+    /** @brief Number of objects */
+    size_t objects = 0;
+
+    /** @brief Estimated bytes, objects and the heap memory they own */
+    size_t bytes = 0;
+
+    /** @brief Estimated bytes of the lookup indexes of the objects, and of
+     *  the map holding them
+     */
+    size_t indexBytes = 0;
+};
+
+/** @brief Memory used by an endpoint, see Manager::memoryUsage() */
+struct EndpointMemoryUsage
+{
+    /** @brief The certificate objects */
+    MemoryUsage certificates;
+
+    /** @brief The signature objects, of a secure boot database */
+    MemoryUsage signatures;
+
+    /** @brief Estimated bytes of the endpoint, its objects and their
+     *  indexes included
+     */
+    size_t totalBytes = 0;
+
+    /** @brief Resident set size of the process, to compare the estimate
+     *  against
+     */
+    size_t residentBytes = 0;
+};
+
+} // namespace phosphor::certs
@@ -0,0 +1,385 @@
+#include "metrics.hpp"
+
+#include "file_content.hpp"
+
+#include <phosphor-logging/lg2.hpp>
+#include <xyz/openbmc_project/Certs/error.hpp>
+#include <xyz/openbmc_project/Common/error.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <string_view>
+
+namespace phosphor::certs::metrics
+{
+
+namespace
+{
+
+namespace fs = std::filesystem;
+using ::sdbusplus::xyz::openbmc_project::Certs::Error::InvalidCertificate;
+using ::sdbusplus::xyz::openbmc_project::Common::Error::InternalFailure;
+using ::sdbusplus::xyz::openbmc_project::Common::Error::InvalidArgument;
+using ::sdbusplus::xyz::openbmc_project::Common::Error::NotAllowed;
+
+constexpr std::string_view prefix = "phosphor_certificate_manager_";
+
+constexpr std::array<std::string_view, operationCount> operationNames = {
+    "install",     "installAll",   "replaceAll", "deleteAll",
+    "generateCSR", "addSignature", "restore",
+};
+
+constexpr std::array<std::string_view, errorClassCount> errorClassNames = {
+    "InvalidCertificate", "InvalidArgument", "NotAllowed", "InternalFailure",
+    "Other",
+};
+
+constexpr std::array<std::string_view, counterCount> counterNames = {
+    "bytes_read_total",
+    "bytes_written_total",
+    "openssl_parses_total",
+    "reloads_total",
+};
+
+constexpr std::array<std::string_view, counterCount> counterKeys = {
+    "bytesRead",
+    "bytesWritten",
+    "opensslParses",
+    "reloads",
+};
+
+constexpr std::array<std::string_view, counterCount> counterHelps = {
+    "Bytes of certificate files read.",
+    "Bytes of certificate files written.",
+    "Certificates and CRLs decoded by OpenSSL.",
+    "Reloads or restarts of the unit consuming the certificates.",
+};
+
+/** @brief Index of the latency bucket of |duration| */
+size_t bucketOf(std::chrono::nanoseconds duration)
+{
+    auto microseconds = static_cast<uint64_t>(
+        std::chrono::ceil<std::chrono::microseconds>(duration).count());
+    if (microseconds <= 1)
+    {
+        return 0;
+    }
+    return std::min<size_t>(std::bit_width(microseconds - 1),
+                            Registry::bucketCount);
+}
+
+std::string label(Operation operation)
+{
+    return "operation=\"" +
+           std::string(operationNames[static_cast<size_t>(operation)]) + '"';
+}
+
+/** @brief Upper bound of a latency bucket, in seconds; exact with six
+ * decimals
+ */
+std::string bucketBound(size_t bucket)
+{
+    return std::to_string(static_cast<double>(uint64_t{1} << bucket) / 1e6);
+}
+
+} // namespace
+
+void Registry::record(Operation operation, std::chrono::nanoseconds duration,
+                      std::optional<ErrorClass> error)
+{
+    auto& metrics = operations[static_cast<size_t>(operation)];
+    metrics.calls.fetch_add(1, std::memory_order_relaxed);
+    metrics.totalMicroseconds.fetch_add(
+        static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(duration)
+                .count()),
+        std::memory_order_relaxed);
+    metrics.buckets[bucketOf(duration)].fetch_add(1,
+                                                  std::memory_order_relaxed);
+    if (error)
+    {
+        metrics.errors[static_cast<size_t>(*error)].fetch_add(
+            1, std::memory_order_relaxed);
+    }
+    exportFile();
+}
+
+uint64_t Registry::calls(Operation operation) const noexcept
+{
+    return operations[static_cast<size_t>(operation)].calls.load(
+        std::memory_order_relaxed);
+}
+
+uint64_t Registry::errors(Operation operation, ErrorClass error) const noexcept
+{
+    return operations[static_cast<size_t>(operation)]
+        .errors[static_cast<size_t>(error)]
+        .load(std::memory_order_relaxed);
+}
+
+uint64_t Registry::latencyBucket(Operation operation,
+                                 size_t bucket) const noexcept
+{
+    return operations[static_cast<size_t>(operation)].buckets[bucket].load(
+        std::memory_order_relaxed);
+}
+
+std::map<std::string, uint64_t> Registry::callsByOperation() const
+{
+    std::map<std::string, uint64_t> values;
+    for (size_t i = 0; i < operationCount; ++i)
+    {
+        values.emplace(operationNames[i], calls(static_cast<Operation>(i)));
+    }
+    return values;
+}
+
+std::map<std::string, std::map<std::string, uint64_t>>
+    Registry::errorsByOperation() const
+{
+    std::map<std::string, std::map<std::string, uint64_t>> values;
+    for (size_t i = 0; i < operationCount; ++i)
+    {
+        auto& classes = values[std::string(operationNames[i])];
+        for (size_t j = 0; j < errorClassCount; ++j)
+        {
+            classes.emplace(errorClassNames[j],
+                            errors(static_cast<Operation>(i),
+                                   static_cast<ErrorClass>(j)));
+        }
+    }
+    return values;
+}
+
+std::map<std::string, std::vector<uint64_t>>
+    Registry::latencyByOperation() const
+{
+    std::map<std::string, std::vector<uint64_t>> values;
+    for (size_t i = 0; i < operationCount; ++i)
+    {
+        auto& buckets = values[std::string(operationNames[i])];
+        for (size_t bucket = 0; bucket <= bucketCount; ++bucket)
+        {
+            buckets.push_back(
+                latencyBucket(static_cast<Operation>(i), bucket));
+        }
+    }
+    return values;
+}
+
+std::map<std::string, uint64_t> Registry::durationByOperation() const
+{
+    std::map<std::string, uint64_t> values;
+    for (size_t i = 0; i < operationCount; ++i)
+    {
+        values.emplace(operationNames[i], operations[i].totalMicroseconds.load(
+                                              std::memory_order_relaxed));
+    }
+    return values;
+}
+
+std::map<std::string, uint64_t> Registry::countersByName() const
+{
+    std::map<std::string, uint64_t> values;
+    for (size_t i = 0; i < counterCount; ++i)
+    {
+        values.emplace(counterKeys[i], get(static_cast<Counter>(i)));
+    }
+    return values;
+}
+
+std::string Registry::toPrometheus() const
+{
+    std::string text;
+    auto header = [&text](std::string_view name, std::string_view type,
+                          std::string_view help) {
+        text += "# HELP ";
+        text += prefix;
+        text += name;
+        text += ' ';
+        text += help;
+        text += "\n# TYPE ";
+        text += prefix;
+        text += name;
+        text += ' ';
+        text += type;
+        text += '\n';
+    };
+    std::string endpointLabel;
+    if (!endpoint.empty())
+    {
+        endpointLabel = "endpoint=\"" + endpoint + '"';
+    }
+    auto sample = [&text, &endpointLabel](std::string_view name,
+                                          const std::string& labels,
+                                          const std::string& value) {
+        text += prefix;
+        text += name;
+        if (!endpointLabel.empty() && !labels.empty())
+        {
+            text += '{' + endpointLabel + ',' + labels + '}';
+        }
+        else if (!endpointLabel.empty() || !labels.empty())
+        {
+            text += '{' + endpointLabel + labels + '}';
+        }
+        text += ' ' + value + '\n';
+    };
+
+    header("operations_total", "counter", "Calls of the operation.");
+    for (size_t i = 0; i < operationCount; ++i)
+    {
+        sample("operations_total", label(static_cast<Operation>(i)),
+               std::to_string(calls(static_cast<Operation>(i))));
+    }
+
+    header("operation_errors_total", "counter",
+           "Calls of the operation which failed, by error class.");
+    for (size_t i = 0; i < operationCount; ++i)
+    {
+        for (size_t j = 0; j < errorClassCount; ++j)
+        {
+            sample("operation_errors_total",
+                   label(static_cast<Operation>(i)) + ",class=\"" +
+                       std::string(errorClassNames[j]) + '"',
+                   std::to_string(errors(static_cast<Operation>(i),
+                                         static_cast<ErrorClass>(j))));
+        }
+    }
+
+    header("operation_duration_seconds", "histogram",
+           "Duration of the calls of the operation.");
+    for (size_t i = 0; i < operationCount; ++i)
+    {
+        auto operation = static_cast<Operation>(i);
+        uint64_t cumulative = 0;
+        for (size_t bucket = 0; bucket <= bucketCount; ++bucket)
+        {
+            cumulative += latencyBucket(operation, bucket);
+            std::string bound = bucket < bucketCount ? bucketBound(bucket)
+                                                     : "+Inf";
+            sample("operation_duration_seconds_bucket",
+                   label(operation) + ",le=\"" + bound + '"',
+                   std::to_string(cumulative));
+        }
+        uint64_t microseconds =
+            operations[i].totalMicroseconds.load(std::memory_order_relaxed);
+        sample("operation_duration_seconds_sum", label(operation),
+               std::to_string(static_cast<double>(microseconds) / 1e6));
+        sample("operation_duration_seconds_count", label(operation),
+               std::to_string(cumulative));
+    }
+
+    for (size_t i = 0; i < counterCount; ++i)
+    {
+        header(counterNames[i], "counter", counterHelps[i]);
+        sample(counterNames[i], {},
+               std::to_string(get(static_cast<Counter>(i))));
+    }
+    return text;
+}
+
+void Registry::log() const
+{
+    for (size_t i = 0; i < operationCount; ++i)
+    {
+        auto operation = static_cast<Operation>(i);
+        uint64_t callCount = calls(operation);
+        if (callCount == 0)
+        {
+            continue;
+        }
+        uint64_t errorCount = 0;
+        for (size_t j = 0; j < errorClassCount; ++j)
+        {
+            errorCount += errors(operation, static_cast<ErrorClass>(j));
+        }
+        // Upper bound of the bucket holding the slowest call
+        size_t slowest = bucketCount;
+        while (slowest > 0 && latencyBucket(operation, slowest) == 0)
+        {
+            --slowest;
+        }
+        lg2::info("Operation metrics, OPERATION:{OPERATION}, CALLS:{CALLS}, "
+                  "ERRORS:{ERRORS}, MEAN_US:{MEAN_US}, MAX_US:{MAX_US}",
+                  "OPERATION", operationNames[i], "CALLS", callCount,
+                  "ERRORS", errorCount, "MEAN_US",
+                  operations[i].totalMicroseconds.load(
+                      std::memory_order_relaxed) /
+                      callCount,
+                  "MAX_US",
+                  slowest < bucketCount ? uint64_t{1} << slowest : 0);
+    }
+    lg2::info("Work metrics, BYTES_READ:{BYTES_READ}, "
+              "BYTES_WRITTEN:{BYTES_WRITTEN}, PARSES:{PARSES}, "
+              "RELOADS:{RELOADS}",
+              "BYTES_READ", get(Counter::bytesRead), "BYTES_WRITTEN",
+              get(Counter::bytesWritten), "PARSES",
+              get(Counter::opensslParses), "RELOADS", get(Counter::reloads));
+}
+
+void Registry::setExportPath(const fs::path& path)
+{
+    exportPath = path;
+    exportFile();
+}
+
+void Registry::setEndpoint(const std::string& objectPath)
+{
+    endpoint = objectPath;
+    exportFile();
+}
+
+void Registry::exportFile() const
+{
+    if (exportPath.empty())
+    {
+        return;
+    }
+    // The collector must never read a partial file
+    try
+    {
+        writeFileAtomically(exportPath, toPrometheus());
+    }
+    catch (const std::exception& e)
+    {
+        lg2::error("Failed to export metrics, ERR:{ERR}, FILE:{FILE}", "ERR", e,
+                   "FILE", exportPath);
+    }
+}
+
+Registry& registry()
+{
+    static Registry instance;
+    return instance;
+}
+
+ErrorClass classify(const std::exception_ptr& error)
+{
+    try
+    {
+        std::rethrow_exception(error);
+    }
+    catch (const InvalidCertificate&)
+    {
+        return ErrorClass::invalidCertificate;
+    }
+    catch (const InvalidArgument&)
+    {
+        return ErrorClass::invalidArgument;
+    }
+    catch (const NotAllowed&)
+    {
+        return ErrorClass::notAllowed;
+    }
+    catch (const InternalFailure&)
+    {
+        return ErrorClass::internalFailure;
+    }
+    catch (...)
+    {
+        return ErrorClass::other;
+    }
+}
+
+} // namespace phosphor::certs::metrics
@@ -0,0 +1,231 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <map>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace phosphor::certs::metrics
+{
+
+/** @brief Operations timed; the D-Bus methods and the startup restore */
+enum class Operation
+{
+    install,
+    installAll,
+    replaceAll,
+    deleteAll,
+    generateCSR,
+    addSignature,
+    restore,
+};
+inline constexpr size_t operationCount = 7;
+
+/** @brief Classes of the errors an operation fails with */
+enum class ErrorClass
+{
+    invalidCertificate,
+    invalidArgument,
+    notAllowed,
+    internalFailure,
+    other,
+};
+inline constexpr size_t errorClassCount = 5;
+
+/** @brief Counters of the work done on behalf of the operations */
+enum class Counter
+{
+    bytesRead,
+    bytesWritten,
+    opensslParses,
+    reloads,
+};
+inline constexpr size_t counterCount = 4;
+
+/** @class Registry
+ *  @brief Metrics of the endpoint served by the process.
+ *  @details Recording is a few relaxed atomic increments, so that counters
+ *  can be bumped from the restore workers and on the parsing paths. The
+ *  latencies are counted in log2 buckets.
+ */
+class Registry
+{
+  public:
+    /** @brief Number of finite latency buckets; bucket i counts the calls
+     * which took up to 2^i microseconds, the last one about 33 s
+     */
+    static constexpr size_t bucketCount = 26;
+
+    /** @brief Record a call of an operation
+     *  @param[in] operation - The operation.
+     *  @param[in] duration - How long it took.
+     *  @param[in] error - Class of the error it failed with, if it did.
+     */
+    void record(Operation operation, std::chrono::nanoseconds duration,
+                std::optional<ErrorClass> error);
+
+    /** @brief Add to a counter */
+    void count(Counter counter, uint64_t value) noexcept
+    {
+        counters[static_cast<size_t>(counter)].fetch_add(
+            value, std::memory_order_relaxed);
+    }
+
+    uint64_t get(Counter counter) const noexcept
+    {
+        return counters[static_cast<size_t>(counter)].load(
+            std::memory_order_relaxed);
+    }
+
+    uint64_t calls(Operation operation) const noexcept;
+
+    uint64_t errors(Operation operation, ErrorClass error) const noexcept;
+
+    /** @brief Get the number of calls which took up to 2^|bucket| us; the
+     * bucket past the last one counts the slower calls
+     */
+    uint64_t latencyBucket(Operation operation, size_t bucket) const noexcept;
+
+    /** @brief Get the calls of the operations, by operation name, e.g.
+     * "installAll", as the metrics D-Bus interface publishes them
+     */
+    std::map<std::string, uint64_t> callsByOperation() const;
+
+    /** @brief Get the failed calls of the operations, by operation name,
+     * then by error class name, e.g. "NotAllowed"
+     */
+    std::map<std::string, std::map<std::string, uint64_t>>
+        errorsByOperation() const;
+
+    /** @brief Get the latency buckets of the operations, by operation name;
+     * see latencyBucket()
+     */
+    std::map<std::string, std::vector<uint64_t>> latencyByOperation() const;
+
+    /** @brief Get the total duration of the calls of the operations, in
+     * microseconds, by operation name
+     */
+    std::map<std::string, uint64_t> durationByOperation() const;
+
+    /** @brief Get the counters, by name, e.g. "bytesRead" */
+    std::map<std::string, uint64_t> countersByName() const;
+
+    /** @brief Render the metrics in the Prometheus text exposition format;
+     * every sample is labeled with the endpoint, if set
+     */
+    std::string toPrometheus() const;
+
+    /** @brief Log the metrics of the operations called to the journal */
+    void log() const;
+
+    /** @brief Set the file the metrics are exported to after every
+     * operation, for the node exporter textfile collector
+     *  @param[in] path - Path of the file; empty to not export.
+     */
+    void setExportPath(const std::filesystem::path& path);
+
+    /** @brief Write the metrics to the export file, if any */
+    void exportFile() const;
+
+    /** @brief Set the endpoint label of the samples, so that the series of
+     * the instances are told apart
+     *  @param[in] objectPath - Object path of the endpoint's manager.
+     */
+    void setEndpoint(const std::string& objectPath);
+
+  private:
+    struct OperationMetrics
+    {
+        std::atomic<uint64_t> calls;
+        std::atomic<uint64_t> totalMicroseconds;
+        std::array<std::atomic<uint64_t>, errorClassCount> errors;
+        std::array<std::atomic<uint64_t>, bucketCount + 1> buckets;
+    };
+
+    std::array<OperationMetrics, operationCount> operations{};
+    std::array<std::atomic<uint64_t>, counterCount> counters{};
+    std::filesystem::path exportPath;
+    std::string endpoint;
+};
+
+/** @brief Get the registry of the process */
+Registry& registry();
+
+/** @brief Add to a counter of the registry of the process */
+inline void count(Counter counter, uint64_t value = 1) noexcept
+{
+    registry().count(counter, value);
+}
+
+/** @brief Get the class of an error thrown by an operation */
+ErrorClass classify(const std::exception_ptr& error);
+
+/** @class Timer
+ *  @brief Record the call of an operation when going out of scope
+ *  @details A call left by an exception counts as failed, with the class
+ *  given to fail(), ErrorClass::other otherwise.
+ */
+class Timer
+{
+  public:
+    Timer() = delete;
+    Timer(const Timer&) = delete;
+    Timer& operator=(const Timer&) = delete;
+    Timer(Timer&&) = delete;
+    Timer& operator=(Timer&&) = delete;
+
+    explicit Timer(Operation operation) :
+        operation(operation), start(std::chrono::steady_clock::now()),
+        exceptions(std::uncaught_exceptions())
+    {}
+
+    ~Timer()
+    {
+        if (!error && std::uncaught_exceptions() > exceptions)
+        {
+            error = ErrorClass::other;
+        }
+        registry().record(operation,
+                          std::chrono::steady_clock::now() - start, error);
+    }
+
+    /** @brief Record the call as failed with |errorClass| */
+    void fail(ErrorClass errorClass)
+    {
+        error = errorClass;
+    }
+
+  private:
+    Operation operation;
+    std::chrono::steady_clock::time_point start;
+    int exceptions;
+    std::optional<ErrorClass> error;
+};
+
+/** @brief Run |function| as |operation|, recording how long it takes and the
+ * class of the error it fails with
+ */
+template <typename Function>
+auto measure(Operation operation, Function&& function)
+{
+    Timer timer(operation);
+    try
+    {
+        return std::forward<Function>(function)();
+    }
+    catch (...)
+    {
+        timer.fail(classify(std::current_exception()));
+        throw;
+    }
+}
+
+} // namespace phosphor::certs::metrics
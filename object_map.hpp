@@ -0,0 +1,291 @@
+#pragma once
+
+#include "memory_usage.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <set>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+
+namespace phosphor::certs
+{
+
+/** @class ObjectMap
+ *  @brief Objects keyed by their object ID, e.g. the certificates of an
+ *  endpoint: a hash map for the lookups, and the IDs in a sorted set for
+ *  the enumeration in ascending ID order.
+ *  @details Finding and erasing, by ID or through an iterator, are O(1) on
+ *  average, so that deleting one of thousands of secure boot signatures
+ *  doesn't walk a tree; inserting is O(log n) in the sorted set. Elements
+ *  don't move once inserted: iterators and references stay valid until
+ *  their element is erased. The interface is the subset of std::map the
+ *  managers use.
+ */
+template <typename T>
+class ObjectMap
+{
+    template <bool Const>
+    class Iterator;
+
+  public:
+    using key_type = uint64_t;
+    using mapped_type = std::unique_ptr<T>;
+    using value_type = std::pair<const uint64_t, std::unique_ptr<T>>;
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    ObjectMap() = default;
+    ObjectMap(const ObjectMap&) = delete;
+    ObjectMap& operator=(const ObjectMap&) = delete;
+    ObjectMap(ObjectMap&&) = default;
+    ObjectMap& operator=(ObjectMap&&) = default;
+    ~ObjectMap() = default;
+
+    iterator begin()
+    {
+        return {&slots, ids.begin()};
+    }
+    iterator end()
+    {
+        return {&slots, ids.end()};
+    }
+    const_iterator begin() const
+    {
+        return {&slots, ids.begin()};
+    }
+    const_iterator end() const
+    {
+        return {&slots, ids.end()};
+    }
+    reverse_iterator rbegin()
+    {
+        return reverse_iterator(end());
+    }
+    reverse_iterator rend()
+    {
+        return reverse_iterator(begin());
+    }
+    const_reverse_iterator rbegin() const
+    {
+        return const_reverse_iterator(end());
+    }
+    const_reverse_iterator rend() const
+    {
+        return const_reverse_iterator(begin());
+    }
+
+    size_t size() const
+    {
+        return slots.size();
+    }
+
+    bool empty() const
+    {
+        return slots.empty();
+    }
+
+    /** @brief Estimate the heap memory of the map, without the objects */
+    size_t memoryUsage() const
+    {
+        return hashTableSize(slots) + treeSize(ids);
+    }
+
+    bool contains(uint64_t id) const
+    {
+        return slots.contains(id);
+    }
+
+    /** @brief Find an object
+     *  @return Its iterator, end() if there is none with the ID.
+     */
+    iterator find(uint64_t id)
+    {
+        auto it = slots.find(id);
+        return it != slots.end() ? iterator(&slots, it->second.position)
+                                 : end();
+    }
+    const_iterator find(uint64_t id) const
+    {
+        auto it = slots.find(id);
+        return it != slots.end() ? const_iterator(&slots, it->second.position)
+                                 : end();
+    }
+
+    /** @brief Get an object
+     *  @throws std::out_of_range if there is none with the ID.
+     */
+    std::unique_ptr<T>& at(uint64_t id)
+    {
+        return slots.at(id).entry.second;
+    }
+    const std::unique_ptr<T>& at(uint64_t id) const
+    {
+        return slots.at(id).entry.second;
+    }
+
+    /** @brief Insert an object, unless there is one with the ID already
+     *  @return The iterator of the object with the ID, and whether |object|
+     *  was inserted.
+     */
+    std::pair<iterator, bool> emplace(uint64_t id, std::unique_ptr<T> object)
+    {
+        if (auto it = slots.find(id); it != slots.end())
+        {
+            return {iterator(&slots, it->second.position), false};
+        }
+        auto position = ids.insert(id).first;
+        slots.emplace(id, Slot{value_type(id, std::move(object)), position});
+        return {iterator(&slots, position), true};
+    }
+
+    /** @brief Erase an object
+     *  @details The object is destroyed once it is out of the map.
+     *  @return The iterator following it.
+     */
+    iterator erase(const_iterator it)
+    {
+        auto next = std::next(it.position);
+        auto node = slots.extract(*it.position);
+        ids.erase(it.position);
+        return {&slots, next};
+    }
+
+    /** @brief Erase the object with an ID, if any
+     *  @return The number of objects erased.
+     */
+    size_t erase(uint64_t id)
+    {
+        auto it = find(id);
+        if (it == end())
+        {
+            return 0;
+        }
+        erase(it);
+        return 1;
+    }
+
+    /** @brief Erase all the objects; they are destroyed once the map is
+     *  empty
+     */
+    void clear()
+    {
+        auto objects = std::move(slots);
+        slots.clear();
+        ids.clear();
+    }
+
+    /** @brief Move the objects of |other| whose ID isn't in the map, as
+     *  std::map::merge() does
+     */
+    void merge(ObjectMap& other)
+    {
+        for (auto it = other.begin(); it != other.end();)
+        {
+            if (contains(it->first))
+            {
+                ++it;
+                continue;
+            }
+            emplace(it->first, std::move(it->second));
+            it = other.erase(it);
+        }
+    }
+
+  private:
+    struct Slot
+    {
+        value_type entry;
+        /** @brief The ID in |ids| */
+        std::set<uint64_t>::const_iterator position;
+    };
+
+    template <bool Const>
+    class Iterator
+    {
+      public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = ObjectMap::value_type;
+        using difference_type = std::ptrdiff_t;
+        using pointer =
+            std::conditional_t<Const, const value_type*, value_type*>;
+        using reference =
+            std::conditional_t<Const, const value_type&, value_type&>;
+
+        Iterator() = default;
+
+        /** @brief An iterator converts to a const_iterator */
+        template <bool OtherConst>
+            requires(Const && !OtherConst)
+        Iterator(const Iterator<OtherConst>& other) :
+            slots(other.slots), position(other.position)
+        {}
+
+        reference operator*() const
+        {
+            return slots->find(*position)->second.entry;
+        }
+
+        pointer operator->() const
+        {
+            return &**this;
+        }
+
+        Iterator& operator++()
+        {
+            ++position;
+            return *this;
+        }
+
+        Iterator operator++(int)
+        {
+            auto previous = *this;
+            ++position;
+            return previous;
+        }
+
+        Iterator& operator--()
+        {
+            --position;
+            return *this;
+        }
+
+        Iterator operator--(int)
+        {
+            auto previous = *this;
+            --position;
+            return previous;
+        }
+
+        bool operator==(const Iterator& other) const
+        {
+            return position == other.position;
+        }
+
+      private:
+        friend class ObjectMap;
+        template <bool>
+        friend class Iterator;
+
+        using Slots =
+            std::conditional_t<Const, const std::unordered_map<uint64_t, Slot>,
+                               std::unordered_map<uint64_t, Slot>>;
+
+        Iterator(Slots* slots, std::set<uint64_t>::const_iterator position) :
+            slots(slots), position(position)
+        {}
+
+        Slots* slots = nullptr;
+        std::set<uint64_t>::const_iterator position;
+    };
+
+    std::unordered_map<uint64_t, Slot> slots;
+    std::set<uint64_t> ids;
+};
+
+} // namespace phosphor::certs
@@ -0,0 +1,85 @@
+#include "revocation_index.hpp"
+
+#include "memory_usage.hpp"
+
+#include <algorithm>
+#include <ranges>
+
+namespace phosphor::certs
+{
+
+void RevocationIndex::set(const std::string& issuer,
+                          std::vector<std::string> serialNumbers)
+{
+    std::sort(serialNumbers.begin(), serialNumbers.end());
+    serialNumbers.erase(
+        std::unique(serialNumbers.begin(), serialNumbers.end()),
+        serialNumbers.end());
+
+    SerialNumbers entry;
+    size_t bytes = 0;
+    for (const auto& serialNumber : serialNumbers)
+    {
+        bytes += serialNumber.size();
+    }
+    entry.data.reserve(bytes);
+    entry.offsets.reserve(serialNumbers.size() + 1);
+    for (const auto& serialNumber : serialNumbers)
+    {
+        entry.offsets.push_back(static_cast<uint32_t>(entry.data.size()));
+        entry.data += serialNumber;
+    }
+    entry.offsets.push_back(static_cast<uint32_t>(entry.data.size()));
+    issuers.insert_or_assign(issuer, std::move(entry));
+}
+
+void RevocationIndex::erase(const std::string& issuer)
+{
+    issuers.erase(issuer);
+}
+
+void RevocationIndex::clear()
+{
+    issuers.clear();
+}
+
+bool RevocationIndex::isRevoked(const std::string& issuer,
+                                std::string_view serialNumber) const
+{
+    auto it = issuers.find(issuer);
+    if (it == issuers.end())
+    {
+        return false;
+    }
+    const auto& [data, offsets] = it->second;
+    auto at = [&](size_t i) {
+        return std::string_view(data).substr(offsets[i],
+                                             offsets[i + 1] - offsets[i]);
+    };
+    auto indices = std::views::iota(size_t{0}, offsets.size() - 1);
+    auto found = std::ranges::lower_bound(indices, serialNumber, {}, at);
+    return found != indices.end() && at(*found) == serialNumber;
+}
+
+size_t RevocationIndex::size() const
+{
+    size_t count = 0;
+    for (const auto& [issuer, serialNumbers] : issuers)
+    {
+        count += serialNumbers.offsets.size() - 1;
+    }
+    return count;
+}
+
+size_t RevocationIndex::memoryUsage() const
+{
+    size_t bytes = hashTableSize(issuers);
+    for (const auto& [issuer, serialNumbers] : issuers)
+    {
+        bytes += heapSize(issuer) + heapSize(serialNumbers.data) +
+                 serialNumbers.offsets.capacity() * sizeof(uint32_t);
+    }
+    return bytes;
+}
+
+} // namespace phosphor::certs
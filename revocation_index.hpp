@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace phosphor::certs
+{
+
+/** @class RevocationIndex
+ *  @brief Serial numbers revoked by each issuer, as listed by its latest CRL.
+ *  @details Issuers are names as the Issuer property renders them, serial
+ *  numbers the bytes getSerialNumberBytes() returns. The serial numbers of
+ *  an issuer are kept sorted in a single buffer, with their offsets: a few
+ *  bytes of overhead each, so that CRLs of hundreds of thousands of entries
+ *  stay compact. A lookup is O(log n) in the number of serial numbers of the
+ *  issuer; setting the list of an issuer O(n log n).
+ */
+class RevocationIndex
+{
+  public:
+    /** @brief Set the revoked serial numbers of an issuer, replacing those
+     *  of its previous CRL
+     *  @param[in] issuer - Issuer of the CRL.
+     *  @param[in] serialNumbers - Serial numbers, in any order.
+     */
+    void set(const std::string& issuer, std::vector<std::string> serialNumbers);
+
+    /** @brief Remove an issuer; removing an unknown issuer is a no-op */
+    void erase(const std::string& issuer);
+
+    /** @brief Remove all the issuers */
+    void clear();
+
+    /** @brief Tell if an issuer has a CRL */
+    bool contains(const std::string& issuer) const
+    {
+        return issuers.contains(issuer);
+    }
+
+    /** @brief Tell if a serial number is revoked by its issuer */
+    bool isRevoked(const std::string& issuer,
+                   std::string_view serialNumber) const;
+
+    /** @brief Number of revoked serial numbers, all issuers included */
+    size_t size() const;
+
+    /** @brief Estimate the heap memory of the index */
+    size_t memoryUsage() const;
+
+  private:
+    struct SerialNumbers
+    {
+        /** @brief The serial numbers, sorted, one after the other */
+        std::string data;
+        /** @brief Offset of each serial number in |data|, then the size of
+         *  |data|
+         */
+        std::vector<uint32_t> offsets;
+    };
+
+    std::unordered_map<std::string, SerialNumbers> issuers;
+};
+
+} // namespace phosphor::certs
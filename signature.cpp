@@ -2,7 +2,9 @@
 
 #include "signature.hpp"
 
+#include "memory_usage.hpp"
 #include "signature_manager.hpp"
+#include "startup_trace.hpp"
 
 #include <cereal/archives/binary.hpp>
 #include <cereal/types/string.hpp>
@@ -26,6 +28,8 @@
 // From cereal documentation;
 // "This macro should be placed at global scope"
 CEREAL_CLASS_VERSION(phosphor::certs::Signature, classVersion);
+// SignatureData shares the on-disk layout of Signature
+CEREAL_CLASS_VERSION(phosphor::certs::SignatureData, classVersion);
 
 namespace phosphor::certs
 {
@@ -82,19 +86,35 @@ void load(Archive& archive, Signature& signature,
     signature.format(signature.convertSignatureFormatFromString(sigFormat));
 }
 
+/** @brief Function required by Cereal to perform deserialization.
+ *
+ *  @tparam Archive - Cereal archive type (binary in our case).
+ *  @param[in] archive - reference to cereal archive.
+ *  @param[out] data - Signature file content to be read
+ *  @param[in] version - Class version that enables handling a serialized data
+ *                       across code levels
+ */
+template <class Archive>
+void load(Archive& archive, SignatureData& data,
+          const std::uint32_t /*version*/)
+{
+    std::string sigFormat{};
+
+    archive(data.signatureString, sigFormat);
+
+    data.format = Signature::convertSignatureFormatFromString(sigFormat);
+}
+
 Signature::Signature(sdbusplus::bus::bus& bus, const std::string& objPath,
-                     CertificateType type, const std::string& installPath,
-                     SigManager& parent, const std::string sigString,
+                     uint64_t id, CertificateType type,
+                     const std::string& installPath, SigManager& parent,
+                     const std::string sigString,
                      const SignatureFormat sigFormat) :
     SignatureInterface(bus, objPath.c_str(),
                        SignatureInterface::action::defer_emit),
-    objectPath(objPath), certType(type), signatureInstallPath(installPath),
+    objectId(id), certType(type), signatureInstallPath(intern(installPath)),
     manager(parent)
 {
-    // Generate signature file path
-    signatureFilePath = signatureInstallPath + "/" +
-                        fs::path(objectPath).filename().c_str();
-
     loadFromFile();
 
     if (!sigString.empty())
@@ -107,13 +127,46 @@ Signature::Signature(sdbusplus::bus::bus& bus, const std::string& objPath,
         format(sigFormat);
     }
 
-    ownerIntf = std::make_unique<internal::UefiSignatureOwnerIntf>(
-        bus, objectPath, signatureFilePath + ".owner");
+    createOwner(bus, objPath);
     this->emit_object_added();
 }
 
+Signature::Signature(sdbusplus::bus::bus& bus, const std::string& objPath,
+                     uint64_t id, CertificateType type,
+                     const std::string& installPath, SigManager& parent,
+                     const SignatureData& data) :
+    SignatureInterface(bus, objPath.c_str(),
+                       SignatureInterface::action::defer_emit),
+    objectId(id), certType(type), signatureInstallPath(intern(installPath)),
+    manager(parent)
+{
+    // The content comes from the file itself, so it is not saved back
+    SignatureInterface::signatureString(data.signatureString, true);
+    SignatureInterface::format(data.format, true);
+    manager.indexSignature(objectId, data.signatureString);
+
+    createOwner(bus, objPath);
+}
+
+Signature::~Signature()
+{
+    manager.unindexSignature(objectId);
+}
+
+void Signature::createOwner(sdbusplus::bus::bus& bus,
+                            const std::string& objPath)
+{
+    ownerIntf = std::make_unique<internal::UefiSignatureOwnerIntf>(
+        bus, objPath, getFilePath() + ".owner",
+        [this](const std::string& owner) {
+        manager.indexOwner(objectId, owner);
+    });
+    manager.indexOwner(objectId, ownerIntf->uuid());
+}
+
 void Signature::deleteFile()
 {
+    auto signatureFilePath = getFilePath();
     if (!fs::remove(signatureFilePath))
     {
         log<level::INFO>("Signature file not found!",
@@ -128,6 +181,7 @@ bool Signature::isSame(const std::string& sigString)
 
 void Signature::loadFromFile()
 {
+    auto signatureFilePath = getFilePath();
     if (!signatureFilePath.empty())
     {
         try
@@ -150,8 +204,30 @@ void Signature::loadFromFile()
     }
 }
 
+SignatureData Signature::readFile(const std::string& filePath)
+{
+    trace::Span span("readSignature");
+    span.arg("file", filePath);
+    SignatureData data;
+    try
+    {
+        std::ifstream is(filePath.c_str(), std::ios::in | std::ios::binary);
+        cereal::BinaryInputArchive iarchive(is);
+        iarchive(data);
+    }
+    catch (const std::exception& e)
+    {
+        log<level::ERR>("Failed to load signature",
+                        entry("PATH=%s", filePath.c_str()),
+                        entry("ERR=%s", e.what()));
+        elog<InternalFailure>();
+    }
+    return data;
+}
+
 void Signature::saveToFile()
 {
+    auto signatureFilePath = getFilePath();
     if (!signatureFilePath.empty())
     {
         try
@@ -179,6 +255,7 @@ std::string Signature::signatureString(std::string val)
 {
     auto ret = SignatureInterface::signatureString(val);
     saveToFile();
+    manager.indexSignature(objectId, ret);
     return ret;
 }
 
@@ -191,7 +268,28 @@ SignatureFormat Signature::format(SignatureFormat val)
 
 std::string Signature::getObjectPath() const
 {
-    return objectPath;
+    return manager.getObjectPath() + "/signature/" + std::to_string(objectId);
+}
+
+uint64_t Signature::getObjectId() const
+{
+    return objectId;
+}
+
+std::string Signature::getFilePath() const
+{
+    return *signatureInstallPath + '/' + std::to_string(objectId);
+}
+
+size_t Signature::memoryUsage() const
+{
+    size_t bytes = sizeof(*this) +
+                   heapSize(SignatureInterface::signatureString());
+    if (ownerIntf)
+    {
+        bytes += sizeof(*ownerIntf) + heapSize(ownerIntf->uuid());
+    }
+    return bytes;
 }
 
 } // namespace phosphor::certs
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "certificate.hpp"
+#include "interned_string.hpp"
 #include "uefiSignatureOwnerIntf.hpp"
 
 #include <phosphor-logging/elog.hpp>
@@ -8,6 +9,8 @@
 #include <xyz/openbmc_project/BIOSConfig/SecureBootDatabase/Signature/server.hpp>
 #include <xyz/openbmc_project/Object/Delete/server.hpp>
 
+#include <cstddef>
+#include <cstdint>
 #include <filesystem>
 #include <functional>
 #include <memory>
@@ -29,6 +32,13 @@ using SignatureFormat = sdbusplus::xyz::openbmc_project::BIOSConfig::
 
 class SigManager; // Forward declaration for Signature Manager.
 
+/** @brief Content of a stored signature file */
+struct SignatureData
+{
+    std::string signatureString;
+    SignatureFormat format = SignatureFormat::Unspecified;
+};
+
 /** @class Signature
  *  @brief OpenBMC Signature entry implementation.
  */
@@ -47,17 +57,38 @@ class Signature : public SignatureInterface
     /** @brief Constructor for the Signature Object
      *  @param[in] bus - Bus to attach to.
      *  @param[in] objPath - Object path to attach to
+     *  @param[in] id - ID of the signature, the last element of |objPath|
      *  @param[in] type - Type of the certificate
      *  @param[in] installPath - Path of the signature to install
      *  @param[in] parent - The manager that owns the signature
      *  @param[in] sigString - SignatrueString value
      *  @param[in] sigFormat - Formate enum of signature
      */
-    Signature(sdbusplus::bus::bus& bus, const std::string& objPath,
+    Signature(sdbusplus::bus::bus& bus, const std::string& objPath, uint64_t id,
               CertificateType type, const std::string& installPath,
               SigManager& parent, const std::string sigString = "",
               const SignatureFormat sigFormat = SignatureFormat::Unspecified);
 
+    /** @brief Constructor for the Signature Object; a variant for the restore
+     * path where the stored file was already read by readFile()
+     *  @param[in] bus - Bus to attach to.
+     *  @param[in] objPath - Object path to attach to
+     *  @param[in] id - ID of the signature, the last element of |objPath|
+     *  @param[in] type - Type of the certificate
+     *  @param[in] installPath - Path of the signature to install
+     *  @param[in] parent - The manager that owns the signature
+     *  @param[in] data - Content of the stored signature file
+     *
+     *  InterfacesAdded is not emitted; see SigManager::createSignatures().
+     */
+    Signature(sdbusplus::bus::bus& bus, const std::string& objPath, uint64_t id,
+              CertificateType type, const std::string& installPath,
+              SigManager& parent, const SignatureData& data);
+
+    /** @brief Destructor; removes the signature from the manager indexes
+     */
+    ~Signature() override;
+
     /** @brief Delete signature file
      */
     void deleteFile();
@@ -77,6 +108,16 @@ class Signature : public SignatureInterface
      */
     void loadFromFile();
 
+    /**
+     * @brief Read a stored signature file. No D-Bus state is touched, so it
+     * is safe to call from worker threads.
+     *
+     * @param[in] filePath - Signature file path.
+     *
+     * @return Content of the signature file.
+     */
+    static SignatureData readFile(const std::string& filePath);
+
     /**
      * @brief Save signature to file.
      */
@@ -104,24 +145,49 @@ class Signature : public SignatureInterface
      */
     std::string getObjectPath() const;
 
+    /**
+     * @brief Get the ID the object path was built from
+     *
+     * @return Object ID.
+     */
+    uint64_t getObjectId() const;
+
+    /**
+     * @brief Get the signature file path, derived from the install path and
+     * the object ID
+     *
+     * @return Signature file path.
+     */
+    std::string getFilePath() const;
+
+    /**
+     * @brief Estimate the memory used by the object, the heap memory it owns
+     * included.
+     *
+     * @return Size in bytes.
+     */
+    size_t memoryUsage() const;
+
   private:
-    /** @brief object path */
-    std::string objectPath;
+    /** @brief ID of the object, see SigManager::allocId() */
+    uint64_t objectId;
 
     /** @brief Type of the certificate / signature */
     [[maybe_unused]] CertificateType certType;
 
-    /** @brief Stores signature file path */
-    std::string signatureFilePath;
-
-    /** @brief Signature file installation path */
-    std::string signatureInstallPath;
+    /** @brief Signature file installation path, shared by the whole
+     * collection
+     */
+    InternedString signatureInstallPath;
 
     /** @brief Reference to Signature Manager */
     SigManager& manager;
 
     /** @brief Interface of UefiSignatureOwner */
     std::unique_ptr<internal::UefiSignatureOwnerIntf> ownerIntf;
+
+    /** @brief Create |ownerIntf|, and index the owner and its changes */
+    void createOwner(sdbusplus::bus::bus& bus, const std::string& objPath);
 };
 
 } // namespace phosphor::certs
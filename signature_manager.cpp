@@ -2,12 +2,18 @@
 
 #include "signature_manager.hpp"
 
+#include "dbus_query.hpp"
+#include "metrics.hpp"
+#include "tracepoints.hpp"
+#include "worker_pool.hpp"
+
 #include <phosphor-logging/elog-errors.hpp>
 #include <phosphor-logging/elog.hpp>
 #include <phosphor-logging/log.hpp>
 #include <sdbusplus/bus.hpp>
 #include <sdbusplus/exception.hpp>
 #include <sdbusplus/message.hpp>
+#include <sdbusplus/vtable.hpp>
 #include <sdeventplus/source/base.hpp>
 #include <sdeventplus/source/child.hpp>
 #include <xyz/openbmc_project/Certs/error.hpp>
@@ -22,6 +28,7 @@
 #include <cstdlib>
 #include <cstring>
 #include <exception>
+#include <map>
 #include <utility>
 
 namespace phosphor::certs
@@ -47,6 +54,34 @@ using ::sdbusplus::xyz::openbmc_project::Common::Error::InvalidArgument;
 using Argument =
     ::phosphor::logging::xyz::openbmc_project::Common::InvalidArgument;
 
+/** @brief Handler of the FindBySignature method of signatureQueryInterface */
+int handleFindBySignature(sd_bus_message* msg, void* context,
+                          sd_bus_error* error)
+{
+    const auto* manager = static_cast<const SigManager*>(context);
+    return replyToQuery<std::string>(
+        msg, error, [manager](const std::string& sigString) {
+        return manager->findBySignature(sigString);
+    });
+}
+
+/** @brief Handler of the FindByOwner method of signatureQueryInterface */
+int handleFindByOwner(sd_bus_message* msg, void* context, sd_bus_error* error)
+{
+    const auto* manager = static_cast<const SigManager*>(context);
+    return replyToQuery<std::string>(
+        msg, error, [manager](const std::string& owner) {
+        return manager->findByOwner(owner);
+    });
+}
+
+const sdbusplus::vtable_t queryVtable[] = {
+    sdbusplus::vtable::start(),
+    sdbusplus::vtable::method("FindBySignature", "s", "ao",
+                              handleFindBySignature),
+    sdbusplus::vtable::method("FindByOwner", "s", "ao", handleFindByOwner),
+    sdbusplus::vtable::end()};
+
 } // namespace
 
 SigManager::SigManager(sdbusplus::bus::bus& bus, sdeventplus::Event& event,
@@ -56,6 +91,8 @@ SigManager::SigManager(sdbusplus::bus::bus& bus, sdeventplus::Event& event,
     bus(bus), event(event), objectPath(path), certType(type),
     sigInstallPath(std::move(installPath))
 {
+    queryIntf = std::make_unique<sdbusplus::server::interface_t>(
+        bus, objectPath.c_str(), signatureQueryInterface, queryVtable, this);
     try
     {
         // Create signature directory if not existing.
@@ -94,12 +131,20 @@ SigManager::SigManager(sdbusplus::bus::bus& bus, sdeventplus::Event& event,
 SigManager::~SigManager()
 {
     installedSignatures.clear();
-    sigIdUnused.clear();
-    sigIdCounter = 1;
+    sigIds.reset();
 }
 
 std::string SigManager::add(const std::string sigString,
                             const SignatureFormat format)
+{
+    CERTS_PROBE(signature_add_entry, objectPath.c_str(), sigString.size());
+    CERTS_PROBE_RETURN(signature_add_return, objectPath.c_str());
+    return metrics::measure(metrics::Operation::addSignature,
+                            [&] { return addSignature(sigString, format); });
+}
+
+std::string SigManager::addSignature(const std::string& sigString,
+                                     SignatureFormat format)
 {
     std::string sigObjectPath;
     if (isSignatureUnique(sigString))
@@ -109,9 +154,10 @@ std::string SigManager::add(const std::string sigString,
                         std::to_string(signatureId);
         try
         {
-            installedSignatures.emplace_back(std::make_unique<Signature>(
-                bus, sigObjectPath, certType, sigInstallPath, *this, sigString,
-                format));
+            installedSignatures.emplace(
+                signatureId, std::make_unique<Signature>(
+                                 bus, sigObjectPath, signatureId, certType,
+                                 sigInstallPath, *this, sigString, format));
         }
         catch (const std::exception& ex)
         {
@@ -133,26 +179,20 @@ void SigManager::deleteAll()
     for (auto it = installedSignatures.begin(); it != installedSignatures.end();
          it++)
     {
-        (*it)->deleteFile();
+        it->second->deleteFile();
     }
     installedSignatures.clear();
-    sigIdUnused.clear();
-    sigIdCounter = 1;
+    sigIds.reset();
 }
 
 void SigManager::deleteSignature(const Signature* const signature)
 {
-    const std::vector<std::unique_ptr<Signature>>::iterator& sigIt =
-        std::find_if(installedSignatures.begin(), installedSignatures.end(),
-                     [signature](const std::unique_ptr<Signature>& sig) {
-        return (sig.get() == signature);
-    });
-    if (sigIt != installedSignatures.end())
+    auto sigIt = installedSignatures.find(signature->getObjectId());
+    if (sigIt != installedSignatures.end() &&
+        sigIt->second.get() == signature)
     {
-        auto signatureId =
-            std::stoull(fs::path(signature->getObjectPath()).filename());
-        releaseId(signatureId);
-        (*sigIt)->deleteFile();
+        releaseId(sigIt->first);
+        sigIt->second->deleteFile();
         installedSignatures.erase(sigIt);
     }
     else
@@ -163,11 +203,30 @@ void SigManager::deleteSignature(const Signature* const signature)
     }
 }
 
-std::vector<std::unique_ptr<Signature>>& SigManager::getSignatures()
+SignatureMap& SigManager::getSignatures()
 {
     return installedSignatures;
 }
 
+const std::string& SigManager::getObjectPath() const
+{
+    return objectPath;
+}
+
+MemoryUsage SigManager::memoryUsage() const
+{
+    MemoryUsage usage;
+    for (const auto& [signatureId, signature] : installedSignatures)
+    {
+        usage.objects++;
+        usage.bytes += signature->memoryUsage();
+    }
+    usage.indexBytes = signatureIndex.memoryUsage() +
+                       ownerIndex.memoryUsage() +
+                       installedSignatures.memoryUsage();
+    return usage;
+}
+
 void SigManager::createSignatures()
 {
     auto sigObjectPath = objectPath + "/signature/";
@@ -181,64 +240,114 @@ void SigManager::createSignatures()
         return;
     }
 
+    // Assume here any regular file without extenstion name located in
+    // signature directory contains signature body.
+    std::map<uint64_t, std::string> sigFilesById;
     for (auto& path : fs::directory_iterator(sigInstallPath))
     {
         try
         {
-            // Assume here any regular file without extenstion name located in
-            // signature directory contains signature body.
-            if (fs::is_regular_file(path))
+            if (fs::is_regular_file(path) && path.path().extension().empty())
             {
-                if (!path.path().extension().empty())
-                {
-                    continue;
-                }
-                auto signatureId = std::stoull(path.path().filename());
-                allocId(signatureId);
-                try
-                {
-                    installedSignatures.emplace_back(
-                        std::make_unique<Signature>(
-                            bus, sigObjectPath + std::to_string(signatureId),
-                            certType, sigInstallPath, *this));
-                }
-                catch (const std::exception& ex)
-                {
-                    log<level::ERR>("Error in signature constructor",
-                                    entry("ERROR_STR=%s", ex.what()));
-                    releaseId(signatureId);
-                }
+                auto signatureId =
+                    allocId(std::stoull(path.path().filename()));
+                sigFilesById.emplace(signatureId, path.path());
             }
         }
-        catch (const InternalFailure& e)
+        catch (const std::logic_error& e)
         {
+            // Not a decimal ID, or one out of the ID range
             report<InternalFailure>();
         }
-        catch (const InvalidCertificate& e)
+    }
+    std::vector<uint64_t> sigIdList;
+    std::vector<std::string> sigFiles;
+    for (const auto& [signatureId, path] : sigFilesById)
+    {
+        sigIdList.emplace_back(signatureId);
+        sigFiles.emplace_back(path);
+    }
+
+    // Read concurrently, publish in order. This only runs from the
+    // constructor, before the service owns its bus name, so InterfacesAdded
+    // is not emitted; clients enumerate the objects with GetManagedObjects.
+    auto loaded = parallelMap(sigFiles, maxRestoreWorkers,
+                              &Signature::readFile);
+    for (size_t i = 0; i < sigFiles.size(); ++i)
+    {
+        auto signatureId = sigIdList[i];
+        try
         {
-            report<InvalidCertificate>(InvalidCertificateReason(
-                "Existing certificate file is corrupted"));
+            if (loaded[i].error)
+            {
+                std::rethrow_exception(loaded[i].error);
+            }
+            installedSignatures.emplace(
+                signatureId,
+                std::make_unique<Signature>(
+                    bus, sigObjectPath + std::to_string(signatureId),
+                    signatureId, certType, sigInstallPath, *this,
+                    *loaded[i].value));
         }
-        catch (const std::invalid_argument& e)
+        catch (const std::exception& ex)
         {
-            report<InternalFailure>();
+            log<level::ERR>("Error in signature constructor",
+                            entry("ERROR_STR=%s", ex.what()));
+            releaseId(signatureId);
         }
     }
 }
 
 bool SigManager::isSignatureUnique(const std::string& sigString)
 {
-    if (std::any_of(installedSignatures.begin(), installedSignatures.end(),
-                    [&sigString](const std::unique_ptr<Signature>& sig) {
-        return sig->isSame(sigString);
-    }))
+    return findBySignature(sigString).empty();
+}
+
+std::vector<std::string>
+    SigManager::findBySignature(const std::string& sigString) const
+{
+    std::vector<std::string> paths;
+    for (auto signatureId :
+         signatureIndex.find(std::hash<std::string>{}(sigString)))
     {
-        return false;
+        if (auto it = installedSignatures.find(signatureId);
+            it != installedSignatures.end() && it->second->isSame(sigString))
+        {
+            paths.emplace_back(it->second->getObjectPath());
+        }
     }
-    else
+    return paths;
+}
+
+std::vector<std::string>
+    SigManager::findByOwner(const std::string& owner) const
+{
+    std::vector<std::string> paths;
+    for (auto signatureId : ownerIndex.find(owner))
     {
-        return true;
+        if (auto it = installedSignatures.find(signatureId);
+            it != installedSignatures.end())
+        {
+            paths.emplace_back(it->second->getObjectPath());
+        }
     }
+    return paths;
+}
+
+void SigManager::indexSignature(uint64_t id, const std::string& sigString)
+{
+    signatureIndex.set(id, std::hash<std::string>{}(sigString));
+}
+
+void SigManager::indexOwner(uint64_t id, const std::string& owner)
+{
+    ownerIndex.set(id, owner);
+}
+
+void SigManager::unindexSignature(uint64_t id)
+{
+    signatureIndex.erase(id);
+    ownerIndex.erase(id);
 }
 
 uint64_t SigManager::allocId(uint64_t id)
@@ -246,31 +355,16 @@ uint64_t SigManager::allocId(uint64_t id)
     // Have designated ID
     if (id != 0)
     {
-        // Update the Unused IDs
-        for (; sigIdCounter <= id; sigIdCounter++)
-        {
-            sigIdUnused.insert(sigIdCounter);
-        }
-        sigIdUnused.erase(id);
-        return id;
+        return sigIds.reserve(id);
     }
 
     // No designated ID
-    if (!sigIdUnused.empty())
-    {
-        id = *sigIdUnused.begin();
-        sigIdUnused.erase(id);
-        return id;
-    }
-    else
-    {
-        return sigIdCounter++;
-    }
+    return sigIds.allocate();
 }
 
 void SigManager::releaseId(uint64_t id)
 {
-    sigIdUnused.insert(id);
+    sigIds.release(id);
 }
 
 } // namespace phosphor::certs
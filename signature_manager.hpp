@@ -1,10 +1,16 @@
 #pragma once
 
+#include "id_allocator.hpp"
+#include "key_index.hpp"
+#include "memory_usage.hpp"
+#include "object_map.hpp"
 #include "signature.hpp"
 
+#include <sdbusplus/server/interface.hpp>
 #include <sdbusplus/server/object.hpp>
 #include <xyz/openbmc_project/BIOSConfig/SecureBootDatabase/AddSignature/server.hpp>
 
+#include <cstddef>
 #include <cstdint>
 #include <filesystem>
 #include <memory>
@@ -21,6 +27,9 @@ using sigManagerInterface =
                                     SecureBootDatabase::server::AddSignature>;
 }
 
+/** @brief Signatures keyed by their object ID, in ascending ID order */
+using SignatureMap = ObjectMap<Signature>;
+
 class SigManager : public internal::sigManagerInterface
 {
   public:
@@ -75,7 +84,54 @@ class SigManager : public internal::sigManagerInterface
      *
      *  @return Reference to signatures' collection
      */
-    std::vector<std::unique_ptr<Signature>>& getSignatures();
+    SignatureMap& getSignatures();
+
+    /** @brief Get the object path of the collection
+     *
+     *  @return Object path.
+     */
+    const std::string& getObjectPath() const;
+
+    /** @brief Find the signature with a content; the FindBySignature
+     *  method of signatureQueryInterface
+     *
+     *  @param[in] sigString - Content of the signature.
+     *
+     *  @return Object paths of the signatures, by ascending ID.
+     */
+    std::vector<std::string>
+        findBySignature(const std::string& sigString) const;
+
+    /** @brief Find the signatures of an owner; the FindByOwner method of
+     *  signatureQueryInterface
+     *
+     *  @param[in] owner - Owner GUID, as the UUID property holds it.
+     *
+     *  @return Object paths of the signatures, by ascending ID.
+     */
+    std::vector<std::string> findByOwner(const std::string& owner) const;
+
+    /** @brief Add a signature to the content index, or update it; called as
+     *  the content is set
+     */
+    void indexSignature(uint64_t id, const std::string& sigString);
+
+    /** @brief Add a signature to the owner index, or update it; called as
+     *  the owner is set
+     */
+    void indexOwner(uint64_t id, const std::string& owner);
+
+    /** @brief Remove a signature from the indexes; called as the signature
+     *  is destroyed
+     */
+    void unindexSignature(uint64_t id);
+
+    /** @brief Estimate the memory used by the signatures
+     *
+     *  @return Number of signatures, their estimated size and that of their
+     *  indexes.
+     */
+    MemoryUsage memoryUsage() const;
 
   private:
     /** @brief Load signature
@@ -83,6 +139,14 @@ class SigManager : public internal::sigManagerInterface
      */
     void createSignatures();
 
+    /** @brief Add a signature; see add()
+     *  @param[in] sigString - The string of for the signature.
+     *  @param[in] format - The format of the signature.
+     *  @return Signature object path.
+     */
+    std::string addSignature(const std::string& sigString,
+                             SignatureFormat format);
+
     /** @brief Check if provided signature is unique across all signatures
      * on the internal list.
      *  @param[in] SignatureString - The string of for the signature for
@@ -118,13 +182,20 @@ class SigManager : public internal::sigManagerInterface
     /** @brief Signature file installation path **/
     std::string sigInstallPath;
 
+    /** @brief Signatures by hash of their content, which may collide, and
+     * by owner. They outlive |installedSignatures|, whose signatures remove
+     * themselves from them.
+     */
+    KeyIndex<size_t> signatureIndex;
+    KeyIndex<std::string> ownerIndex;
+
     /** @brief Collection of pointers to signature */
-    std::vector<std::unique_ptr<Signature>> installedSignatures;
+    SignatureMap installedSignatures;
 
     /** @brief Signature ID pool */
-    uint64_t sigIdCounter = 1;
+    IdAllocator sigIds;
 
-    /** @brief Unused Signature ID pool */
-    std::set<uint64_t> sigIdUnused;
+    /** @brief The signatureQueryInterface of the collection */
+    std::unique_ptr<sdbusplus::server::interface_t> queryIntf;
 };
 } // namespace phosphor::certs
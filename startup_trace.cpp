@@ -0,0 +1,225 @@
+#include "startup_trace.hpp"
+
+#include "file_content.hpp"
+
+#include <unistd.h>
+
+#include <phosphor-logging/lg2.hpp>
+
+#include <atomic>
+#include <cstdio>
+#include <filesystem>
+#include <mutex>
+#include <string_view>
+
+namespace phosphor::certs::trace
+{
+
+namespace
+{
+
+namespace fs = std::filesystem;
+
+struct Event
+{
+    const char* name;
+    pid_t thread;
+    int64_t timestamp;
+    int64_t duration;
+    /** @brief Members of the args object, JSON encoded */
+    std::string args;
+};
+
+struct Recorder
+{
+    std::mutex mutex;
+    std::string output;
+    std::string processName;
+    std::vector<Event> events;
+};
+
+std::atomic<bool> recording{false};
+
+Recorder& recorder()
+{
+    static Recorder instance;
+    return instance;
+}
+
+/** @brief Monotonic timestamp in microseconds, as Chrome traces expect; the
+ * clock is shared by all the endpoints, so their traces can be merged
+ */
+int64_t toMicroseconds(std::chrono::steady_clock::time_point time)
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               time.time_since_epoch())
+        .count();
+}
+
+std::string quote(std::string_view value)
+{
+    std::string quoted = "\"";
+    for (char c : value)
+    {
+        switch (c)
+        {
+            case '"':
+                quoted += "\\\"";
+                break;
+            case '\\':
+                quoted += "\\\\";
+                break;
+            case '\n':
+                quoted += "\\n";
+                break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20)
+                {
+                    char escaped[7];
+                    std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                    quoted += escaped;
+                }
+                else
+                {
+                    quoted += c;
+                }
+        }
+    }
+    quoted += '"';
+    return quoted;
+}
+
+std::string toJson(const std::string& processName,
+                   const std::vector<Event>& events)
+{
+    std::string pid = std::to_string(getpid());
+    std::string json = "{\"traceEvents\":[\n";
+    json += "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" + pid +
+            ",\"tid\":" + pid + ",\"args\":{\"name\":" + quote(processName) +
+            "}}";
+    for (const auto& event : events)
+    {
+        json += ",\n{\"name\":" + quote(event.name) +
+                ",\"cat\":\"startup\",\"ph\":\"X\",\"ts\":" +
+                std::to_string(event.timestamp) +
+                ",\"dur\":" + std::to_string(event.duration) +
+                ",\"pid\":" + pid +
+                ",\"tid\":" + std::to_string(event.thread) + ",\"args\":{" +
+                event.args + "}}";
+    }
+    json += "\n],\"displayTimeUnit\":\"ms\"}\n";
+    return json;
+}
+
+void writeFile(const fs::path& path, const std::string& json)
+{
+    try
+    {
+        writeFileAtomically(path, json);
+    }
+    catch (const std::exception& e)
+    {
+        lg2::error("Failed to write the startup trace, ERR:{ERR}, FILE:{FILE}",
+                   "ERR", e, "FILE", path);
+    }
+}
+
+} // namespace
+
+void start(const std::string& output, const std::string& processName)
+{
+    Recorder& r = recorder();
+    std::lock_guard lock(r.mutex);
+    r.output = output;
+    r.processName = processName;
+    r.events.clear();
+    recording.store(true, std::memory_order_relaxed);
+}
+
+bool enabled() noexcept
+{
+    return recording.load(std::memory_order_relaxed);
+}
+
+void finish()
+{
+    Recorder& r = recorder();
+    std::vector<Event> events;
+    {
+        std::lock_guard lock(r.mutex);
+        if (!recording.exchange(false, std::memory_order_relaxed))
+        {
+            return;
+        }
+        events.swap(r.events);
+    }
+
+    if (r.output != journalOutput)
+    {
+        writeFile(r.output, toJson(r.processName, events));
+        return;
+    }
+    for (const auto& event : events)
+    {
+        lg2::info("Startup trace, PROCESS:{PROCESS}, EVENT:{EVENT}, "
+                  "START_US:{START_US}, DURATION_US:{DURATION_US}, "
+                  "THREAD:{THREAD}, ARGS:{ARGS}",
+                  "PROCESS", r.processName, "EVENT", event.name, "START_US",
+                  event.timestamp, "DURATION_US", event.duration, "THREAD",
+                  event.thread, "ARGS", event.args);
+    }
+}
+
+Span::Span(const char* name) : name(name), active(enabled())
+{
+    if (active)
+    {
+        begin = std::chrono::steady_clock::now();
+    }
+}
+
+void Span::arg(const char* key, const std::string& value)
+{
+    if (active)
+    {
+        args.emplace_back(key, quote(value));
+    }
+}
+
+void Span::arg(const char* key, uint64_t value)
+{
+    if (active)
+    {
+        args.emplace_back(key, std::to_string(value));
+    }
+}
+
+void Span::end()
+{
+    if (!active)
+    {
+        return;
+    }
+    active = false;
+    auto now = std::chrono::steady_clock::now();
+    Event event{name, gettid(), toMicroseconds(begin),
+                toMicroseconds(now) - toMicroseconds(begin), {}};
+    for (const auto& [key, value] : args)
+    {
+        if (!event.args.empty())
+        {
+            event.args += ',';
+        }
+        event.args += quote(key) + ':' + value;
+    }
+
+    Recorder& r = recorder();
+    std::lock_guard lock(r.mutex);
+    // The recording may have finished since the span began
+    if (enabled())
+    {
+        r.events.emplace_back(std::move(event));
+    }
+}
+
+} // namespace phosphor::certs::trace
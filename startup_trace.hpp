@@ -0,0 +1,73 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace phosphor::certs::trace
+{
+
+/** @brief Output of start() writing the events to the journal */
+inline constexpr char journalOutput[] = "journal";
+
+/** @brief Start recording the startup timeline
+ *  @param[in] output - Chrome trace JSON file to write the events to, or
+ *  journalOutput to log them.
+ *  @param[in] processName - Name of the process in the trace, e.g. the
+ *  endpoint.
+ */
+void start(const std::string& output, const std::string& processName);
+
+/** @brief Whether the startup timeline is being recorded */
+bool enabled() noexcept;
+
+/** @brief Write the recorded events and stop recording
+ *  @details A no-op if nothing is being recorded.
+ */
+void finish();
+
+/** @class Span
+ *  @brief Record a phase of the startup, from construction to end() or
+ *  destruction, as a Chrome trace complete event.
+ *  @details Costs a relaxed atomic load when not recording. Spans can be
+ *  recorded from any thread.
+ */
+class Span
+{
+  public:
+    Span() = delete;
+    Span(const Span&) = delete;
+    Span& operator=(const Span&) = delete;
+    Span(Span&&) = delete;
+    Span& operator=(Span&&) = delete;
+
+    /** @brief Constructor
+     *  @param[in] name - Name of the phase; a string literal.
+     */
+    explicit Span(const char* name);
+
+    ~Span()
+    {
+        end();
+    }
+
+    /** @brief Attach an argument to the event, e.g. the file restored */
+    void arg(const char* key, const std::string& value);
+
+    /** @brief Attach a numeric argument to the event, e.g. a file size */
+    void arg(const char* key, uint64_t value);
+
+    /** @brief Record the event now rather than at destruction */
+    void end();
+
+  private:
+    const char* name;
+    bool active;
+    std::chrono::steady_clock::time_point begin;
+    /** @brief Arguments, with their values JSON encoded */
+    std::vector<std::pair<const char*, std::string>> args;
+};
+
+} // namespace phosphor::certs::trace
@@ -106,6 +106,63 @@ TEST(Path, MissPathThrows)
                                      "abc",    "--unit", "ghi"};
     EXPECT_NE(processArguments(argv.size(), argv.data(), arguments), 0);
 }
+
+TEST(StorageFormat, DefaultsToPem)
+{
+    Arguments arguments;
+    std::vector<const char*> argv = {"binary", "--type", "authority",
+                                     "--endpoint", "abc", "--path", "def"};
+    EXPECT_EQ(processArguments(argv.size(), argv.data(), arguments), 0);
+    EXPECT_EQ(arguments.format, "pem");
+}
+
+TEST(StorageFormat, Der)
+{
+    Arguments arguments;
+    std::vector<const char*> argv = {
+        "binary", "--type", "authority",        "--endpoint", "abc",
+        "--path", "def",    "--storage-format", "der"};
+    EXPECT_EQ(processArguments(argv.size(), argv.data(), arguments), 0);
+    EXPECT_EQ(arguments.format, "der");
+}
+
+TEST(StorageFormat, WrongFormatThrows)
+{
+    Arguments arguments;
+    std::vector<const char*> argv = {
+        "binary", "--type", "authority",        "--endpoint", "abc",
+        "--path", "def",    "--storage-format", "base64"};
+    EXPECT_NE(processArguments(argv.size(), argv.data(), arguments), 0);
+}
+
+TEST(MetricsFile, DefaultsToNone)
+{
+    Arguments arguments;
+    std::vector<const char*> argv = {"binary", "--type", "authority",
+                                     "--endpoint", "abc", "--path", "def"};
+    EXPECT_EQ(processArguments(argv.size(), argv.data(), arguments), 0);
+    EXPECT_TRUE(arguments.metricsFile.empty());
+}
+
+TEST(MetricsFile, Path)
+{
+    Arguments arguments;
+    std::vector<const char*> argv = {
+        "binary", "--type", "authority",      "--endpoint",        "abc",
+        "--path", "def",    "--metrics-file", "/run/metrics.prom"};
+    EXPECT_EQ(processArguments(argv.size(), argv.data(), arguments), 0);
+    EXPECT_EQ(arguments.metricsFile, "/run/metrics.prom");
+}
+
+TEST(StartupTrace, Journal)
+{
+    Arguments arguments;
+    std::vector<const char*> argv = {
+        "binary", "--type", "authority",       "--endpoint", "abc",
+        "--path", "def",    "--startup-trace", "journal"};
+    EXPECT_EQ(processArguments(argv.size(), argv.data(), arguments), 0);
+    EXPECT_EQ(arguments.startupTrace, "journal");
+}
 } // namespace
 
 } // namespace phosphor::certs
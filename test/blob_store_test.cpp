@@ -0,0 +1,136 @@
+#include "blob_store.hpp"
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <new>
+#include <string>
+
+#include <gtest/gtest.h>
+
+namespace phosphor::certs
+{
+namespace
+{
+
+namespace fs = std::filesystem;
+
+class BlobStoreTest : public ::testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        char dirTemplate[] = "/tmp/FakeCerts.XXXXXX";
+        auto dirPtr = mkdtemp(dirTemplate);
+        if (dirPtr == nullptr)
+        {
+            throw std::bad_alloc();
+        }
+        dir = dirPtr;
+        fs::create_directories(dir / "authority");
+        fs::create_directories(dir / "ldap");
+    }
+
+    void TearDown() override
+    {
+        fs::remove_all(dir);
+    }
+
+    static std::string readFile(const fs::path& path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        return {std::istreambuf_iterator<char>(file),
+                std::istreambuf_iterator<char>()};
+    }
+
+    fs::path dir;
+};
+
+TEST_F(BlobStoreTest, CreatesPrivateDirectory)
+{
+    BlobStore store(dir / "blobs");
+    EXPECT_TRUE(fs::is_directory(dir / "blobs"));
+    EXPECT_EQ(fs::status(dir / "blobs").permissions(),
+              fs::perms::owner_read | fs::perms::owner_write |
+                  fs::perms::owner_exec);
+}
+
+TEST_F(BlobStoreTest, SharesIdenticalFiles)
+{
+    BlobStore store(dir / "blobs");
+    std::string authority = dir / "authority" / "cert";
+    std::string ldap = dir / "ldap" / "cert";
+    ASSERT_TRUE(store.link("abcd.pem", "content", authority));
+    ASSERT_TRUE(store.link("abcd.pem", "content", ldap));
+
+    EXPECT_TRUE(fs::equivalent(authority, ldap));
+    EXPECT_TRUE(fs::equivalent(authority, dir / "blobs" / "abcd.pem"));
+    EXPECT_EQ(fs::hard_link_count(authority), 3U);
+    EXPECT_EQ(readFile(ldap), "content");
+}
+
+TEST_F(BlobStoreTest, LinkIsIdempotent)
+{
+    BlobStore store(dir / "blobs");
+    std::string authority = dir / "authority" / "cert";
+    ASSERT_TRUE(store.link("abcd.pem", "content", authority));
+    EXPECT_TRUE(store.link("abcd.pem", "content", authority));
+    EXPECT_EQ(fs::hard_link_count(authority), 2U);
+    EXPECT_FALSE(fs::exists(authority + ".tmp"));
+}
+
+TEST_F(BlobStoreTest, ReplacesPrivateCopy)
+{
+    BlobStore store(dir / "blobs");
+    std::string authority = dir / "authority" / "cert";
+    std::ofstream(authority) << "old content";
+    ASSERT_TRUE(store.link("abcd.pem", "content", authority));
+    EXPECT_EQ(readFile(authority), "content");
+    EXPECT_EQ(fs::hard_link_count(authority), 2U);
+}
+
+TEST_F(BlobStoreTest, CollectsUnusedBlobs)
+{
+    BlobStore store(dir / "blobs");
+    std::string authority = dir / "authority" / "cert";
+    std::string ldap = dir / "ldap" / "cert";
+    ASSERT_TRUE(store.link("abcd.pem", "content", authority));
+    ASSERT_TRUE(store.link("abcd.pem", "content", ldap));
+    ASSERT_TRUE(store.link("ef01.pem", "other", dir / "ldap" / "other"));
+    std::ofstream(dir / "blobs" / "ef01.pem.1234.tmp") << "partial";
+
+    fs::remove(authority);
+    fs::remove(dir / "ldap" / "other");
+    store.collectGarbage();
+    EXPECT_TRUE(fs::exists(dir / "blobs" / "abcd.pem"));
+    EXPECT_FALSE(fs::exists(dir / "blobs" / "ef01.pem"));
+    // Blobs being written by another endpoint are left alone
+    EXPECT_TRUE(fs::exists(dir / "blobs" / "ef01.pem.1234.tmp"));
+
+    fs::remove(ldap);
+    store.collectGarbage();
+    EXPECT_FALSE(fs::exists(dir / "blobs" / "abcd.pem"));
+}
+
+TEST_F(BlobStoreTest, RecreatesCollectedBlob)
+{
+    BlobStore store(dir / "blobs");
+    std::string authority = dir / "authority" / "cert";
+    ASSERT_TRUE(store.link("abcd.pem", "content", authority));
+    fs::remove(authority);
+    store.collectGarbage();
+    ASSERT_FALSE(fs::exists(dir / "blobs" / "abcd.pem"));
+
+    ASSERT_TRUE(store.link("abcd.pem", "content", authority));
+    EXPECT_EQ(readFile(dir / "blobs" / "abcd.pem"), "content");
+}
+
+TEST_F(BlobStoreTest, FailsWithoutEndpointDirectory)
+{
+    BlobStore store(dir / "blobs");
+    EXPECT_FALSE(store.link("abcd.pem", "content", dir / "missing" / "cert"));
+}
+
+} // namespace
+} // namespace phosphor::certs
@@ -2,8 +2,10 @@
 
 #include "certificate.hpp"
 #include "certs_manager.hpp"
+#include "corpus.hpp"
 #include "csr.hpp"
 #include "lsp.hpp"
+#include "x509_utils.hpp"
 
 #include <openssl/bio.h>
 #include <openssl/ossl_typ.h>
@@ -17,15 +19,19 @@
 #include <xyz/openbmc_project/Certs/error.hpp>
 #include <xyz/openbmc_project/Common/error.hpp>
 
+#include <chrono>
 #include <cstdint>
 #include <cstdio>
 #include <cstdlib>
+#include <ctime>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
 #include <iterator>
+#include <map>
 #include <memory>
 #include <new>
+#include <optional>
 #include <string>
 #include <unordered_set>
 #include <utility>
@@ -94,7 +100,6 @@ class TestCertificates : public ::testing::Test
         fs::remove(certificateFile);
         fs::remove(CSRFile);
         fs::remove(privateKeyFile);
-        fs::remove_all("demoCA");
     }
 
     void eventLoop(uint8_t numberOfTimes)
@@ -118,52 +123,28 @@ class TestCertificates : public ::testing::Test
         CSRFile = "domain.csr";
         privateKeyFile = "privkey.pem";
         rsaPrivateKeyFilePath = certDir + "/.rsaprivkey.pem";
-        std::string cmd = "openssl req -x509 -sha256 -newkey rsa:3072 ";
-        cmd += "-keyout cert.pem -out cert.pem -days 365000 -nodes";
-        cmd += " -subj /O=openbmc-project.xyz/CN=localhost";
+        std::string commonName = "localhost";
 
         if (setNewCertId)
         {
-            cmd += std::to_string(certId++);
+            commonName += std::to_string(certId++);
         }
 
-        auto val = std::system(cmd.c_str());
-        if (val)
-        {
-            std::cout << "COMMAND Error: " << val << std::endl;
-        }
+        corpus::writeFile(
+            certificateFile,
+            generator.root(commonName, corpus::KeyType::rsa3072), true);
     }
 
     void createNeverExpiredRootCertificate()
     {
-        // remove the old cert
-        fs::remove(certificateFile);
-
-        // The following routines create a cert that has NotBefore
-        // set to 1970/01/01 and NotAfter set to 9999/12/31 via the
-        // OpenSSL CA application.
+        // Create a cert that has NotBefore set to 1970/01/01 and NotAfter
+        // set to 9999/12/31, issued by a CA
         certificateFile = "cert.pem";
-        ASSERT_EQ(std::system("mkdir -p demoCA"), 0);
-        ASSERT_EQ(std::system("mkdir -p demoCA/private/"), 0);
-        ASSERT_EQ(std::system("mkdir -p demoCA/newcerts/"), 0);
-        ASSERT_EQ(std::system("touch demoCA/index.txt"), 0);
-        ASSERT_EQ(std::system("echo 1000 > demoCA/serial"), 0);
-        ASSERT_EQ(
-            std::system(
-                "openssl req -x509 -sha256 -newkey rsa:3072 -keyout "
-                "demoCA/private/cakey.pem -out demoCA/cacert.pem -nodes "
-                "-subj /O=openbmc-project.xyz/C=US/ST=CA/CN=localhost-ca"),
-            0);
-        ASSERT_EQ(std::system(
-                      "openssl req -new -newkey rsa:3072 -nodes -keyout "
-                      "demoCA/server.key -out demoCA/server.csr -subj "
-                      "/O=openbmc-project.xyz/C=US/ST=CA/CN=localhost-server"),
-                  0);
-        ASSERT_EQ(
-            std::system(
-                "openssl ca -batch -startdate 19700101000000Z -enddate "
-                "99991231235959Z -out cert.pem -infiles demoCA/server.csr"),
-            0);
+        auto ca = generator.root("localhost-ca", corpus::KeyType::rsa3072);
+        corpus::writeFile(certificateFile,
+                          generator.leaf(ca, "localhost-server",
+                                         corpus::KeyType::rsa3072,
+                                         corpus::forever));
     }
 
     bool compareFiles(const std::string& file1, const std::string& file2)
@@ -224,6 +205,7 @@ class TestCertificates : public ::testing::Test
 
     std::string certDir;
     uint64_t certId = 1;
+    corpus::Generator generator;
 };
 
 class MainApp
@@ -272,8 +254,9 @@ class ManagerInTest : public phosphor::certs::Manager
         "xyz.openbmc_project.awesome-service";
     ManagerInTest(sdbusplus::bus_t& bus, sdeventplus::Event& event,
                   const char* path, CertificateType type,
-                  const std::string& unit, const std::string& installPath) :
-        Manager(bus, event, path, type, unit, installPath)
+                  const std::string& unit, const std::string& installPath,
+                  StorageFormat format = StorageFormat::pem) :
+        Manager(bus, event, path, type, unit, installPath, format)
     {}
 
     MOCK_METHOD(void, reloadOrReset, (const std::string&), (override));
@@ -351,15 +334,15 @@ TEST_F(TestCertificates, InvokeAuthorityInstall)
     // later
     mainApp.install(certificateFile);
 
-    std::vector<std::unique_ptr<Certificate>>& certs =
-        manager.getCertificates();
+    CertificateMap& certs = manager.getCertificates();
 
     ASSERT_EQ(certs.size(), 1);
+    const auto& cert = certs.begin()->second;
     // check some attributes as well
-    EXPECT_EQ(certs.front()->validNotAfter() - certs.front()->validNotBefore(),
+    EXPECT_EQ(cert->validNotAfter() - cert->validNotBefore(),
               365000ULL * 24 * 3600);
-    EXPECT_EQ(certs.front()->subject(), "O=openbmc-project.xyz,CN=localhost");
-    EXPECT_EQ(certs.front()->issuer(), "O=openbmc-project.xyz,CN=localhost");
+    EXPECT_EQ(cert->subject(), "O=openbmc-project.xyz,CN=localhost");
+    EXPECT_EQ(cert->issuer(), "O=openbmc-project.xyz,CN=localhost");
 
     std::string verifyPath = verifyDir + "/" +
                              getCertSubjectNameHash(certificateFile) + ".0";
@@ -397,11 +380,10 @@ TEST_F(TestCertificates, InvokeAuthorityInstallNeverExpiredRootCert)
     createNeverExpiredRootCertificate();
     mainApp.install(certificateFile);
 
-    std::vector<std::unique_ptr<Certificate>>& certs =
-        manager.getCertificates();
+    CertificateMap& certs = manager.getCertificates();
 
-    EXPECT_EQ(certs.front()->validNotBefore(), 0);
-    EXPECT_EQ(certs.front()->validNotAfter(), 253402300799ULL);
+    EXPECT_EQ(certs.begin()->second->validNotBefore(), 0);
+    EXPECT_EQ(certs.begin()->second->validNotAfter(), 253402300799ULL);
 
     std::string verifyPath = verifyDir + "/" +
                              getCertSubjectNameHash(certificateFile) + ".0";
@@ -437,8 +419,7 @@ TEST_F(TestCertificates, InvokeInstallSameCertTwice)
     MainApp mainApp(&manager);
     mainApp.install(certificateFile);
 
-    std::vector<std::unique_ptr<Certificate>>& certs =
-        manager.getCertificates();
+    CertificateMap& certs = manager.getCertificates();
 
     EXPECT_FALSE(certs.empty());
 
@@ -496,8 +477,7 @@ TEST_F(TestCertificates, InvokeInstallSameSubjectTwice)
     MainApp mainApp(&manager);
     mainApp.install(certificateFile);
 
-    std::vector<std::unique_ptr<Certificate>>& certs =
-        manager.getCertificates();
+    CertificateMap& certs = manager.getCertificates();
 
     EXPECT_FALSE(certs.empty());
 
@@ -554,8 +534,7 @@ TEST_F(TestCertificates, InvokeInstallAuthCertLimit)
         .WillRepeatedly(Return());
     MainApp mainApp(&manager);
 
-    std::vector<std::unique_ptr<Certificate>>& certs =
-        manager.getCertificates();
+    CertificateMap& certs = manager.getCertificates();
 
     std::vector<std::string> verifyPaths;
 
@@ -695,11 +674,10 @@ TEST_F(TestCertificates, TestReplaceCertificate)
     MainApp mainApp(&manager);
     mainApp.install(certificateFile);
     EXPECT_TRUE(fs::exists(verifyPath));
-    std::vector<std::unique_ptr<Certificate>>& certs =
-        manager.getCertificates();
+    CertificateMap& certs = manager.getCertificates();
     EXPECT_FALSE(certs.empty());
-    EXPECT_NE(certs[0], nullptr);
-    certs[0]->replace(certificateFile);
+    EXPECT_NE(certs.begin()->second, nullptr);
+    certs.begin()->second->replace(certificateFile);
     EXPECT_TRUE(fs::exists(verifyPath));
     // Process D-Bus calls
     eventLoop(5);
@@ -728,8 +706,7 @@ TEST_F(TestCertificates, TestAuthorityReplaceCertificate)
     mainApp.install(certificateFile);
     // Process D-Bus calls
     eventLoop(3);
-    std::vector<std::unique_ptr<Certificate>>& certs =
-        manager.getCertificates();
+    CertificateMap& certs = manager.getCertificates();
 
     for (unsigned int i = 0; i < replaceIterations; i++)
     {
@@ -749,7 +726,7 @@ TEST_F(TestCertificates, TestAuthorityReplaceCertificate)
         // Create new certificate
         createNewCertificate(true);
 
-        certs[0]->replace(certificateFile);
+        certs.begin()->second->replace(certificateFile);
 
         // Verify that old certificate has been removed
         EXPECT_FALSE(fs::exists(verifyPath));
@@ -786,8 +763,7 @@ TEST_F(TestCertificates, TestStorageDeleteCertificate)
     createNewCertificate(true);
     mainApp.install(certificateFile);
 
-    std::vector<std::unique_ptr<Certificate>>& certs =
-        manager.getCertificates();
+    CertificateMap& certs = manager.getCertificates();
 
     // All 3 certificates successfully installed and added to manager
     EXPECT_EQ(certs.size(), 3);
@@ -796,13 +772,13 @@ TEST_F(TestCertificates, TestStorageDeleteCertificate)
     // certificates
     EXPECT_FALSE(fs::is_empty(verifyDir));
 
-    certs[0]->delete_();
+    certs.begin()->second->delete_();
     EXPECT_EQ(certs.size(), 2);
 
-    certs[0]->delete_();
+    certs.begin()->second->delete_();
     EXPECT_EQ(certs.size(), 1);
 
-    certs[0]->delete_();
+    certs.begin()->second->delete_();
     EXPECT_EQ(certs.size(), 0);
 
     // Check if certificate placeholder is empty.
@@ -911,17 +887,14 @@ class TestInvalidCertificate : public ::testing::Test
         fs::create_directories(certDir);
         certificateFile = "cert.pem";
         keyFile = "key.pem";
-        std::string cmd = "openssl req -x509 -sha256 -newkey rsa:3072 ";
-        cmd += "-keyout key.pem -out cert.pem -days 3650 ";
-        cmd += "-subj "
-               "/O=openbmc-project.xyz/CN=localhost"
-               " -nodes";
-
-        auto val = std::system(cmd.c_str());
-        if (val)
-        {
-            std::cout << "command Error: " << val << std::endl;
-        }
+        auto credential = corpus::Generator().root("localhost",
+                                                   corpus::KeyType::rsa3072);
+        corpus::writeFile(certificateFile, credential);
+        std::unique_ptr<BIO, decltype(&::BIO_free)> bio(
+            BIO_new_file(keyFile.c_str(), "w"), ::BIO_free);
+        ASSERT_EQ(PEM_write_bio_PrivateKey(bio.get(), credential.key, nullptr,
+                                           nullptr, 0, nullptr, nullptr),
+                  1);
     }
     void TearDown() override
     {
@@ -1508,6 +1481,63 @@ TEST_F(TestCertificates, TestRSAKeyFromRSAKeyFileIsWrittenIntoPrivateKeyFile)
     EXPECT_TRUE(fs::exists(privateKeyPath));
 }
 
+/** @brief Manager whose events are checked
+ */
+class EventManagerInTest : public ManagerInTest
+{
+  public:
+    using ManagerInTest::ManagerInTest;
+
+    MOCK_METHOD(void, sendCertificateEvent,
+                (phosphor::logging::MESSAGE_TYPE,
+                 phosphor::logging::Entry::Level,
+                 const std::vector<std::string>&, const std::string&),
+                (override));
+    MOCK_METHOD(void, sendExpirySignal,
+                (const std::string&, uint64_t, uint64_t), (override));
+};
+
+/** @brief Check that the events about secure boot certificates carry their
+ * object paths
+ */
+TEST_F(TestCertificates, SecureBootEventPaths)
+{
+    using ::phosphor::logging::MESSAGE_TYPE;
+    using ::testing::_;
+    std::string verifyUnit(ManagerInTest::unitToRestartInTest);
+    std::string objPath = "/xyz/openbmc_project/secureBootDatabase/db";
+    auto event = sdeventplus::Event::get_default();
+    // Attach the bus to sd_event to service user requests
+    bus.attach_event(event.get(), SD_EVENT_PRIORITY_NORMAL);
+    EventManagerInTest manager(bus, event, objPath.c_str(),
+                               CertificateType::securebootDatabase,
+                               verifyUnit, certDir);
+    EXPECT_CALL(manager, reloadOrReset(Eq(ManagerInTest::unitToRestartInTest)))
+        .WillRepeatedly(Return());
+
+    std::string certPath = objPath + "/certs/1";
+    EXPECT_CALL(manager, sendCertificateEvent(MESSAGE_TYPE::RESOURCE_CREATED,
+                                              _, _, certPath))
+        .Times(2);
+    EXPECT_EQ(manager.install(certificateFile), certPath);
+    CertificateMap& certs = manager.getCertificates();
+    ASSERT_EQ(certs.size(), 1);
+    EXPECT_EQ(certs.begin()->second->getObjectPath(), certPath);
+
+    // Replace
+    createNewCertificate(true);
+    certs.begin()->second->replace(certificateFile);
+    EXPECT_EQ(certs.begin()->second->getObjectPath(), certPath);
+
+    // Delete
+    EXPECT_CALL(manager, sendCertificateEvent(MESSAGE_TYPE::RESOURCE_DELETED,
+                                              _, _, certPath));
+    certs.begin()->second->delete_();
+    EXPECT_TRUE(certs.empty());
+    // Process D-Bus calls
+    eventLoop(5);
+}
+
 /** @brief Check RSA key is generated during application startup*/
 TEST_F(TestCertificates, TestGenerateRSAPrivateKeyFile)
 {
@@ -1521,6 +1551,12 @@ TEST_F(TestCertificates, TestGenerateRSAPrivateKeyFile)
 
     EXPECT_FALSE(fs::exists(rsaPrivateKeyFilePath));
     Manager manager(bus, event, objPath.c_str(), type, verifyUnit, installPath);
+    // The key is generated in the background; the event loop handles the
+    // exit of the process generating it
+    for (int i = 0; i < 60 && !fs::exists(rsaPrivateKeyFilePath); i++)
+    {
+        event.run(std::chrono::seconds(1));
+    }
     EXPECT_TRUE(fs::exists(rsaPrivateKeyFilePath));
 }
 
@@ -1557,6 +1593,8 @@ class AuthoritiesListTest : public testing::Test
     ~AuthoritiesListTest() override
     {
         fs::remove_all(authoritiesListFolder);
+        fs::remove_all(authoritiesListFolder.string() + ".crl");
+        fs::remove(authoritiesListFolder.string() + ".expiry");
     }
 
   protected:
@@ -1578,18 +1616,14 @@ class AuthoritiesListTest : public testing::Test
         }
     }
 
-    // Creates a single self-signed root certificate in given |path|; the key
-    // will be |path|/|cn|_key, the cert will be |path|/|cn|_cert, and the cn
-    // will be "/O=openbmc-project.xyz/C=US/ST=CA/CN=|cn|"
-    static void createSingleAuthority(const std::string& path,
-                                      const std::string& cn)
+    // Creates a single self-signed root certificate in given |path|; the cert
+    // will be |path|/|cn|_cert, and the subject "O=openbmc-project.xyz,
+    // CN=|cn|"
+    void createSingleAuthority(const std::string& path, const std::string& cn)
     {
-        std::string key = fs::path(path) / (cn + "_key");
         std::string cert = fs::path(path) / (cn + "_cert");
-        std::string cmd = "openssl req -x509 -sha256 -newkey rsa:2048 -keyout ";
-        cmd += key + " -out " + cert + " -nodes --days 365000 ";
-        cmd += "-subj /O=openbmc-project.xyz/CN=" + cn;
-        ASSERT_EQ(std::system(cmd.c_str()), 0);
+        ASSERT_NO_THROW(corpus::writeFile(
+            cert, generator.root(cn, corpus::KeyType::rsa2048)));
     }
 
     // Appends the content of the |from| file to the |to| file.
@@ -1629,7 +1663,7 @@ class AuthoritiesListTest : public testing::Test
     }
 
     // Verifies the effect of InstallAll or ReplaceAll
-    void verifyCertificates(std::vector<std::unique_ptr<Certificate>>& certs)
+    void verifyCertificates(CertificateMap& certs)
     {
         // The trust bundle file has been copied over
         EXPECT_FALSE(fs::is_empty(authoritiesListFolder));
@@ -1639,16 +1673,18 @@ class AuthoritiesListTest : public testing::Test
 
         ASSERT_EQ(certs.size(), maxNumAuthorityCertificates);
         // Check attributes and alias
-        for (size_t i = 0; i < certs.size(); ++i)
+        size_t i = 0;
+        for (const auto& [id, cert] : certs)
         {
-            std::string name = "root_" + std::to_string(i);
-            EXPECT_EQ(certs[i]->subject(), "O=openbmc-project.xyz,CN=" + name);
-            EXPECT_EQ(certs[i]->issuer(), "O=openbmc-project.xyz,CN=" + name);
+            // IDs are handed out in the list order
+            std::string name = "root_" + std::to_string(i++);
+            EXPECT_EQ(cert->subject(), "O=openbmc-project.xyz,CN=" + name);
+            EXPECT_EQ(cert->issuer(), "O=openbmc-project.xyz,CN=" + name);
             std::string symbolLink =
                 authoritiesListFolder /
-                (certs[i]->getCertId().substr(0, 8) + ".0");
+                (cert->getCertId().substr(0, 8) + ".0");
             ASSERT_TRUE(fs::exists(symbolLink));
-            compareFileAgainstString(symbolLink, certs[i]->certificateString());
+            compareFileAgainstString(symbolLink, cert->certificateString());
         }
     }
 
@@ -1672,6 +1708,7 @@ class AuthoritiesListTest : public testing::Test
     sdbusplus::bus_t bus;
     fs::path authoritiesListFolder;
     fs::path sourceAuthoritiesListFile;
+    corpus::Generator generator;
 };
 
 // Tests that the Authority Manager installs all the certificates in an
@@ -1697,7 +1734,8 @@ TEST_F(AuthoritiesListTest, InstallAll)
         manager.installAll(sourceAuthoritiesListFile);
     for (size_t i = 0; i < manager.getCertificates().size(); ++i)
     {
-        EXPECT_EQ(manager.getCertificates()[i]->getObjectPath(), objects[i]);
+        EXPECT_EQ(manager.getCertificates().at(i + 1)->getObjectPath(),
+                  objects[i]);
     }
     verifyCertificates(manager.getCertificates());
     // process D-Bus calls
@@ -1734,19 +1772,19 @@ TEST_F(AuthoritiesListTest, RecoverAtBootUp)
     // Check attributes and alias
     std::unordered_set<std::string> expectedFiles = {authoritiesListFolder /
                                                      "trust_bundle"};
-    std::vector<std::unique_ptr<Certificate>>& certs =
-        manager.getCertificates();
+    CertificateMap& certs = manager.getCertificates();
     for (size_t i = 0; i < certs.size(); ++i)
     {
+        const auto& cert = certs.at(i + 1);
         std::string name = "root_" + std::to_string(i);
-        EXPECT_EQ(certs[i]->subject(), "O=openbmc-project.xyz,CN=" + name);
-        EXPECT_EQ(certs[i]->issuer(), "O=openbmc-project.xyz,CN=" + name);
+        EXPECT_EQ(cert->subject(), "O=openbmc-project.xyz,CN=" + name);
+        EXPECT_EQ(cert->issuer(), "O=openbmc-project.xyz,CN=" + name);
         std::string symbolLink = authoritiesListFolder /
-                                 (certs[i]->getCertId().substr(0, 8) + ".0");
+                                 (cert->getCertId().substr(0, 8) + ".0");
         expectedFiles.insert(symbolLink);
-        expectedFiles.insert(certs[i]->getCertFilePath());
+        expectedFiles.insert(cert->getCertFilePath());
         ASSERT_TRUE(fs::exists(symbolLink));
-        compareFileAgainstString(symbolLink, certs[i]->certificateString());
+        compareFileAgainstString(symbolLink, cert->certificateString());
     }
 
     // Check folder content
@@ -1938,11 +1976,552 @@ TEST_F(AuthoritiesListTest, ReplaceAll)
         manager.replaceAll(sourceAuthoritiesListFile);
     // process D-Bus calls
     eventLoop(3);
-    for (size_t i = 0; i < manager.getCertificates().size(); ++i)
+    ASSERT_EQ(objects.size(), manager.getCertificates().size());
+    size_t i = 0;
+    for (const auto& [id, cert] : manager.getCertificates())
     {
-        EXPECT_EQ(manager.getCertificates()[i]->getObjectPath(), objects[i]);
+        // The objects of the replaced certificates were still there when
+        // the new ones were created
+        EXPECT_GT(id, maxNumAuthorityCertificates);
+        EXPECT_EQ(cert->getObjectPath(), objects[i++]);
     }
     verifyCertificates(manager.getCertificates());
+    EXPECT_FALSE(fs::exists(authoritiesListFolder.string() + ".staging"));
+}
+
+// Tests that a store exchange interrupted by a power loss is recovered from
+TEST_F(AuthoritiesListTest, RecoverInterruptedExchange)
+{
+    std::string endpoint("truststore");
+    std::string verifyUnit(ManagerInTest::unitToRestartInTest);
+    CertificateType type = CertificateType::authority;
+
+    std::string object = std::string(objectNamePrefix) + '/' +
+                         certificateTypeToString(type) + '/' + endpoint;
+    auto event = sdeventplus::Event::get_default();
+    // Attach the bus to sd_event to service user requests
+    bus.attach_event(event.get(), SD_EVENT_PRIORITY_NORMAL);
+    {
+        ManagerInTest manager(bus, event, object.c_str(), type, verifyUnit,
+                              authoritiesListFolder);
+        EXPECT_CALL(manager, reloadOrReset(Eq(verifyUnit)))
+            .WillOnce(Return());
+        manager.installAll(sourceAuthoritiesListFile);
+        eventLoop(3);
+    }
+
+    // The store was moved aside, the new generation not moved in yet
+    fs::path staging = authoritiesListFolder.string() + ".staging";
+    fs::path retired = staging.string() + ".old";
+    fs::rename(authoritiesListFolder, retired);
+    fs::create_directory(staging);
+    createSingleAuthority(staging, "new_root");
+    {
+        ManagerInTest manager(bus, event, object.c_str(), type, verifyUnit,
+                              authoritiesListFolder);
+        EXPECT_EQ(manager.getCertificates().size(),
+                  maxNumAuthorityCertificates);
+        verifyCertificates(manager.getCertificates());
+        EXPECT_FALSE(fs::exists(staging));
+        EXPECT_FALSE(fs::exists(retired));
+        eventLoop(3);
+    }
+
+    // The new generation was moved in, the old one not moved out
+    fs::create_directory(retired);
+    createSingleAuthority(retired, "old_root");
+    ManagerInTest manager(bus, event, object.c_str(), type, verifyUnit,
+                          authoritiesListFolder);
+    EXPECT_EQ(manager.getCertificates().size(), maxNumAuthorityCertificates);
+    EXPECT_FALSE(fs::exists(retired));
+
+    // Which doesn't get in the way of the next exchange
+    fs::create_directory(retired);
+    EXPECT_CALL(manager, reloadOrReset(Eq(verifyUnit))).WillOnce(Return());
+    manager.replaceAll(sourceAuthoritiesListFile);
+    EXPECT_EQ(manager.getCertificates().size(), maxNumAuthorityCertificates);
+    EXPECT_FALSE(fs::exists(retired));
+    eventLoop(3);
+}
+
+// Tests that ReplaceAll keeps the objects of the certificates in both lists
+TEST_F(AuthoritiesListTest, ReplaceAllKeepsCommonCertificates)
+{
+    std::string endpoint("truststore");
+    std::string verifyUnit(ManagerInTest::unitToRestartInTest);
+    CertificateType type = CertificateType::authority;
+
+    std::string object = std::string(objectNamePrefix) + '/' +
+                         certificateTypeToString(type) + '/' + endpoint;
+
+    auto event = sdeventplus::Event::get_default();
+    // Attach the bus to sd_event to service user requests
+    bus.attach_event(event.get(), SD_EVENT_PRIORITY_NORMAL);
+    ManagerInTest manager(bus, event, object.c_str(), type, verifyUnit,
+                          authoritiesListFolder);
+    // Once per call, the store is never seen empty
+    EXPECT_CALL(manager, reloadOrReset(Eq(ManagerInTest::unitToRestartInTest)))
+        .WillOnce(Return())
+        .WillOnce(Return());
+    manager.installAll(sourceAuthoritiesListFile);
+    CertificateMap& certs = manager.getCertificates();
+    const Certificate* kept = certs.at(2).get();
+    std::string keptFile = kept->getCertFilePath();
+
+    // root_1 and a new root
+    fs::path srcFolder = sourceAuthoritiesListFile.parent_path();
+    createSingleAuthority(srcFolder, "new_root");
+    fs::path list = srcFolder / "list";
+    fs::copy_file(srcFolder / "root_1_cert", list);
+    appendContentFromFile(list, srcFolder / "new_root_cert");
+    std::vector<sdbusplus::message::object_path> objects =
+        manager.replaceAll(list);
+    eventLoop(3);
+
+    ASSERT_EQ(certs.size(), 2U);
+    ASSERT_EQ(objects.size(), 2U);
+    EXPECT_EQ(certs.at(2).get(), kept);
+    EXPECT_EQ(kept->getCertFilePath(), keptFile);
+    EXPECT_TRUE(fs::exists(keptFile));
+    EXPECT_EQ(objects[0], kept->getObjectPath());
+    const auto& [addedId, added] = *certs.rbegin();
+    EXPECT_GT(addedId, maxNumAuthorityCertificates);
+    EXPECT_EQ(added->subject(), "O=openbmc-project.xyz,CN=new_root");
+    EXPECT_TRUE(compareFiles(authoritiesListFolder /
+                                 defaultAuthoritiesListFileName,
+                             list));
+
+    // Only the list, two certificates and their hash links are left
+    size_t files = 0;
+    for (const auto& entry : fs::directory_iterator(authoritiesListFolder))
+    {
+        if (fs::is_symlink(entry.symlink_status()))
+        {
+            ASSERT_TRUE(fs::exists(entry));
+            EXPECT_TRUE(fs::read_symlink(entry).is_relative());
+        }
+        ++files;
+    }
+    EXPECT_EQ(files, 5U);
+    EXPECT_FALSE(fs::exists(authoritiesListFolder.string() + ".staging"));
+
+    // The next replacement reuses the IDs released
+    EXPECT_CALL(manager, reloadOrReset(Eq(ManagerInTest::unitToRestartInTest)))
+        .WillOnce(Return());
+    manager.replaceAll(sourceAuthoritiesListFile);
+    EXPECT_EQ(certs.size(), maxNumAuthorityCertificates);
+    EXPECT_EQ(certs.at(2).get(), kept);
+    EXPECT_TRUE(certs.contains(1));
+    eventLoop(3);
+}
+
+// Tests that the certificates expiring before a time are listed by expiry
+TEST_F(AuthoritiesListTest, ExpiringBefore)
+{
+    std::string endpoint("truststore");
+    std::string verifyUnit(ManagerInTest::unitToRestartInTest);
+    CertificateType type = CertificateType::authority;
+
+    std::string object = std::string(objectNamePrefix) + '/' +
+                         certificateTypeToString(type) + '/' + endpoint;
+    auto event = sdeventplus::Event::get_default();
+    // Attach the bus to sd_event to service user requests
+    bus.attach_event(event.get(), SD_EVENT_PRIORITY_NORMAL);
+    ManagerInTest manager(bus, event, object.c_str(), type, verifyUnit,
+                          authoritiesListFolder);
+    EXPECT_CALL(manager, reloadOrReset(Eq(ManagerInTest::unitToRestartInTest)))
+        .WillOnce(Return())
+        .WillOnce(Return());
+
+    constexpr time_t day = 24 * 60 * 60;
+    time_t now = std::time(nullptr);
+    std::vector<corpus::Credential> authorities;
+    for (time_t days : {100, 10, 50})
+    {
+        authorities.emplace_back(generator.root(
+            "root_" + std::to_string(days), corpus::KeyType::p256,
+            {now - day, now + days * day}));
+    }
+    fs::path list = sourceAuthoritiesListFile.parent_path() / "expiring";
+    corpus::writeFile(list, authorities);
+    std::vector<sdbusplus::message::object_path> objects =
+        manager.installAll(list);
+    ASSERT_EQ(objects.size(), 3U);
+
+    auto expiring = manager.getExpiringBefore(
+        static_cast<uint64_t>(now + 60 * day));
+    EXPECT_EQ(expiring,
+              (std::vector<std::string>{objects[1].str, objects[2].str}));
+    EXPECT_TRUE(manager.getExpiringBefore(static_cast<uint64_t>(now)).empty());
+
+    CertificateMap& certs = manager.getCertificates();
+    manager.deleteCertificate(certs.at(2).get());
+    expiring = manager.getExpiringBefore(
+        static_cast<uint64_t>(now + 60 * day));
+    EXPECT_EQ(expiring, std::vector<std::string>{objects[2].str});
+    eventLoop(3);
+}
+
+// Tests that the certificates entering a warning window or expiring are
+// reported once, restarts included
+TEST_F(AuthoritiesListTest, ExpiryEvents)
+{
+    using ::testing::_;
+    std::string endpoint("truststore");
+    std::string verifyUnit(ManagerInTest::unitToRestartInTest);
+    CertificateType type = CertificateType::authority;
+
+    std::string object = std::string(objectNamePrefix) + '/' +
+                         certificateTypeToString(type) + '/' + endpoint;
+    auto event = sdeventplus::Event::get_default();
+    // Attach the bus to sd_event to service user requests
+    bus.attach_event(event.get(), SD_EVENT_PRIORITY_NORMAL);
+
+    constexpr time_t day = 24 * 60 * 60;
+    time_t now = std::time(nullptr);
+    std::vector<corpus::Credential> authorities;
+    for (time_t days : {100, 10})
+    {
+        authorities.emplace_back(generator.root(
+            "root_" + std::to_string(days), corpus::KeyType::p256,
+            {now - day, now + days * day}));
+    }
+    fs::path list = sourceAuthoritiesListFile.parent_path() / "expiring";
+    corpus::writeFile(list, authorities);
+    std::string expiring;
+    {
+        EventManagerInTest manager(bus, event, object.c_str(), type,
+                                   verifyUnit, authoritiesListFolder);
+        EXPECT_CALL(manager,
+                    reloadOrReset(Eq(ManagerInTest::unitToRestartInTest)))
+            .WillOnce(Return());
+        std::vector<sdbusplus::message::object_path> objects =
+            manager.installAll(list);
+        ASSERT_EQ(objects.size(), 2U);
+        expiring = objects[1].str;
+
+        // Within the 30 days window, not yet the 7 days one
+        EXPECT_CALL(manager, sendExpirySignal(expiring, _, 30)).Times(1);
+        for (int i = 0; i < 5; i++)
+        {
+            event.run(std::chrono::milliseconds(100));
+        }
+        testing::Mock::VerifyAndClearExpectations(&manager);
+    }
+    EXPECT_TRUE(fs::exists(authoritiesListFolder.string() + ".expiry"));
+
+    // The window crossed is not reported again after a restart
+    EventManagerInTest manager(bus, event, object.c_str(), type, verifyUnit,
+                               authoritiesListFolder);
+    EXPECT_CALL(manager, sendCertificateEvent(_, _, _, _)).Times(0);
+    EXPECT_CALL(manager, sendExpirySignal(_, _, _)).Times(0);
+    ASSERT_EQ(manager.getCertificates().size(), 2U);
+    for (int i = 0; i < 5; i++)
+    {
+        event.run(std::chrono::milliseconds(100));
+    }
+}
+
+// Tests that certificates are found by fingerprint, names and serial number
+TEST_F(AuthoritiesListTest, FindCertificates)
+{
+    std::string endpoint("truststore");
+    std::string verifyUnit(ManagerInTest::unitToRestartInTest);
+    CertificateType type = CertificateType::authority;
+
+    std::string object = std::string(objectNamePrefix) + '/' +
+                         certificateTypeToString(type) + '/' + endpoint;
+    auto event = sdeventplus::Event::get_default();
+    // Attach the bus to sd_event to service user requests
+    bus.attach_event(event.get(), SD_EVENT_PRIORITY_NORMAL);
+    ManagerInTest manager(bus, event, object.c_str(), type, verifyUnit,
+                          authoritiesListFolder);
+    EXPECT_CALL(manager, reloadOrReset(Eq(ManagerInTest::unitToRestartInTest)))
+        .WillOnce(Return())
+        .WillOnce(Return());
+    std::vector<sdbusplus::message::object_path> objects =
+        manager.installAll(sourceAuthoritiesListFile);
+    ASSERT_EQ(objects.size(), maxNumAuthorityCertificates);
+
+    auto cert = loadCert(sourceAuthoritiesListFile.parent_path() /
+                         "root_1_cert");
+    std::string name = "O=openbmc-project.xyz,CN=root_1";
+    std::vector<std::string> found{objects[1].str};
+    EXPECT_EQ(manager.findByFingerprint(generateFingerprint(*cert)), found);
+    EXPECT_EQ(manager.findBySubject(name), found);
+    EXPECT_EQ(manager.findByIssuer(name), found);
+    EXPECT_EQ(manager.findBySerialNumber(name, formatSerialNumber(*cert)),
+              found);
+    EXPECT_TRUE(manager.findBySerialNumber("O=openbmc-project.xyz,CN=root_2",
+                                           formatSerialNumber(*cert))
+                    .empty());
+    EXPECT_TRUE(manager.findBySubject("CN=root_1").empty());
+
+    manager.deleteCertificate(manager.getCertificates().at(2).get());
+    EXPECT_TRUE(manager.findBySubject(name).empty());
+    EXPECT_TRUE(manager.findByFingerprint(generateFingerprint(*cert)).empty());
+    eventLoop(3);
+}
+
+TEST_F(AuthoritiesListTest, MemoryUsage)
+{
+    std::string endpoint("truststore");
+    std::string verifyUnit(ManagerInTest::unitToRestartInTest);
+    CertificateType type = CertificateType::authority;
+
+    std::string object = std::string(objectNamePrefix) + '/' +
+                         certificateTypeToString(type) + '/' + endpoint;
+    auto event = sdeventplus::Event::get_default();
+    // Attach the bus to sd_event to service user requests
+    bus.attach_event(event.get(), SD_EVENT_PRIORITY_NORMAL);
+    ManagerInTest manager(bus, event, object.c_str(), type, verifyUnit,
+                          authoritiesListFolder);
+    EXPECT_CALL(manager, reloadOrReset(Eq(ManagerInTest::unitToRestartInTest)))
+        .WillOnce(Return());
+    auto empty = manager.memoryUsage();
+    EXPECT_EQ(empty.certificates.objects, 0);
+    EXPECT_EQ(empty.signatures.objects, 0);
+    EXPECT_GT(empty.residentBytes, 0);
+
+    manager.installAll(sourceAuthoritiesListFile);
+    auto usage = manager.memoryUsage();
+    EXPECT_EQ(usage.certificates.objects, maxNumAuthorityCertificates);
+    EXPECT_GT(usage.certificates.bytes, 0);
+    EXPECT_GT(usage.certificates.indexBytes, empty.certificates.indexBytes);
+    EXPECT_GT(usage.totalBytes, empty.totalBytes);
+    EXPECT_GE(usage.totalBytes,
+              usage.certificates.bytes + usage.certificates.indexBytes);
+    eventLoop(3);
+}
+
+TEST_F(AuthoritiesListTest, CertificateChain)
+{
+    std::string endpoint("truststore");
+    std::string verifyUnit(ManagerInTest::unitToRestartInTest);
+    CertificateType type = CertificateType::authority;
+
+    std::string object = std::string(objectNamePrefix) + '/' +
+                         certificateTypeToString(type) + '/' + endpoint;
+    auto event = sdeventplus::Event::get_default();
+    // Attach the bus to sd_event to service user requests
+    bus.attach_event(event.get(), SD_EVENT_PRIORITY_NORMAL);
+    ManagerInTest manager(bus, event, object.c_str(), type, verifyUnit,
+                          authoritiesListFolder);
+    EXPECT_CALL(manager, reloadOrReset(Eq(ManagerInTest::unitToRestartInTest)))
+        .WillOnce(Return())
+        .WillOnce(Return());
+
+    // Root, intermediate and leaf
+    auto chain = generator.chain(3);
+    fs::path chainFile = sourceAuthoritiesListFile.parent_path() / "chain";
+    ASSERT_NO_THROW(corpus::writeFile(chainFile, chain));
+    std::vector<sdbusplus::message::object_path> objects =
+        manager.installAll(chainFile);
+    ASSERT_EQ(objects.size(), 3);
+
+    std::map<std::string, Certificate*> certificates;
+    for (const auto& [id, cert] : manager.getCertificates())
+    {
+        certificates[cert->getObjectPath()] = cert.get();
+    }
+    Certificate* root = certificates.at(objects[0].str);
+    Certificate* leaf = certificates.at(objects[2].str);
+    auto issuedBy = [](const std::string& issuer) {
+        return AssociationList{{"issued_by", "issued", issuer}};
+    };
+    EXPECT_EQ(leaf->getAssociations(), issuedBy(objects[1].str));
+    EXPECT_EQ(certificates.at(objects[1].str)->getAssociations(),
+              issuedBy(objects[0].str));
+    EXPECT_TRUE(root->getAssociations().empty());
+
+    // Without the intermediate, the leaf has no issuer
+    manager.deleteCertificate(certificates.at(objects[1].str));
+    EXPECT_TRUE(leaf->getAssociations().empty());
+
+    // Until it is installed again
+    fs::path intermediateFile = sourceAuthoritiesListFile.parent_path() /
+                                "intermediate";
+    ASSERT_NO_THROW(corpus::writeFile(intermediateFile, chain[1]));
+    EXPECT_CALL(manager, reloadOrReset(Eq(ManagerInTest::unitToRestartInTest)))
+        .WillOnce(Return());
+    std::string intermediate = manager.install(intermediateFile);
+    EXPECT_EQ(leaf->getAssociations(), issuedBy(intermediate));
+    eventLoop(3);
+}
+
+TEST_F(AuthoritiesListTest, InstallCrl)
+{
+    std::string endpoint("truststore");
+    std::string verifyUnit(ManagerInTest::unitToRestartInTest);
+    CertificateType type = CertificateType::authority;
+
+    std::string object = std::string(objectNamePrefix) + '/' +
+                         certificateTypeToString(type) + '/' + endpoint;
+    auto event = sdeventplus::Event::get_default();
+    // Attach the bus to sd_event to service user requests
+    bus.attach_event(event.get(), SD_EVENT_PRIORITY_NORMAL);
+
+    // Root, intermediate and leaf
+    auto chain = generator.chain(3);
+    fs::path sourceFolder = sourceAuthoritiesListFile.parent_path();
+    fs::path chainFile = sourceFolder / "chain";
+    ASSERT_NO_THROW(corpus::writeFile(chainFile, chain));
+    fs::path crlFile = sourceFolder / "crl";
+    std::string intermediatePath;
+    std::string leafPath;
+    // The revoked certificate is linked to the issuer of the CRL
+    auto expectRevoked = [&](Manager& manager) {
+        for (const auto& [id, cert] : manager.getCertificates())
+        {
+            AssociationList associations = cert->getAssociations();
+            bool revoked = std::find(associations.begin(), associations.end(),
+                                     std::make_tuple(std::string("revoked_by"),
+                                                     std::string("revoked"),
+                                                     intermediatePath)) !=
+                           associations.end();
+            EXPECT_EQ(revoked, cert->getObjectPath() == leafPath);
+        }
+    };
+    {
+        ManagerInTest manager(bus, event, object.c_str(), type, verifyUnit,
+                              authoritiesListFolder);
+        EXPECT_CALL(manager, reloadOrReset(Eq(verifyUnit)))
+            .WillOnce(Return());
+        std::vector<sdbusplus::message::object_path> objects =
+            manager.installAll(chainFile);
+        ASSERT_EQ(objects.size(), 3);
+        intermediatePath = objects[1].str;
+        leafPath = objects[2].str;
+
+        // Same name and issuer as the intermediate, but another key
+        auto impostor = generator.intermediate(
+            chain[0], "intermediate_1", corpus::KeyType::p256, corpus::valid,
+            true);
+        ASSERT_NO_THROW(corpus::writeFile(
+            crlFile, *corpus::revocationList(impostor, {&chain[2]})));
+        EXPECT_THROW(manager.installCrl(crlFile), InvalidCertificate);
+
+        ASSERT_NO_THROW(corpus::writeFile(
+            crlFile, *corpus::revocationList(chain[1], {&chain[2]}, 1000, 1),
+            StorageFormat::der));
+        EXPECT_EQ(manager.installCrl(crlFile),
+                  std::vector<std::string>{leafPath});
+        expectRevoked(manager);
+
+        // Only a newer CRL replaces it
+        EXPECT_THROW(manager.installCrl(crlFile), InvalidCertificate);
+        ASSERT_NO_THROW(corpus::writeFile(
+            crlFile, *corpus::revocationList(chain[1], {&chain[2]}, 0, 2)));
+        EXPECT_EQ(manager.installCrl(crlFile),
+                  std::vector<std::string>{leafPath});
+        eventLoop(3);
+    }
+
+    // The CRLs are stored apart from the authorities, and indexed before
+    // the authorities are restored
+    fs::path crlPath = authoritiesListFolder.string() + ".crl";
+    ASSERT_EQ(std::distance(fs::directory_iterator(crlPath),
+                            fs::directory_iterator()),
+              1);
+    EXPECT_EQ(fs::directory_iterator(crlPath)->path().extension(), ".r0");
+    ManagerInTest manager(bus, event, object.c_str(), type, verifyUnit,
+                          authoritiesListFolder);
+    ASSERT_EQ(manager.getCertificates().size(), 3);
+    expectRevoked(manager);
+
+    // Revoked certificates can't be installed again while the CRL issuer is
+    EXPECT_CALL(manager, reloadOrReset(Eq(verifyUnit)))
+        .Times(3)
+        .WillRepeatedly(Return());
+    fs::path issuersFile = sourceFolder / "issuers";
+    fs::path intermediateFile = sourceFolder / "intermediate";
+    ASSERT_NO_THROW(corpus::writeFile(issuersFile, chain[0]));
+    ASSERT_NO_THROW(corpus::writeFile(intermediateFile, chain[1]));
+    appendContentFromFile(issuersFile, intermediateFile);
+    ASSERT_EQ(manager.replaceAll(issuersFile).size(), 2);
+    EXPECT_THROW(manager.replaceAll(chainFile), InvalidCertificate);
+    EXPECT_EQ(manager.getCertificates().size(), 2);
+
+    // The CRLs go with their issuers
+    manager.deleteAll();
+    EXPECT_EQ(std::distance(fs::directory_iterator(crlPath),
+                            fs::directory_iterator()),
+              0);
+    EXPECT_EQ(manager.installAll(chainFile).size(), 3);
+    eventLoop(3);
+}
+
+// Tests that DER stores keep DER files only, and link PEM renderings
+TEST_F(AuthoritiesListTest, InstallAllDer)
+{
+    std::string endpoint("truststore");
+    std::string verifyUnit(ManagerInTest::unitToRestartInTest);
+    CertificateType type = CertificateType::authority;
+
+    std::string object = std::string(objectNamePrefix) + '/' +
+                         certificateTypeToString(type) + '/' + endpoint;
+    auto event = sdeventplus::Event::get_default();
+    // Attach the bus to sd_event to service user requests
+    bus.attach_event(event.get(), SD_EVENT_PRIORITY_NORMAL);
+    ManagerInTest manager(bus, event, object.c_str(), type, verifyUnit,
+                          authoritiesListFolder, StorageFormat::der);
+    EXPECT_CALL(manager, reloadOrReset(Eq(ManagerInTest::unitToRestartInTest)))
+        .WillOnce(Return());
+    manager.installAll(sourceAuthoritiesListFile);
+
+    EXPECT_EQ(getFileStorageFormat(authoritiesListFolder /
+                                   defaultAuthoritiesListFileName),
+              StorageFormat::der);
+    CertificateMap& certs = manager.getCertificates();
+    ASSERT_EQ(certs.size(), maxNumAuthorityCertificates);
+    for (const auto& [id, cert] : certs)
+    {
+        EXPECT_EQ(getFileStorageFormat(cert->getCertFilePath()),
+                  StorageFormat::der);
+        fs::path symbolLink = authoritiesListFolder /
+                              (cert->getCertId().substr(0, 8) + ".0");
+        ASSERT_TRUE(fs::is_symlink(symbolLink));
+        EXPECT_EQ(fs::read_symlink(symbolLink).parent_path(),
+                  manager.getPemViewPath());
+        compareFileAgainstString(symbolLink, cert->certificateString());
+    }
+    // process D-Bus calls
+    eventLoop(3);
+}
+
+// Tests that a PEM store is converted when the manager stores DER
+TEST_F(AuthoritiesListTest, MigrateToDer)
+{
+    std::string endpoint("truststore");
+    std::string verifyUnit(ManagerInTest::unitToRestartInTest);
+    CertificateType type = CertificateType::authority;
+
+    std::string object = std::string(objectNamePrefix) + '/' +
+                         certificateTypeToString(type) + '/' + endpoint;
+    auto event = sdeventplus::Event::get_default();
+    // Attach the bus to sd_event to service user requests
+    bus.attach_event(event.get(), SD_EVENT_PRIORITY_NORMAL);
+
+    // Two single authorities stored as PEM, without a list
+    fs::copy_file(sourceAuthoritiesListFile.parent_path() / "root_0_cert",
+                  authoritiesListFolder / "cert_0");
+    fs::copy_file(sourceAuthoritiesListFile.parent_path() / "root_1_cert",
+                  authoritiesListFolder / "cert_1");
+
+    ManagerInTest manager(bus, event, object.c_str(), type, verifyUnit,
+                          authoritiesListFolder, StorageFormat::der);
+    CertificateMap& certs = manager.getCertificates();
+    ASSERT_EQ(certs.size(), 2U);
+    for (size_t i = 0; i < certs.size(); ++i)
+    {
+        const auto& cert = certs.at(i + 1);
+        EXPECT_EQ(cert->subject(),
+                  "O=openbmc-project.xyz,CN=root_" + std::to_string(i));
+        EXPECT_EQ(cert->getCertFilePath(),
+                  authoritiesListFolder / ("cert_" + std::to_string(i)));
+        EXPECT_EQ(getFileStorageFormat(cert->getCertFilePath()),
+                  StorageFormat::der);
+    }
 }
 
 } // namespace
@@ -0,0 +1,345 @@
+#include "corpus.hpp"
+
+#include "keygen.hpp"
+
+#include <openssl/asn1.h>
+#include <openssl/bio.h>
+#include <openssl/bn.h>
+#include <openssl/buffer.h>
+#include <openssl/pem.h>
+#include <openssl/x509v3.h>
+
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+
+namespace phosphor::certs::corpus
+{
+
+namespace
+{
+
+using EVPPkeyPtr = std::unique_ptr<EVP_PKEY, decltype(&::EVP_PKEY_free)>;
+
+EVPPkeyPtr generate(KeyType type)
+{
+    switch (type)
+    {
+        case KeyType::rsa2048:
+            return generateRSAKeyPair(2048);
+        case KeyType::rsa3072:
+            return generateRSAKeyPair(3072);
+        case KeyType::rsa4096:
+            return generateRSAKeyPair(4096);
+        case KeyType::p256:
+            return generateECKeyPair("prime256v1");
+        case KeyType::p384:
+            return generateECKeyPair("secp384r1");
+    }
+    throw std::invalid_argument("Unknown key type");
+}
+
+/** @brief SplitMix64, to spread the serial numbers of a seed */
+uint64_t mix(uint64_t value)
+{
+    value += 0x9e3779b97f4a7c15ULL;
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+    return value ^ (value >> 31);
+}
+
+void setTime(ASN1_TIME* field, time_t time)
+{
+    if (ASN1_TIME_set(field, time) == nullptr)
+    {
+        throw std::runtime_error("Unable to set the validity");
+    }
+}
+
+void addEntry(X509_NAME* name, const char* field, const std::string& value)
+{
+    if (X509_NAME_add_entry_by_txt(
+            name, field, MBSTRING_ASC,
+            reinterpret_cast<const unsigned char*>(value.c_str()), -1, -1,
+            0) != 1)
+    {
+        throw std::runtime_error("Unable to add name entry");
+    }
+}
+
+void addExtension(X509* cert, X509V3_CTX& ctx, int nid, const char* value)
+{
+    X509_EXTENSION* ext = X509V3_EXT_conf_nid(nullptr, &ctx, nid, value);
+    if (ext == nullptr || X509_add_ext(cert, ext, -1) != 1)
+    {
+        X509_EXTENSION_free(ext);
+        throw std::runtime_error("Unable to add extension");
+    }
+    X509_EXTENSION_free(ext);
+}
+
+std::string readBio(BIO& bio)
+{
+    BUF_MEM* mem = nullptr;
+    BIO_get_mem_ptr(&bio, &mem);
+    return {mem->data, mem->length};
+}
+
+} // namespace
+
+EVP_PKEY& key(KeyType type, size_t depth)
+{
+    static std::mutex mutex;
+    static std::map<std::pair<KeyType, size_t>, EVPPkeyPtr> keys;
+    std::lock_guard lock(mutex);
+    auto it = keys.find({type, depth});
+    if (it == keys.end())
+    {
+        it = keys.emplace(std::pair{type, depth}, generate(type)).first;
+    }
+    return *it->second;
+}
+
+Credential Generator::root(const std::string& commonName, KeyType keyType,
+                           const Validity& validity, bool freshKey)
+{
+    return issue(nullptr, commonName, true, keyType, validity, freshKey);
+}
+
+Credential Generator::intermediate(const Credential& issuer,
+                                   const std::string& commonName,
+                                   KeyType keyType, const Validity& validity,
+                                   bool freshKey)
+{
+    return issue(&issuer, commonName, true, keyType, validity, freshKey);
+}
+
+Credential Generator::leaf(const Credential& issuer,
+                           const std::string& commonName, KeyType keyType,
+                           const Validity& validity, bool freshKey)
+{
+    return issue(&issuer, commonName, false, keyType, validity, freshKey);
+}
+
+std::vector<Credential> Generator::chain(size_t depth, KeyType keyType)
+{
+    std::vector<Credential> credentials;
+    credentials.reserve(depth);
+    for (size_t i = 0; i < depth; ++i)
+    {
+        if (i == 0)
+        {
+            credentials.emplace_back(root("root", keyType));
+        }
+        else if (i + 1 < depth)
+        {
+            credentials.emplace_back(intermediate(
+                credentials.back(), "intermediate_" + std::to_string(i),
+                keyType));
+        }
+        else
+        {
+            credentials.emplace_back(
+                leaf(credentials.back(), "localhost", keyType));
+        }
+    }
+    return credentials;
+}
+
+std::vector<Credential> Generator::authorities(size_t count, KeyType keyType)
+{
+    std::vector<Credential> credentials;
+    credentials.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        credentials.emplace_back(root("root_" + std::to_string(i), keyType));
+    }
+    return credentials;
+}
+
+Credential Generator::issue(const Credential* issuer,
+                            const std::string& commonName, bool ca,
+                            KeyType keyType, const Validity& validity,
+                            bool freshKey)
+{
+    size_t depth = issuer != nullptr ? issuer->depth + 1 : 0;
+    Credential credential{X509Ptr(X509_new(), ::X509_free),
+                          &key(keyType, depth), depth};
+    if (freshKey)
+    {
+        credential.ownKey = generate(keyType);
+        credential.key = credential.ownKey.get();
+    }
+    X509* cert = credential.cert.get();
+    X509_set_version(cert, X509_VERSION_3);
+
+    // Positive 63 bit serial numbers, unique per seed
+    std::unique_ptr<BIGNUM, decltype(&::BN_free)> serial(BN_new(),
+                                                         ::BN_free);
+    BN_set_word(serial.get(), mix(seed ^ mix(issued++)) >> 1);
+    BN_to_ASN1_INTEGER(serial.get(), X509_get_serialNumber(cert));
+
+    setTime(X509_getm_notBefore(cert), validity.notBefore);
+    setTime(X509_getm_notAfter(cert), validity.notAfter);
+
+    X509_NAME* name = X509_get_subject_name(cert);
+    addEntry(name, "O", "openbmc-project.xyz");
+    addEntry(name, "CN", commonName);
+    X509* issuerCert = issuer != nullptr ? issuer->cert.get() : cert;
+    EVP_PKEY* issuerKey = issuer != nullptr ? issuer->key : credential.key;
+    X509_set_issuer_name(cert, X509_get_subject_name(issuerCert));
+    if (X509_set_pubkey(cert, credential.key) != 1)
+    {
+        throw std::runtime_error("Unable to set the public key");
+    }
+
+    X509V3_CTX ctx;
+    X509V3_set_ctx(&ctx, issuerCert, cert, nullptr, nullptr, 0);
+    if (ca)
+    {
+        addExtension(cert, ctx, NID_basic_constraints, "critical,CA:TRUE");
+        addExtension(cert, ctx, NID_key_usage,
+                     "critical,keyCertSign,cRLSign,digitalSignature");
+    }
+    else
+    {
+        addExtension(cert, ctx, NID_basic_constraints, "critical,CA:FALSE");
+        addExtension(cert, ctx, NID_key_usage,
+                     "critical,digitalSignature,keyEncipherment");
+        addExtension(cert, ctx, NID_ext_key_usage, "serverAuth,clientAuth");
+    }
+    addExtension(cert, ctx, NID_subject_key_identifier, "hash");
+    addExtension(cert, ctx, NID_authority_key_identifier, "keyid:always");
+
+    if (X509_sign(cert, issuerKey, EVP_sha256()) <= 0)
+    {
+        throw std::runtime_error("Unable to sign certificate");
+    }
+    return credential;
+}
+
+X509CrlPtr revocationList(const Credential& issuer,
+                          const std::vector<const Credential*>& revoked,
+                          size_t padding, std::optional<uint64_t> number)
+{
+    X509CrlPtr crl(X509_CRL_new(), ::X509_CRL_free);
+    X509_CRL_set_version(crl.get(), X509_CRL_VERSION_2);
+    X509_CRL_set_issuer_name(crl.get(),
+                             X509_get_subject_name(issuer.cert.get()));
+    std::unique_ptr<ASN1_TIME, decltype(&ASN1_STRING_free)> time(
+        ASN1_TIME_new(), ASN1_STRING_free);
+    setTime(time.get(), valid.notBefore);
+    X509_CRL_set1_lastUpdate(crl.get(), time.get());
+    setTime(time.get(), valid.notAfter);
+    X509_CRL_set1_nextUpdate(crl.get(), time.get());
+
+    auto revoke = [&](ASN1_INTEGER* serial) {
+        X509_REVOKED* entry = X509_REVOKED_new();
+        setTime(time.get(), valid.notBefore);
+        if (X509_REVOKED_set_serialNumber(entry, serial) != 1 ||
+            X509_REVOKED_set_revocationDate(entry, time.get()) != 1 ||
+            X509_CRL_add0_revoked(crl.get(), entry) != 1)
+        {
+            X509_REVOKED_free(entry);
+            throw std::runtime_error("Unable to add a CRL entry");
+        }
+    };
+    for (const auto* credential : revoked)
+    {
+        revoke(X509_get_serialNumber(credential->cert.get()));
+    }
+    // Generator serial numbers are below 2^63
+    std::unique_ptr<BIGNUM, decltype(&::BN_free)> serial(BN_new(),
+                                                         ::BN_free);
+    std::unique_ptr<ASN1_INTEGER, decltype(&::ASN1_INTEGER_free)> integer(
+        ASN1_INTEGER_new(), ::ASN1_INTEGER_free);
+    for (size_t i = 0; i < padding; ++i)
+    {
+        BN_set_word(serial.get(), (uint64_t{1} << 63) | i);
+        BN_to_ASN1_INTEGER(serial.get(), integer.get());
+        revoke(integer.get());
+    }
+    if (number && (ASN1_INTEGER_set_uint64(integer.get(), *number) != 1 ||
+                   X509_CRL_add1_ext_i2d(crl.get(), NID_crl_number,
+                                         integer.get(), 0, 0) != 1))
+    {
+        throw std::runtime_error("Unable to add the CRL number");
+    }
+
+    X509_CRL_sort(crl.get());
+    if (X509_CRL_sign(crl.get(), issuer.key, EVP_sha256()) <= 0)
+    {
+        throw std::runtime_error("Unable to sign CRL");
+    }
+    return crl;
+}
+
+std::string toPem(const Credential& credential, bool withKey)
+{
+    std::unique_ptr<BIO, decltype(&::BIO_free)> bio(BIO_new(BIO_s_mem()),
+                                                    ::BIO_free);
+    if (withKey && PEM_write_bio_PrivateKey(bio.get(), credential.key,
+                                            nullptr, nullptr, 0, nullptr,
+                                            nullptr) != 1)
+    {
+        throw std::runtime_error("Unable to encode the private key");
+    }
+    if (PEM_write_bio_X509(bio.get(), credential.cert.get()) != 1)
+    {
+        throw std::runtime_error("Unable to encode the certificate");
+    }
+    return readBio(*bio);
+}
+
+void writeFile(const std::string& path, const Credential& credential,
+               bool withKey)
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file << toPem(credential, withKey);
+    if (!file.flush())
+    {
+        throw std::runtime_error("Unable to write " + path);
+    }
+}
+
+void writeFile(const std::string& path,
+               const std::vector<Credential>& credentials,
+               StorageFormat format)
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    for (const auto& credential : credentials)
+    {
+        file << encodeCertificate(*credential.cert, format);
+    }
+    if (!file.flush())
+    {
+        throw std::runtime_error("Unable to write " + path);
+    }
+}
+
+void writeFile(const std::string& path, X509_CRL& crl, StorageFormat format)
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (format == StorageFormat::der)
+    {
+        std::unique_ptr<BIO, decltype(&::BIO_free)> bio(BIO_new(BIO_s_mem()),
+                                                        ::BIO_free);
+        if (i2d_X509_CRL_bio(bio.get(), &crl) != 1)
+        {
+            throw std::runtime_error("Unable to encode the CRL");
+        }
+        file << readBio(*bio);
+    }
+    else
+    {
+        file << encodeCrl(crl);
+    }
+    if (!file.flush())
+    {
+        throw std::runtime_error("Unable to write " + path);
+    }
+}
+
+} // namespace phosphor::certs::corpus
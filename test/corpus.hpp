@@ -0,0 +1,151 @@
+#pragma once
+
+#include "x509_utils.hpp"
+
+#include <openssl/evp.h>
+#include <openssl/x509.h>
+
+#include <cstdint>
+#include <ctime>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace phosphor::certs::corpus
+{
+
+using X509Ptr = std::unique_ptr<X509, decltype(&::X509_free)>;
+
+enum class KeyType
+{
+    rsa2048,
+    rsa3072,
+    rsa4096,
+    p256,
+    p384,
+};
+
+/** @brief A key of a type, generated once per process and shared by all
+ *  the certificates of that type at the same depth of a hierarchy; RSA 4096
+ *  keygen takes seconds
+ *  @param[in] type - Key type.
+ *  @param[in] depth - 0 for roots, the depth of the issuer plus one for
+ *  the others, so that certificates and their issuers have distinct keys.
+ *  Certificates issued with |freshKey| have a key of their own instead.
+ */
+EVP_PKEY& key(KeyType type, size_t depth = 0);
+
+/** @brief Validity period of a certificate, in seconds since the Epoch */
+struct Validity
+{
+    time_t notBefore;
+    time_t notAfter;
+};
+
+/** @brief From 2000 to the end of 9999 */
+inline constexpr Validity valid{946684800, 253402300799};
+/** @brief From 2000 to 2001 */
+inline constexpr Validity expired{946684800, 978307200};
+/** @brief From 3000 to the end of 9999 */
+inline constexpr Validity notYetValid{32503680000, 253402300799};
+/** @brief From the Epoch to the end of 9999 */
+inline constexpr Validity forever{0, 253402300799};
+
+/** @brief A certificate and its private key */
+struct Credential
+{
+    X509Ptr cert;
+    /** @brief Key of the pool, see key(), or |ownKey| */
+    EVP_PKEY* key;
+    /** @brief 0 for a root, the depth of the issuer plus one otherwise */
+    size_t depth;
+    /** @brief Key of the credential alone, if issued with |freshKey| */
+    std::shared_ptr<EVP_PKEY> ownKey = nullptr;
+};
+
+/** @class Generator
+ *  @brief Issue certificates with the OpenSSL API, without any openssl
+ *  command.
+ *  @details Serial numbers, names and validity periods only depend on the
+ *  seed and the calls, so two generators with the same seed issue the same
+ *  certificates, but for the keys and ECDSA signatures. Subjects are
+ *  "O=openbmc-project.xyz, CN=<common name>". With |freshKey|, a
+ *  certificate gets a newly generated key rather than the key of the pool,
+ *  e.g. for a signer which differs from another one only by its key.
+ */
+class Generator
+{
+  public:
+    explicit Generator(uint64_t seed = 1) : seed(seed) {}
+
+    /** @brief Issue a self-signed CA certificate */
+    Credential root(const std::string& commonName,
+                    KeyType keyType = KeyType::p256,
+                    const Validity& validity = valid, bool freshKey = false);
+
+    /** @brief Issue a CA certificate signed by |issuer| */
+    Credential intermediate(const Credential& issuer,
+                            const std::string& commonName,
+                            KeyType keyType = KeyType::p256,
+                            const Validity& validity = valid,
+                            bool freshKey = false);
+
+    /** @brief Issue a TLS server and client certificate signed by |issuer|
+     */
+    Credential leaf(const Credential& issuer, const std::string& commonName,
+                    KeyType keyType = KeyType::p256,
+                    const Validity& validity = valid, bool freshKey = false);
+
+    /** @brief Issue a root, |depth| - 2 intermediates and a leaf, in that
+     *  order; a single root if |depth| is 1
+     */
+    std::vector<Credential> chain(size_t depth,
+                                  KeyType keyType = KeyType::p256);
+
+    /** @brief Issue |count| roots named "root_<index>", e.g. for an
+     *  authorities list
+     */
+    std::vector<Credential> authorities(size_t count,
+                                        KeyType keyType = KeyType::p256);
+
+  private:
+    Credential issue(const Credential* issuer, const std::string& commonName,
+                     bool ca, KeyType keyType, const Validity& validity,
+                     bool freshKey);
+
+    uint64_t seed;
+    /** @brief Certificates issued so far */
+    uint64_t issued = 0;
+};
+
+/** @brief Issue a CRL signed by |issuer|, revoking |revoked| and
+ *  |padding| serial numbers no certificate has, e.g. to size a CRL as an
+ *  enterprise one; with a CRL number extension if |number| is given
+ */
+X509CrlPtr revocationList(const Credential& issuer,
+                          const std::vector<const Credential*>& revoked,
+                          size_t padding = 0,
+                          std::optional<uint64_t> number = std::nullopt);
+
+/** @brief PEM encode a credential: its private key if |withKey|, then its
+ *  certificate, as a server certificate file holds them
+ */
+std::string toPem(const Credential& credential, bool withKey);
+
+/** @brief Write a credential to |path| as toPem() encodes it */
+void writeFile(const std::string& path, const Credential& credential,
+               bool withKey = false);
+
+/** @brief Write the certificates of |credentials| to |path|, one after the
+ *  other, e.g. as an authorities list
+ */
+void writeFile(const std::string& path,
+               const std::vector<Credential>& credentials,
+               StorageFormat format = StorageFormat::pem);
+
+/** @brief Write a CRL to |path| */
+void writeFile(const std::string& path, X509_CRL& crl,
+               StorageFormat format = StorageFormat::pem);
+
+} // namespace phosphor::certs::corpus
@@ -0,0 +1,182 @@
+#include "corpus.hpp"
+#include "x509_utils.hpp"
+
+#include <openssl/pem.h>
+#include <openssl/x509.h>
+#include <openssl/x509_vfy.h>
+#include <openssl/x509v3.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <filesystem>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace phosphor::certs::corpus
+{
+namespace
+{
+
+namespace fs = std::filesystem;
+
+/** @brief Verify |cert| against the certificates of |trusted|
+ *  @return The X509 verification error.
+ */
+int verify(const std::vector<const Credential*>& trusted, X509& cert)
+{
+    std::unique_ptr<X509_STORE, decltype(&::X509_STORE_free)> store(
+        X509_STORE_new(), ::X509_STORE_free);
+    for (const auto* credential : trusted)
+    {
+        X509_STORE_add_cert(store.get(), credential->cert.get());
+    }
+    std::unique_ptr<X509_STORE_CTX, decltype(&::X509_STORE_CTX_free)> ctx(
+        X509_STORE_CTX_new(), ::X509_STORE_CTX_free);
+    X509_STORE_CTX_init(ctx.get(), store.get(), &cert, nullptr);
+    X509_verify_cert(ctx.get());
+    return X509_STORE_CTX_get_error(ctx.get());
+}
+
+std::string serial(const Credential& credential)
+{
+    std::unique_ptr<BIGNUM, decltype(&::BN_free)> number(
+        ASN1_INTEGER_to_BN(X509_get_serialNumber(credential.cert.get()),
+                           nullptr),
+        ::BN_free);
+    std::unique_ptr<char, decltype(&::free)> hex(BN_bn2hex(number.get()),
+                                                 ::free);
+    return hex.get();
+}
+
+TEST(CorpusTest, ChainVerifies)
+{
+    Generator generator;
+    auto chain = generator.chain(3);
+    ASSERT_EQ(chain.size(), 3U);
+    EXPECT_NE(chain[0].key, chain[1].key);
+    EXPECT_NE(chain[1].key, chain[2].key);
+    // Same depth, key of its own
+    auto fresh = generator.intermediate(chain[0], "intermediate_1",
+                                        KeyType::p256, valid, true);
+    EXPECT_NE(fresh.key, chain[1].key);
+    EXPECT_EQ(verify({&chain[0]}, *fresh.cert), X509_V_OK);
+
+    EXPECT_EQ(verify({&chain[0], &chain[1]}, *chain[2].cert), X509_V_OK);
+    // Missing the intermediate
+    EXPECT_EQ(verify({&chain[0]}, *chain[2].cert),
+              X509_V_ERR_UNABLE_TO_GET_ISSUER_CERT_LOCALLY);
+    EXPECT_EQ(X509_check_ca(chain[1].cert.get()), 1);
+    EXPECT_EQ(X509_check_ca(chain[2].cert.get()), 0);
+}
+
+TEST(CorpusTest, Validity)
+{
+    Generator generator;
+    auto root = generator.root("root", KeyType::p256, forever);
+    auto expiredLeaf = generator.leaf(root, "expired", KeyType::p256,
+                                      expired);
+    auto futureLeaf = generator.leaf(root, "future", KeyType::p256,
+                                     notYetValid);
+
+    EXPECT_EQ(verify({&root}, *expiredLeaf.cert),
+              X509_V_ERR_CERT_HAS_EXPIRED);
+    EXPECT_EQ(verify({&root}, *futureLeaf.cert), X509_V_ERR_CERT_NOT_YET_VALID);
+    auto properties = extractProperties(*root.cert);
+    EXPECT_EQ(properties.validNotBefore, 0U);
+    EXPECT_EQ(properties.validNotAfter, 253402300799U);
+}
+
+TEST(CorpusTest, RevocationList)
+{
+    char dirTemplate[] = "/tmp/FakeCerts.XXXXXX";
+    auto dirPtr = mkdtemp(dirTemplate);
+    if (dirPtr == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    fs::path dir = dirPtr;
+
+    Generator generator;
+    auto chain = generator.chain(3);
+    auto crl = revocationList(chain[1], {&chain[2]}, 1000);
+    EXPECT_EQ(X509_CRL_verify(crl.get(), chain[1].key), 1);
+    EXPECT_EQ(formatName(*X509_CRL_get_issuer(crl.get())),
+              formatName(*X509_get_subject_name(chain[1].cert.get())));
+
+    for (auto format : {StorageFormat::pem, StorageFormat::der})
+    {
+        std::string path = dir / "crl";
+        writeFile(path, *crl, format);
+        auto crls = loadCrls(path);
+        ASSERT_EQ(crls.size(), 1U);
+        ASSERT_EQ(sk_X509_REVOKED_num(X509_CRL_get_REVOKED(crls[0].get())),
+                  1001);
+        X509_REVOKED* entry = nullptr;
+        EXPECT_EQ(X509_CRL_get0_by_cert(crls[0].get(), &entry,
+                                        chain[2].cert.get()),
+                  1);
+        EXPECT_EQ(X509_CRL_get0_by_cert(crls[0].get(), &entry,
+                                        chain[1].cert.get()),
+                  0);
+    }
+    fs::remove_all(dir);
+}
+
+TEST(CorpusTest, Deterministic)
+{
+    Generator first(42);
+    Generator second(42);
+    Generator other(43);
+    auto a = first.authorities(3);
+    auto b = second.authorities(3);
+    auto c = other.authorities(3);
+    for (size_t i = 0; i < a.size(); ++i)
+    {
+        EXPECT_EQ(serial(a[i]), serial(b[i]));
+        EXPECT_NE(serial(a[i]), serial(c[i]));
+        EXPECT_EQ(generateCertId(*a[i].cert), generateCertId(*b[i].cert));
+    }
+    EXPECT_NE(serial(a[0]), serial(a[1]));
+    EXPECT_EQ(formatName(*X509_get_subject_name(a[2].cert.get())),
+              "O=openbmc-project.xyz,CN=root_2");
+}
+
+TEST(CorpusTest, Files)
+{
+    char dirTemplate[] = "/tmp/FakeCerts.XXXXXX";
+    auto dirPtr = mkdtemp(dirTemplate);
+    if (dirPtr == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    fs::path dir = dirPtr;
+
+    Generator generator;
+    auto authorities = generator.authorities(100);
+    for (auto format : {StorageFormat::pem, StorageFormat::der})
+    {
+        std::string path = dir / "bundle";
+        writeFile(path, authorities, format);
+        EXPECT_EQ(loadCertificates(path).size(), authorities.size());
+    }
+
+    std::string path = dir / "cert.pem";
+    writeFile(path, authorities.front(), true);
+    EXPECT_EQ(generateCertId(*loadCert(path)),
+              generateCertId(*authorities.front().cert));
+    std::unique_ptr<BIO, decltype(&::BIO_free)> bio(
+        BIO_new_file(path.c_str(), "r"), ::BIO_free);
+    std::unique_ptr<EVP_PKEY, decltype(&::EVP_PKEY_free)> pKey(
+        PEM_read_bio_PrivateKey(bio.get(), nullptr, nullptr, nullptr),
+        ::EVP_PKEY_free);
+    ASSERT_NE(pKey, nullptr);
+    EXPECT_EQ(EVP_PKEY_eq(pKey.get(), authorities.front().key), 1);
+    fs::remove_all(dir);
+}
+
+} // namespace
+} // namespace phosphor::certs::corpus
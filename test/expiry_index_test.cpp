@@ -0,0 +1,140 @@
+#include "expiry_index.hpp"
+
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace phosphor::certs
+{
+namespace
+{
+
+constexpr uint64_t day = 24 * 60 * 60;
+
+TEST(ExpiryIndex, ExpiringBeforeIsOrdered)
+{
+    ExpiryIndex index({});
+    index.update(1, 300);
+    index.update(2, 100);
+    index.update(3, 200);
+    EXPECT_EQ(index.expiringBefore(250), (std::vector<uint64_t>{2, 3}));
+    EXPECT_EQ(index.expiringBefore(100), std::vector<uint64_t>{});
+    EXPECT_EQ(index.expiringBefore(301), (std::vector<uint64_t>{2, 3, 1}));
+}
+
+TEST(ExpiryIndex, CrossesEachWindowOnce)
+{
+    ExpiryIndex index({7 * day, 30 * day});
+    uint64_t notAfter = 100 * day;
+    index.update(1, notAfter);
+
+    EXPECT_EQ(index.nextCrossing(), notAfter - 30 * day);
+    EXPECT_TRUE(index.due(notAfter - 31 * day).empty());
+
+    auto crossings = index.due(notAfter - 30 * day);
+    ASSERT_EQ(crossings.size(), 1);
+    EXPECT_EQ(crossings[0].id, 1);
+    EXPECT_EQ(crossings[0].notAfter, notAfter);
+    EXPECT_EQ(crossings[0].window, 30 * day);
+    EXPECT_TRUE(index.due(notAfter - 30 * day).empty());
+
+    EXPECT_EQ(index.nextCrossing(), notAfter - 7 * day);
+    crossings = index.due(notAfter - 7 * day);
+    ASSERT_EQ(crossings.size(), 1);
+    EXPECT_EQ(crossings[0].window, 7 * day);
+
+    crossings = index.due(notAfter);
+    ASSERT_EQ(crossings.size(), 1);
+    EXPECT_EQ(crossings[0].window, 0);
+    EXPECT_EQ(index.nextCrossing(), std::nullopt);
+    EXPECT_EQ(index.size(), 1);
+}
+
+TEST(ExpiryIndex, ReportsTheLastWindowCrossed)
+{
+    ExpiryIndex index({7 * day, 30 * day});
+    index.update(1, 100 * day);
+    index.update(2, 10 * day);
+
+    // The clock jumps past the 30 days window of 1, and the expiry of 2
+    auto crossings = index.due(80 * day);
+    ASSERT_EQ(crossings.size(), 2);
+    EXPECT_EQ(crossings[0].id, 2);
+    EXPECT_EQ(crossings[0].window, 0);
+    EXPECT_EQ(crossings[1].id, 1);
+    EXPECT_EQ(crossings[1].window, 30 * day);
+    EXPECT_EQ(index.nextCrossing(), 93 * day);
+}
+
+TEST(ExpiryIndex, UpdateRestartsTheWindows)
+{
+    ExpiryIndex index({30 * day});
+    index.update(1, 100 * day);
+    index.due(70 * day);
+
+    // Same certificate, or one with the same validity: nothing to report
+    index.update(1, 100 * day);
+    EXPECT_EQ(index.nextCrossing(), 100 * day);
+
+    // Renewed
+    index.update(1, 200 * day);
+    EXPECT_EQ(index.nextCrossing(), 170 * day);
+    EXPECT_EQ(index.expiringBefore(150 * day), std::vector<uint64_t>{});
+}
+
+TEST(ExpiryIndex, MarkCrossed)
+{
+    ExpiryIndex index({7 * day, 30 * day});
+    index.update(1, 100 * day);
+    index.update(2, 200 * day);
+    index.update(3, 300 * day);
+    EXPECT_TRUE(index.crossed().empty());
+
+    // As restored from a previous run
+    index.markCrossed(1, 7 * day);
+    index.markCrossed(2, 30 * day);
+    index.markCrossed(4, 0);
+    EXPECT_EQ(index.nextCrossing(), 100 * day);
+    EXPECT_TRUE(index.due(99 * day).empty());
+    // Windows already crossed are kept
+    index.markCrossed(1, 30 * day);
+    EXPECT_EQ(index.nextCrossing(), 100 * day);
+
+    auto crossed = index.crossed();
+    ASSERT_EQ(crossed.size(), 2);
+    EXPECT_EQ(crossed[0].id, 1);
+    EXPECT_EQ(crossed[0].notAfter, 100 * day);
+    EXPECT_EQ(crossed[0].window, 7 * day);
+    EXPECT_EQ(crossed[1].id, 2);
+    EXPECT_EQ(crossed[1].window, 30 * day);
+
+    index.markCrossed(2, 0);
+    EXPECT_EQ(index.crossed()[1].window, 0);
+    EXPECT_EQ(index.nextCrossing(), 100 * day);
+    index.due(100 * day);
+    EXPECT_EQ(index.nextCrossing(), 270 * day);
+}
+
+TEST(ExpiryIndex, Erase)
+{
+    ExpiryIndex index({30 * day});
+    index.update(1, 100 * day);
+    index.update(2, 200 * day);
+    index.update(3, 300 * day);
+
+    index.erase(1);
+    index.erase(4);
+    EXPECT_EQ(index.nextCrossing(), 170 * day);
+
+    index.retain([](uint64_t id) { return id != 2; });
+    EXPECT_EQ(index.expiringBefore(400 * day), std::vector<uint64_t>{3});
+    EXPECT_EQ(index.nextCrossing(), 270 * day);
+
+    index.clear();
+    EXPECT_EQ(index.size(), 0);
+    EXPECT_EQ(index.nextCrossing(), std::nullopt);
+}
+
+} // namespace
+} // namespace phosphor::certs
@@ -0,0 +1,113 @@
+#include "corpus.hpp"
+#include "file_content.hpp"
+#include "x509_utils.hpp"
+
+#include <openssl/pem.h>
+#include <openssl/x509.h>
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <system_error>
+
+#include <gtest/gtest.h>
+
+namespace phosphor::certs
+{
+namespace
+{
+
+namespace fs = std::filesystem;
+
+class FileContentTest : public ::testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        char dirTemplate[] = "/tmp/FakeCerts.XXXXXX";
+        auto dirPtr = mkdtemp(dirTemplate);
+        if (dirPtr == nullptr)
+        {
+            throw std::bad_alloc();
+        }
+        dir = dirPtr;
+    }
+
+    void TearDown() override
+    {
+        fs::remove_all(dir);
+    }
+
+    fs::path writeFile(const std::string& name, const std::string& content)
+    {
+        fs::path path = dir / name;
+        std::ofstream(path) << content;
+        return path;
+    }
+
+    fs::path dir;
+};
+
+TEST_F(FileContentTest, ReadsRegularFile)
+{
+    fs::path path = writeFile("file", "some content");
+    FileContent file(path);
+    EXPECT_EQ(file.view(), "some content");
+}
+
+TEST_F(FileContentTest, EmptyFile)
+{
+    fs::path path = writeFile("empty", "");
+    FileContent file(path);
+    EXPECT_TRUE(file.view().empty());
+    EXPECT_NE(file.bio(), nullptr);
+}
+
+TEST_F(FileContentTest, MissingFileThrows)
+{
+    EXPECT_THROW(FileContent(dir / "missing"), std::system_error);
+}
+
+TEST_F(FileContentTest, ReadsFilesWithoutSize)
+{
+    // procfs reports a zero size, so the buffer has to grow
+    FileContent file("/proc/self/status");
+    EXPECT_NE(file.view().find("Name:"), std::string_view::npos);
+}
+
+TEST_F(FileContentTest, BioParsesCertificate)
+{
+    fs::path path = dir / "cert.pem";
+    corpus::writeFile(path, corpus::Generator().root("localhost"));
+
+    FileContent file(path);
+    auto bio = file.bio();
+    ASSERT_NE(bio, nullptr);
+    std::unique_ptr<X509, decltype(&::X509_free)> cert(
+        PEM_read_bio_X509(bio.get(), nullptr, nullptr, nullptr), ::X509_free);
+    ASSERT_NE(cert, nullptr);
+    EXPECT_EQ(formatName(*X509_get_subject_name(cert.get())),
+              "O=openbmc-project.xyz,CN=localhost");
+}
+
+TEST_F(FileContentTest, FileStampTracksContent)
+{
+    EXPECT_FALSE(getFileStamp(dir / "csr.pem").has_value());
+
+    fs::path path = writeFile("csr.pem", "first");
+    auto first = getFileStamp(path);
+    ASSERT_TRUE(first.has_value());
+    EXPECT_EQ(getFileStamp(path), first);
+
+    // A rewritten file is a new file, as with writeCSR()
+    fs::remove(path);
+    writeFile("csr.pem", "second");
+    auto second = getFileStamp(path);
+    ASSERT_TRUE(second.has_value());
+    EXPECT_NE(second, first);
+}
+
+} // namespace
+} // namespace phosphor::certs
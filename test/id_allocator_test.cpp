@@ -0,0 +1,123 @@
+#include "id_allocator.hpp"
+
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+
+#include <gtest/gtest.h>
+
+namespace phosphor::certs
+{
+namespace
+{
+
+TEST(IdAllocator, AllocatesSequentially)
+{
+    IdAllocator ids;
+    EXPECT_EQ(ids.allocate(), 1);
+    EXPECT_EQ(ids.allocate(), 2);
+    EXPECT_EQ(ids.allocate(), 3);
+    EXPECT_EQ(ids.gaps(), 0);
+}
+
+TEST(IdAllocator, ReusesSmallestReleasedId)
+{
+    IdAllocator ids;
+    for (int i = 0; i < 5; ++i)
+    {
+        ids.allocate();
+    }
+    ids.release(4);
+    ids.release(2);
+    EXPECT_FALSE(ids.isAllocated(2));
+    EXPECT_EQ(ids.allocate(), 2);
+    EXPECT_EQ(ids.allocate(), 4);
+    EXPECT_EQ(ids.allocate(), 6);
+}
+
+TEST(IdAllocator, ReleasingTopIdMovesFrontierBack)
+{
+    IdAllocator ids;
+    ids.allocate();
+    ids.allocate();
+    ids.allocate();
+    ids.release(2);
+    ids.release(3);
+    EXPECT_EQ(ids.gaps(), 0);
+    EXPECT_EQ(ids.allocate(), 2);
+}
+
+TEST(IdAllocator, LargeDesignatedIdIsCompact)
+{
+    IdAllocator ids;
+    EXPECT_EQ(ids.reserve(1000000), 1000000);
+    EXPECT_EQ(ids.gaps(), 1);
+    EXPECT_TRUE(ids.isAllocated(1000000));
+    EXPECT_FALSE(ids.isAllocated(999999));
+    EXPECT_EQ(ids.allocate(), 1);
+    EXPECT_EQ(ids.allocate(), 2);
+    EXPECT_EQ(ids.gaps(), 1);
+}
+
+TEST(IdAllocator, ReserveSplitsGap)
+{
+    IdAllocator ids;
+    ids.reserve(10);
+    ids.reserve(5);
+    EXPECT_EQ(ids.gaps(), 2);
+    ids.reserve(1);
+    ids.reserve(9);
+    EXPECT_EQ(ids.gaps(), 2);
+    EXPECT_EQ(ids.allocate(), 2);
+    EXPECT_EQ(ids.allocate(), 3);
+    EXPECT_EQ(ids.allocate(), 4);
+    EXPECT_EQ(ids.allocate(), 6);
+    // Reserving an allocated ID is a no-op.
+    EXPECT_EQ(ids.reserve(6), 6);
+    EXPECT_EQ(ids.allocate(), 7);
+}
+
+TEST(IdAllocator, ReleaseMergesNeighbours)
+{
+    IdAllocator ids;
+    for (int i = 0; i < 10; ++i)
+    {
+        ids.allocate();
+    }
+    ids.release(3);
+    ids.release(5);
+    EXPECT_EQ(ids.gaps(), 2);
+    ids.release(4);
+    EXPECT_EQ(ids.gaps(), 1);
+    // Double release is ignored.
+    ids.release(4);
+    ids.release(42);
+    EXPECT_EQ(ids.gaps(), 1);
+    EXPECT_EQ(ids.allocate(), 3);
+    EXPECT_EQ(ids.allocate(), 4);
+    EXPECT_EQ(ids.allocate(), 5);
+    EXPECT_EQ(ids.allocate(), 11);
+}
+
+TEST(IdAllocator, RejectsOutOfRangeIds)
+{
+    IdAllocator ids;
+    EXPECT_THROW(ids.reserve(0), std::out_of_range);
+    EXPECT_THROW(ids.reserve(std::numeric_limits<uint64_t>::max()),
+                 std::out_of_range);
+    EXPECT_EQ(ids.allocate(), 1);
+}
+
+TEST(IdAllocator, ResetReleasesEverything)
+{
+    IdAllocator ids;
+    ids.reserve(100);
+    ids.allocate();
+    ids.reset();
+    EXPECT_EQ(ids.gaps(), 0);
+    EXPECT_FALSE(ids.isAllocated(100));
+    EXPECT_EQ(ids.allocate(), 1);
+}
+
+} // namespace
+} // namespace phosphor::certs
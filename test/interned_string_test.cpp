@@ -0,0 +1,58 @@
+#include "interned_string.hpp"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace phosphor::certs
+{
+namespace
+{
+
+TEST(InternedString, EqualStringsShareOneCopy)
+{
+    auto first = intern("/etc/ssl/certs/authority");
+    auto second = intern(std::string("/etc/ssl/certs/") + "authority");
+    EXPECT_EQ(first, second);
+    EXPECT_EQ(*first, "/etc/ssl/certs/authority");
+    EXPECT_NE(intern("/etc/ssl/certs/server"), first);
+}
+
+TEST(InternedString, ReleasedStringIsCreatedAgain)
+{
+    std::string value = "/tmp/released";
+    {
+        auto held = intern(value);
+        EXPECT_EQ(held.use_count(), 1);
+    }
+    auto again = intern(value);
+    EXPECT_EQ(*again, value);
+    EXPECT_EQ(again.use_count(), 1);
+}
+
+TEST(InternedString, ConcurrentInterning)
+{
+    std::vector<InternedString> results(8);
+    {
+        std::vector<std::jthread> threads;
+        for (size_t i = 0; i < results.size(); ++i)
+        {
+            threads.emplace_back([&results, i]() {
+                for (int n = 0; n < 1000; ++n)
+                {
+                    intern("/tmp/other" + std::to_string(n % 7));
+                }
+                results[i] = intern("/tmp/concurrent");
+            });
+        }
+    }
+    for (const auto& result : results)
+    {
+        EXPECT_EQ(result, results.front());
+    }
+}
+
+} // namespace
+} // namespace phosphor::certs
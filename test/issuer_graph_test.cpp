@@ -0,0 +1,95 @@
+#include "issuer_graph.hpp"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+
+#include <gtest/gtest.h>
+
+namespace phosphor::certs
+{
+namespace
+{
+
+class IssuerGraphTest : public testing::Test
+{
+  protected:
+    void add(uint64_t id, const std::string& subject, const std::string& issuer,
+             const std::optional<std::string>& subjectKeyId,
+             const std::optional<std::string>& authorityKeyId)
+    {
+        subjects.set(id, subject);
+        issuers.set(id, issuer);
+        graph.set(id, subjectKeyId, authorityKeyId);
+    }
+
+    void remove(uint64_t id)
+    {
+        subjects.erase(id);
+        issuers.erase(id);
+        graph.erase(id);
+    }
+
+    KeyIndex<std::string> subjects;
+    KeyIndex<std::string> issuers;
+    IssuerGraph graph{subjects, issuers};
+};
+
+TEST_F(IssuerGraphTest, ResolvesIssuers)
+{
+    add(1, "CN=leaf", "CN=ca", "0c", "0b");
+    add(2, "CN=root", "CN=root", "0a", "0a");
+    add(3, "CN=ca", "CN=root", "0b", "0a");
+
+    EXPECT_EQ(graph.issuerOf(1), 3);
+    EXPECT_EQ(graph.issuerOf(3), 2);
+    EXPECT_EQ(graph.issuerOf(2), std::nullopt);
+
+    // An issuer removed is not found
+    remove(3);
+    EXPECT_EQ(graph.issuerOf(1), std::nullopt);
+
+    // Until it comes back
+    add(4, "CN=ca", "CN=root", "0b", "0a");
+    EXPECT_EQ(graph.issuerOf(1), 4);
+}
+
+TEST_F(IssuerGraphTest, KeyIdentifierSelectsTheIssuer)
+{
+    // Two CAs with the same name, e.g. before and after a rekey
+    add(1, "CN=ca", "CN=ca", "0a", "0a");
+    add(2, "CN=ca", "CN=ca", "0b", "0b");
+    add(3, "CN=leaf", "CN=ca", "0c", "0b");
+    add(4, "CN=other", "CN=ca", "0d", "0e");
+
+    EXPECT_EQ(graph.issuerOf(3), 2);
+    EXPECT_EQ(graph.issuerOf(4), std::nullopt);
+}
+
+TEST_F(IssuerGraphTest, FallsBackToNames)
+{
+    add(1, "CN=root", "CN=root", std::nullopt, std::nullopt);
+    add(2, "CN=ca", "CN=root", "0b", std::nullopt);
+    add(3, "CN=leaf", "CN=ca", std::nullopt, "0b");
+
+    EXPECT_EQ(graph.issuerOf(3), 2);
+    EXPECT_EQ(graph.issuerOf(2), 1);
+
+    // An issuer without a key identifier is found by its name
+    graph.set(2, std::nullopt, std::nullopt);
+    EXPECT_EQ(graph.issuerOf(3), 2);
+}
+
+TEST_F(IssuerGraphTest, CrossSignedCertificates)
+{
+    add(1, "CN=a", "CN=b", "0a", "0b");
+    add(2, "CN=b", "CN=a", "0b", "0a");
+    add(3, "CN=leaf", "CN=a", "0c", "0a");
+
+    EXPECT_EQ(graph.issuerOf(3), 1);
+    EXPECT_EQ(graph.issuerOf(1), 2);
+    EXPECT_EQ(graph.issuerOf(2), 1);
+}
+
+} // namespace
+} // namespace phosphor::certs
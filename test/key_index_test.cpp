@@ -0,0 +1,88 @@
+#include "key_index.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace phosphor::certs
+{
+namespace
+{
+
+TEST(KeyIndex, FindsIdsByKey)
+{
+    KeyIndex<std::string> index;
+    index.set(3, "CN=a");
+    index.set(1, "CN=a");
+    index.set(2, "CN=b");
+    EXPECT_EQ(index.find("CN=a"), (std::vector<uint64_t>{1, 3}));
+    EXPECT_EQ(index.find("CN=b"), std::vector<uint64_t>{2});
+    EXPECT_TRUE(index.find("CN=c").empty());
+    ASSERT_NE(index.get(2), nullptr);
+    EXPECT_EQ(*index.get(2), "CN=b");
+    EXPECT_EQ(index.get(4), nullptr);
+    EXPECT_EQ(index.size(), 3);
+}
+
+TEST(KeyIndex, SetReplacesTheKey)
+{
+    KeyIndex<std::string> index;
+    index.set(1, "CN=a");
+    index.set(1, "CN=a");
+    EXPECT_EQ(index.find("CN=a"), std::vector<uint64_t>{1});
+    index.set(1, "CN=b");
+    EXPECT_TRUE(index.find("CN=a").empty());
+    EXPECT_EQ(index.find("CN=b"), std::vector<uint64_t>{1});
+    EXPECT_EQ(index.size(), 1);
+}
+
+TEST(KeyIndex, Erase)
+{
+    KeyIndex<std::string> index;
+    index.set(1, "CN=a");
+    index.set(2, "CN=a");
+    index.erase(1);
+    index.erase(5);
+    EXPECT_EQ(index.find("CN=a"), std::vector<uint64_t>{2});
+    EXPECT_EQ(index.get(1), nullptr);
+    index.clear();
+    EXPECT_TRUE(index.find("CN=a").empty());
+    EXPECT_EQ(index.size(), 0);
+}
+
+TEST(KeyIndex, KeysSurviveRehash)
+{
+    KeyIndex<std::string> index;
+    for (uint64_t id = 1; id <= 10000; ++id)
+    {
+        index.set(id, "CN=" + std::to_string(id % 100));
+    }
+    for (uint64_t id = 1; id <= 10000; id += 2)
+    {
+        index.erase(id);
+    }
+    EXPECT_EQ(index.size(), 5000);
+    EXPECT_EQ(index.find("CN=2").size(), 100);
+    EXPECT_TRUE(index.find("CN=1").empty());
+    EXPECT_EQ(*index.get(9998), "CN=98");
+}
+
+TEST(KeyIndex, MemoryUsage)
+{
+    KeyIndex<std::string> index;
+    size_t empty = index.memoryUsage();
+    index.set(1, "CN=a");
+    size_t shortKey = index.memoryUsage();
+    EXPECT_GT(shortKey, empty);
+    // Keys past the inline buffer of std::string count too
+    index.set(1, std::string(100, 'a'));
+    EXPECT_GE(index.memoryUsage(), shortKey + 100);
+    index.clear();
+    EXPECT_LT(index.memoryUsage(), shortKey);
+}
+
+} // namespace
+} // namespace phosphor::certs
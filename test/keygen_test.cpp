@@ -0,0 +1,81 @@
+#include "keygen.hpp"
+
+#include <openssl/evp.h>
+#include <openssl/x509.h>
+
+#include <xyz/openbmc_project/Common/error.hpp>
+
+#include <memory>
+#include <string>
+
+#include <gtest/gtest.h>
+
+namespace phosphor::certs
+{
+namespace
+{
+
+using ::sdbusplus::xyz::openbmc_project::Common::Error::InvalidArgument;
+
+bool signsRequest(EVP_PKEY& pKey)
+{
+    std::unique_ptr<X509_REQ, decltype(&::X509_REQ_free)> req(
+        X509_REQ_new(), ::X509_REQ_free);
+    return X509_REQ_set_pubkey(req.get(), &pKey) == 1 &&
+           X509_REQ_sign(req.get(), &pKey, getSigningDigest(pKey)) > 0 &&
+           X509_REQ_verify(req.get(), &pKey) == 1;
+}
+
+TEST(KeyGen, RSAKeyHasRequestedLength)
+{
+    auto pKey = generateRSAKeyPair(2048);
+    ASSERT_NE(pKey, nullptr);
+    EXPECT_EQ(EVP_PKEY_id(pKey.get()), EVP_PKEY_RSA);
+    EXPECT_EQ(EVP_PKEY_bits(pKey.get()), 2048);
+    EXPECT_EQ(getSigningDigest(*pKey), EVP_sha256());
+    EXPECT_TRUE(signsRequest(*pKey));
+}
+
+TEST(KeyGen, ECKeyAcceptsOpenSSLAndNISTNames)
+{
+    auto secp = generateECKeyPair("secp384r1");
+    ASSERT_NE(secp, nullptr);
+    EXPECT_EQ(EVP_PKEY_bits(secp.get()), 384);
+    EXPECT_EQ(getSigningDigest(*secp), EVP_sha384());
+    EXPECT_TRUE(signsRequest(*secp));
+
+    auto nist = generateECKeyPair("P-384");
+    ASSERT_NE(nist, nullptr);
+    EXPECT_EQ(EVP_PKEY_bits(nist.get()), 384);
+
+    auto p521 = generateECKeyPair("P-521");
+    ASSERT_NE(p521, nullptr);
+    EXPECT_EQ(getSigningDigest(*p521), EVP_sha512());
+}
+
+TEST(KeyGen, ECKeyUsesDefaultCurve)
+{
+    auto pKey = generateECKeyPair("");
+    ASSERT_NE(pKey, nullptr);
+    EXPECT_EQ(EVP_PKEY_bits(pKey.get()), 224);
+    EXPECT_EQ(getSigningDigest(*pKey), EVP_sha256());
+}
+
+TEST(KeyGen, ECKeyRejectsUnsupportedCurve)
+{
+    EXPECT_THROW(generateECKeyPair("DummyCurveName"), InvalidArgument);
+    // Known to OpenSSL, but not on the supported list.
+    EXPECT_THROW(generateECKeyPair("secp112r1"), InvalidArgument);
+}
+
+TEST(KeyGen, Ed25519KeySignsWithoutDigest)
+{
+    auto pKey = generateEd25519KeyPair();
+    ASSERT_NE(pKey, nullptr);
+    EXPECT_EQ(EVP_PKEY_id(pKey.get()), EVP_PKEY_ED25519);
+    EXPECT_EQ(getSigningDigest(*pKey), nullptr);
+    EXPECT_TRUE(signsRequest(*pKey));
+}
+
+} // namespace
+} // namespace phosphor::certs
@@ -0,0 +1,218 @@
+#include "metrics.hpp"
+
+#include <xyz/openbmc_project/Certs/error.hpp>
+#include <xyz/openbmc_project/Common/error.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <new>
+#include <stdexcept>
+#include <string>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace phosphor::certs::metrics
+{
+namespace
+{
+
+namespace fs = std::filesystem;
+using ::sdbusplus::xyz::openbmc_project::Certs::Error::InvalidCertificate;
+using ::sdbusplus::xyz::openbmc_project::Common::Error::NotAllowed;
+using ::testing::HasSubstr;
+using namespace std::chrono_literals;
+
+constexpr size_t overflow = Registry::bucketCount;
+
+TEST(RegistryTest, LatencyBuckets)
+{
+    Registry registry;
+    registry.record(Operation::install, 500ns, std::nullopt);
+    registry.record(Operation::install, 1us, std::nullopt);
+    registry.record(Operation::install, 3us, std::nullopt);
+    registry.record(Operation::install, 4us, std::nullopt);
+    registry.record(Operation::install, 1s, std::nullopt);
+    registry.record(Operation::install, 1h, std::nullopt);
+
+    EXPECT_EQ(registry.calls(Operation::install), 6U);
+    EXPECT_EQ(registry.calls(Operation::installAll), 0U);
+    EXPECT_EQ(registry.latencyBucket(Operation::install, 0), 2U);
+    EXPECT_EQ(registry.latencyBucket(Operation::install, 1), 0U);
+    EXPECT_EQ(registry.latencyBucket(Operation::install, 2), 2U);
+    // 2^20 us is the first bound over a second
+    EXPECT_EQ(registry.latencyBucket(Operation::install, 20), 1U);
+    EXPECT_EQ(registry.latencyBucket(Operation::install, overflow), 1U);
+}
+
+TEST(RegistryTest, ErrorsAndCounters)
+{
+    Registry registry;
+    registry.record(Operation::replaceAll, 1ms, ErrorClass::notAllowed);
+    registry.record(Operation::replaceAll, 1ms, std::nullopt);
+    registry.count(Counter::reloads, 1);
+    registry.count(Counter::bytesRead, 1000);
+    registry.count(Counter::bytesRead, 24);
+
+    EXPECT_EQ(registry.calls(Operation::replaceAll), 2U);
+    EXPECT_EQ(registry.errors(Operation::replaceAll, ErrorClass::notAllowed),
+              1U);
+    EXPECT_EQ(
+        registry.errors(Operation::replaceAll, ErrorClass::internalFailure),
+        0U);
+    EXPECT_EQ(registry.get(Counter::reloads), 1U);
+    EXPECT_EQ(registry.get(Counter::bytesRead), 1024U);
+    EXPECT_EQ(registry.get(Counter::bytesWritten), 0U);
+}
+
+TEST(RegistryTest, DBusProperties)
+{
+    Registry registry;
+    registry.record(Operation::installAll, 3us, ErrorClass::notAllowed);
+    registry.record(Operation::installAll, 1h, std::nullopt);
+    registry.count(Counter::bytesWritten, 42);
+
+    auto calls = registry.callsByOperation();
+    EXPECT_EQ(calls.size(), operationCount);
+    EXPECT_EQ(calls.at("installAll"), 2U);
+    EXPECT_EQ(calls.at("install"), 0U);
+    EXPECT_EQ(registry.errorsByOperation().at("installAll").at("NotAllowed"),
+              1U);
+    auto latency = registry.latencyByOperation().at("installAll");
+    ASSERT_EQ(latency.size(), Registry::bucketCount + 1);
+    EXPECT_EQ(latency[2], 1U);
+    EXPECT_EQ(latency[overflow], 1U);
+    EXPECT_EQ(registry.durationByOperation().at("installAll"),
+              3600000003U);
+    EXPECT_EQ(registry.countersByName().at("bytesWritten"), 42U);
+    EXPECT_EQ(registry.countersByName().at("reloads"), 0U);
+}
+
+TEST(RegistryTest, Prometheus)
+{
+    Registry registry;
+    registry.record(Operation::install, 1us, std::nullopt);
+    registry.record(Operation::install, 3us, ErrorClass::invalidCertificate);
+    registry.count(Counter::opensslParses, 7);
+
+    std::string text = registry.toPrometheus();
+    EXPECT_THAT(text, HasSubstr("# TYPE phosphor_certificate_manager_"
+                                "operation_duration_seconds histogram\n"));
+    EXPECT_THAT(text, HasSubstr("phosphor_certificate_manager_operations_"
+                                "total{operation=\"install\"} 2\n"));
+    EXPECT_THAT(text, HasSubstr("phosphor_certificate_manager_operation_"
+                                "errors_total{operation=\"install\","
+                                "class=\"InvalidCertificate\"} 1\n"));
+    // Buckets are cumulative
+    EXPECT_THAT(text, HasSubstr("phosphor_certificate_manager_operation_"
+                                "duration_seconds_bucket{operation="
+                                "\"install\",le=\"0.000001\"} 1\n"));
+    EXPECT_THAT(text, HasSubstr("phosphor_certificate_manager_operation_"
+                                "duration_seconds_bucket{operation="
+                                "\"install\",le=\"0.000004\"} 2\n"));
+    EXPECT_THAT(text, HasSubstr("phosphor_certificate_manager_operation_"
+                                "duration_seconds_bucket{operation="
+                                "\"install\",le=\"+Inf\"} 2\n"));
+    EXPECT_THAT(text, HasSubstr("phosphor_certificate_manager_operation_"
+                                "duration_seconds_count{operation="
+                                "\"install\"} 2\n"));
+    EXPECT_THAT(text,
+                HasSubstr("phosphor_certificate_manager_openssl_parses_total"
+                          " 7\n"));
+}
+
+TEST(RegistryTest, EndpointLabel)
+{
+    Registry registry;
+    registry.setEndpoint("/xyz/openbmc_project/certs/server/https");
+    registry.record(Operation::install, 1us, std::nullopt);
+    registry.count(Counter::opensslParses, 7);
+
+    std::string text = registry.toPrometheus();
+    EXPECT_THAT(text, HasSubstr("phosphor_certificate_manager_operations_"
+                                "total{endpoint=\"/xyz/openbmc_project/certs/"
+                                "server/https\",operation=\"install\"} 1\n"));
+    EXPECT_THAT(text,
+                HasSubstr("phosphor_certificate_manager_openssl_parses_total"
+                          "{endpoint=\"/xyz/openbmc_project/certs/server/"
+                          "https\"} 7\n"));
+}
+
+TEST(RegistryTest, ExportFile)
+{
+    char dirTemplate[] = "/tmp/FakeCerts.XXXXXX";
+    auto dirPtr = mkdtemp(dirTemplate);
+    if (dirPtr == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    fs::path dir = dirPtr;
+    fs::path path = dir / "metrics.prom";
+
+    Registry registry;
+    registry.setExportPath(path);
+    ASSERT_TRUE(fs::exists(path));
+    registry.record(Operation::deleteAll, 1ms, std::nullopt);
+    std::ifstream file(path);
+    std::string content{std::istreambuf_iterator<char>(file),
+                        std::istreambuf_iterator<char>()};
+    EXPECT_EQ(content, registry.toPrometheus());
+    EXPECT_FALSE(fs::exists(dir / "metrics.prom.tmp"));
+    fs::remove_all(dir);
+}
+
+TEST(MeasureTest, ClassifiesErrors)
+{
+    Registry& global = registry();
+    uint64_t calls = global.calls(Operation::install);
+    uint64_t invalid = global.errors(Operation::install,
+                                     ErrorClass::invalidCertificate);
+    uint64_t notAllowed = global.errors(Operation::install,
+                                        ErrorClass::notAllowed);
+    uint64_t other = global.errors(Operation::install, ErrorClass::other);
+
+    EXPECT_EQ(measure(Operation::install, [] { return 42; }), 42);
+    EXPECT_THROW(measure(Operation::install,
+                         []() -> int { throw InvalidCertificate(); }),
+                 InvalidCertificate);
+    EXPECT_THROW(measure(Operation::install, [] { throw NotAllowed(); }),
+                 NotAllowed);
+    EXPECT_THROW(
+        measure(Operation::install, [] { throw std::runtime_error("x"); }),
+        std::runtime_error);
+
+    EXPECT_EQ(global.calls(Operation::install), calls + 4);
+    EXPECT_EQ(global.errors(Operation::install,
+                            ErrorClass::invalidCertificate),
+              invalid + 1);
+    EXPECT_EQ(global.errors(Operation::install, ErrorClass::notAllowed),
+              notAllowed + 1);
+    EXPECT_EQ(global.errors(Operation::install, ErrorClass::other),
+              other + 1);
+}
+
+TEST(MeasureTest, TimerCountsUnwindingAsFailure)
+{
+    Registry& global = registry();
+    uint64_t calls = global.calls(Operation::generateCSR);
+    uint64_t other = global.errors(Operation::generateCSR, ErrorClass::other);
+    try
+    {
+        Timer timer(Operation::generateCSR);
+        throw std::runtime_error("x");
+    }
+    catch (const std::runtime_error&)
+    {}
+    {
+        Timer timer(Operation::generateCSR);
+    }
+    EXPECT_EQ(global.calls(Operation::generateCSR), calls + 2);
+    EXPECT_EQ(global.errors(Operation::generateCSR, ErrorClass::other),
+              other + 1);
+}
+
+} // namespace
+} // namespace phosphor::certs::metrics
@@ -0,0 +1,95 @@
+#include "object_map.hpp"
+
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace phosphor::certs
+{
+namespace
+{
+
+std::vector<uint64_t> idsOf(const ObjectMap<std::string>& objects)
+{
+    std::vector<uint64_t> ids;
+    for (const auto& [id, object] : objects)
+    {
+        ids.push_back(id);
+    }
+    return ids;
+}
+
+TEST(ObjectMap, EnumeratesInIdOrder)
+{
+    ObjectMap<std::string> objects;
+    EXPECT_TRUE(objects.empty());
+    EXPECT_TRUE(objects.emplace(3, std::make_unique<std::string>("c")).second);
+    EXPECT_TRUE(objects.emplace(1, std::make_unique<std::string>("a")).second);
+    EXPECT_TRUE(objects.emplace(2, std::make_unique<std::string>("b")).second);
+    // An ID is inserted once
+    auto [it, inserted] = objects.emplace(2,
+                                          std::make_unique<std::string>("d"));
+    EXPECT_FALSE(inserted);
+    EXPECT_EQ(*it->second, "b");
+
+    EXPECT_EQ(idsOf(objects), (std::vector<uint64_t>{1, 2, 3}));
+    EXPECT_EQ(objects.size(), 3);
+    EXPECT_EQ(objects.begin()->first, 1);
+    EXPECT_EQ(objects.rbegin()->first, 3);
+    EXPECT_EQ(*objects.at(2), "b");
+    EXPECT_THROW(objects.at(4), std::out_of_range);
+    EXPECT_TRUE(objects.contains(3));
+    EXPECT_FALSE(objects.contains(4));
+    EXPECT_EQ(objects.find(4), objects.end());
+}
+
+TEST(ObjectMap, Erase)
+{
+    ObjectMap<std::string> objects;
+    for (uint64_t id = 1; id <= 5; ++id)
+    {
+        objects.emplace(id, std::make_unique<std::string>(std::to_string(id)));
+    }
+    auto next = objects.erase(objects.find(2));
+    ASSERT_NE(next, objects.end());
+    EXPECT_EQ(next->first, 3);
+    EXPECT_EQ(objects.erase(5), 1);
+    EXPECT_EQ(objects.erase(5), 0);
+    EXPECT_EQ(idsOf(objects), (std::vector<uint64_t>{1, 3, 4}));
+
+    // Erasing while enumerating
+    for (auto it = objects.begin(); it != objects.end();)
+    {
+        it = it->first == 3 ? objects.erase(it) : std::next(it);
+    }
+    EXPECT_EQ(idsOf(objects), (std::vector<uint64_t>{1, 4}));
+
+    objects.clear();
+    EXPECT_TRUE(objects.empty());
+    EXPECT_EQ(objects.begin(), objects.end());
+}
+
+TEST(ObjectMap, Merge)
+{
+    ObjectMap<std::string> objects;
+    objects.emplace(1, std::make_unique<std::string>("a"));
+    objects.emplace(3, std::make_unique<std::string>("c"));
+    ObjectMap<std::string> other;
+    other.emplace(2, std::make_unique<std::string>("b"));
+    other.emplace(3, std::make_unique<std::string>("d"));
+
+    objects.merge(other);
+    EXPECT_EQ(idsOf(objects), (std::vector<uint64_t>{1, 2, 3}));
+    EXPECT_EQ(*objects.at(3), "c");
+    // The objects whose ID is taken stay in |other|
+    EXPECT_EQ(idsOf(other), std::vector<uint64_t>{3});
+    EXPECT_EQ(*other.at(3), "d");
+}
+
+} // namespace
+} // namespace phosphor::certs
@@ -0,0 +1,78 @@
+#include "revocation_index.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace phosphor::certs
+{
+namespace
+{
+
+TEST(RevocationIndex, FindsRevokedSerialNumbers)
+{
+    RevocationIndex index;
+    index.set("CN=a", {"\x03", "\x01\x02", "\x01", std::string("\x00\x05", 2),
+                       "\x01"});
+    index.set("CN=b", {"\x04"});
+
+    EXPECT_TRUE(index.isRevoked("CN=a", "\x01"));
+    EXPECT_TRUE(index.isRevoked("CN=a", "\x01\x02"));
+    EXPECT_TRUE(index.isRevoked("CN=a", "\x03"));
+    EXPECT_TRUE(index.isRevoked("CN=a", std::string("\x00\x05", 2)));
+    EXPECT_FALSE(index.isRevoked("CN=a", "\x02"));
+    EXPECT_FALSE(index.isRevoked("CN=a", "\x01\x02\x03"));
+    EXPECT_FALSE(index.isRevoked("CN=a", "\x04"));
+    EXPECT_TRUE(index.isRevoked("CN=b", "\x04"));
+    EXPECT_FALSE(index.isRevoked("CN=c", "\x01"));
+    EXPECT_TRUE(index.contains("CN=b"));
+    EXPECT_FALSE(index.contains("CN=c"));
+    // Duplicates are counted once
+    EXPECT_EQ(index.size(), 5);
+}
+
+TEST(RevocationIndex, NewListReplacesTheOldOne)
+{
+    RevocationIndex index;
+    index.set("CN=a", {"\x01", "\x02"});
+    index.set("CN=a", {"\x03"});
+    EXPECT_FALSE(index.isRevoked("CN=a", "\x01"));
+    EXPECT_TRUE(index.isRevoked("CN=a", "\x03"));
+
+    // An empty CRL revokes nothing
+    index.set("CN=a", {});
+    EXPECT_FALSE(index.isRevoked("CN=a", "\x03"));
+    EXPECT_TRUE(index.contains("CN=a"));
+    EXPECT_EQ(index.size(), 0);
+
+    index.erase("CN=a");
+    EXPECT_FALSE(index.contains("CN=a"));
+}
+
+TEST(RevocationIndex, LargeList)
+{
+    RevocationIndex index;
+    std::vector<std::string> serialNumbers;
+    for (int i = 0; i < 65536; i += 2)
+    {
+        std::string serialNumber(16, '\x5a');
+        serialNumber[14] = static_cast<char>(i >> 8);
+        serialNumber[15] = static_cast<char>(i);
+        serialNumbers.push_back(serialNumber);
+    }
+    index.set("CN=a", serialNumbers);
+    for (int i = 0; i < 65536; ++i)
+    {
+        std::string serialNumber(16, '\x5a');
+        serialNumber[14] = static_cast<char>(i >> 8);
+        serialNumber[15] = static_cast<char>(i);
+        EXPECT_EQ(index.isRevoked("CN=a", serialNumber), i % 2 == 0) << i;
+    }
+    // The serial numbers and their offsets
+    EXPECT_GE(index.memoryUsage(), 32768 * (16 + sizeof(uint32_t)));
+}
+
+} // namespace
+} // namespace phosphor::certs
@@ -0,0 +1,119 @@
+#include "startup_trace.hpp"
+
+#include <unistd.h>
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <new>
+#include <string>
+#include <thread>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace phosphor::certs::trace
+{
+namespace
+{
+
+namespace fs = std::filesystem;
+using ::testing::HasSubstr;
+using ::testing::Not;
+
+class StartupTraceTest : public ::testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        char dirTemplate[] = "/tmp/FakeCerts.XXXXXX";
+        auto dirPtr = mkdtemp(dirTemplate);
+        if (dirPtr == nullptr)
+        {
+            throw std::bad_alloc();
+        }
+        dir = dirPtr;
+        path = dir / "trace.json";
+    }
+
+    void TearDown() override
+    {
+        finish();
+        fs::remove_all(dir);
+    }
+
+    std::string readTrace() const
+    {
+        std::ifstream file(path);
+        return {std::istreambuf_iterator<char>(file),
+                std::istreambuf_iterator<char>()};
+    }
+
+    fs::path dir;
+    fs::path path;
+};
+
+TEST_F(StartupTraceTest, DisabledByDefault)
+{
+    EXPECT_FALSE(enabled());
+    {
+        Span span("restore");
+        span.arg("file", "/etc/ssl/certs/authority/cert");
+    }
+    finish();
+    EXPECT_FALSE(fs::exists(path));
+}
+
+TEST_F(StartupTraceTest, RecordsSpans)
+{
+    start(path, "authority/truststore");
+    EXPECT_TRUE(enabled());
+    {
+        Span restore("restore");
+        Span parse("parse");
+        parse.arg("file", "/etc/ssl/certs/authority/\"quoted\"");
+        parse.arg("bytes", uint64_t{1234});
+        parse.end();
+        // Recorded once
+        parse.end();
+    }
+    std::thread([] { Span span("validate"); }).join();
+    finish();
+    EXPECT_FALSE(enabled());
+
+    std::string trace = readTrace();
+    EXPECT_THAT(trace, HasSubstr("{\"traceEvents\":["));
+    EXPECT_THAT(trace,
+                HasSubstr("\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" +
+                          std::to_string(getpid())));
+    EXPECT_THAT(trace,
+                HasSubstr("\"args\":{\"name\":\"authority/truststore\"}"));
+    EXPECT_THAT(trace, HasSubstr("{\"name\":\"restore\",\"cat\":\"startup\","
+                                 "\"ph\":\"X\",\"ts\":"));
+    EXPECT_THAT(trace, HasSubstr("\"args\":{\"file\":\"/etc/ssl/certs/"
+                                 "authority/\\\"quoted\\\"\",\"bytes\":1234}"));
+    EXPECT_THAT(trace, HasSubstr("{\"name\":\"validate\""));
+    EXPECT_EQ(trace.find("\"name\":\"parse\""),
+              trace.rfind("\"name\":\"parse\""));
+    EXPECT_FALSE(fs::exists(dir / "trace.json.tmp"));
+}
+
+TEST_F(StartupTraceTest, SpansAfterFinishAreDropped)
+{
+    start(path, "server/https");
+    Span late("late");
+    finish();
+    late.end();
+    {
+        Span after("after");
+    }
+    finish();
+
+    std::string trace = readTrace();
+    EXPECT_THAT(trace, Not(HasSubstr("\"late\"")));
+    EXPECT_THAT(trace, Not(HasSubstr("\"after\"")));
+}
+
+} // namespace
+} // namespace phosphor::certs::trace
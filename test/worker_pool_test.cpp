@@ -0,0 +1,67 @@
+#include "worker_pool.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace phosphor::certs
+{
+namespace
+{
+
+TEST(ParallelMap, ResultsFollowInputOrder)
+{
+    std::vector<int> inputs;
+    for (int i = 0; i < 100; ++i)
+    {
+        inputs.push_back(i);
+    }
+    auto results = parallelMap(inputs, 4, [](int i) { return i * 2; });
+    ASSERT_EQ(results.size(), inputs.size());
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        ASSERT_TRUE(results[i].value);
+        EXPECT_EQ(*results[i].value, inputs[i] * 2);
+        EXPECT_FALSE(results[i].error);
+    }
+}
+
+TEST(ParallelMap, ExceptionsAreCapturedPerTask)
+{
+    std::vector<std::string> inputs{"1", "x", "3"};
+    auto results = parallelMap(inputs, 2, [](const std::string& s) {
+        return std::stoi(s);
+    });
+    ASSERT_EQ(results.size(), 3);
+    EXPECT_EQ(*results[0].value, 1);
+    EXPECT_FALSE(results[1].value);
+    EXPECT_THROW(std::rethrow_exception(results[1].error),
+                 std::invalid_argument);
+    EXPECT_EQ(*results[2].value, 3);
+}
+
+TEST(ParallelMap, EveryInputRunsOnce)
+{
+    std::vector<int> inputs(1000, 1);
+    std::atomic<int> calls = 0;
+    auto results = parallelMap(inputs, 8, [&calls](int i) {
+        calls++;
+        return i;
+    });
+    EXPECT_EQ(calls, 1000);
+    EXPECT_EQ(results.size(), 1000);
+}
+
+TEST(ParallelMap, EmptyInput)
+{
+    std::vector<int> inputs;
+    auto results = parallelMap(inputs, 4, [](int i) { return i; });
+    EXPECT_TRUE(results.empty());
+}
+
+} // namespace
+} // namespace phosphor::certs
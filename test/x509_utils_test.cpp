@@ -0,0 +1,331 @@
+#include "keygen.hpp"
+#include "x509_utils.hpp"
+
+#include <openssl/evp.h>
+#include <openssl/x509.h>
+#include <openssl/x509v3.h>
+
+#include <xyz/openbmc_project/Certs/error.hpp>
+
+#include <cstdlib>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <string>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace phosphor::certs
+{
+namespace
+{
+
+namespace fs = std::filesystem;
+using ::sdbusplus::xyz::openbmc_project::Certs::Error::InvalidCertificate;
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+using X509Ptr = std::unique_ptr<X509, decltype(&::X509_free)>;
+using ASN1TimePtr = std::unique_ptr<ASN1_TIME, decltype(&ASN1_STRING_free)>;
+using ASN1IntegerPtr =
+    std::unique_ptr<ASN1_INTEGER, decltype(&::ASN1_INTEGER_free)>;
+
+class ExtractPropertiesTest : public ::testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        ASSERT_TRUE(cert);
+        ASSERT_EQ(X509_set_version(cert.get(), X509_VERSION_3), 1);
+        // 2021-01-01T00:00:00Z and 2031-01-01T00:00:00Z
+        ASSERT_EQ(ASN1_TIME_set_string(X509_getm_notBefore(cert.get()),
+                                       "20210101000000Z"),
+                  1);
+        ASSERT_EQ(ASN1_TIME_set_string(X509_getm_notAfter(cert.get()),
+                                       "20310101000000Z"),
+                  1);
+    }
+
+    void addEntry(X509_NAME* name, const char* field, const std::string& value,
+                  int set = 0)
+    {
+        ASSERT_EQ(X509_NAME_add_entry_by_txt(
+                      name, field, MBSTRING_UTF8,
+                      reinterpret_cast<const unsigned char*>(value.c_str()),
+                      -1, -1, set),
+                  1);
+    }
+
+    void addExtension(int nid, const char* value)
+    {
+        X509_EXTENSION* ext = X509V3_EXT_conf_nid(nullptr, nullptr, nid,
+                                                  value);
+        ASSERT_NE(ext, nullptr);
+        ASSERT_EQ(X509_add_ext(cert.get(), ext, -1), 1);
+        X509_EXTENSION_free(ext);
+    }
+
+    // OpenSSL only caches the extensions of a complete certificate
+    void sign()
+    {
+        auto key = generateECKeyPair("prime256v1");
+        ASSERT_EQ(X509_set_pubkey(cert.get(), key.get()), 1);
+        ASSERT_GT(X509_sign(cert.get(), key.get(), EVP_sha256()), 0);
+    }
+
+    X509Ptr cert{X509_new(), ::X509_free};
+};
+
+TEST_F(ExtractPropertiesTest, Names)
+{
+    X509_NAME* subject = X509_get_subject_name(cert.get());
+    addEntry(subject, "C", "US");
+    addEntry(subject, "O", "Example");
+    addEntry(subject, "OU", "BMC", -1);
+    addEntry(subject, "CN", "bmc.example.com");
+    X509_NAME* issuer = X509_get_issuer_name(cert.get());
+    addEntry(issuer, "CN", "Café CA");
+
+    auto properties = extractProperties(*cert);
+    EXPECT_EQ(properties.subject, "C=US,O=Example+OU=BMC,CN=bmc.example.com");
+    EXPECT_EQ(properties.issuer, "CN=Café CA");
+}
+
+TEST_F(ExtractPropertiesTest, SerialNumber)
+{
+    ASSERT_EQ(ASN1_INTEGER_set_uint64(X509_get_serialNumber(cert.get()),
+                                      0x1a2b3c4d5e6fULL),
+              1);
+    EXPECT_EQ(formatSerialNumber(*cert), "1A2B3C4D5E6F");
+}
+
+TEST_F(ExtractPropertiesTest, SerialNumberBytesKeepTheSign)
+{
+    ASN1_INTEGER* serialNumber = X509_get_serialNumber(cert.get());
+    ASSERT_EQ(ASN1_INTEGER_set(serialNumber, 5), 1);
+    auto positive = getSerialNumberBytes(*serialNumber);
+    ASSERT_EQ(ASN1_INTEGER_set(serialNumber, -5), 1);
+    auto negative = getSerialNumberBytes(*serialNumber);
+    EXPECT_NE(positive, negative);
+    ASSERT_EQ(ASN1_INTEGER_set(serialNumber, 5), 1);
+    EXPECT_EQ(getSerialNumberBytes(*serialNumber), positive);
+}
+
+TEST_F(ExtractPropertiesTest, NoKeyIds)
+{
+    sign();
+    EXPECT_EQ(getSubjectKeyId(*cert), std::nullopt);
+    EXPECT_EQ(getAuthorityKeyId(*cert), std::nullopt);
+}
+
+TEST_F(ExtractPropertiesTest, KeyIds)
+{
+    addExtension(NID_subject_key_identifier, "0A:1B:2C");
+    AUTHORITY_KEYID* authorityKeyId = AUTHORITY_KEYID_new();
+    ASSERT_NE(authorityKeyId, nullptr);
+    authorityKeyId->keyid = ASN1_OCTET_STRING_new();
+    ASSERT_EQ(ASN1_OCTET_STRING_set(authorityKeyId->keyid,
+                                    reinterpret_cast<const unsigned char*>(
+                                        "\x3d\x4e"),
+                                    2),
+              1);
+    ASSERT_EQ(X509_add1_ext_i2d(cert.get(), NID_authority_key_identifier,
+                                authorityKeyId, 0, X509V3_ADD_DEFAULT),
+              1);
+    AUTHORITY_KEYID_free(authorityKeyId);
+    sign();
+
+    EXPECT_EQ(getSubjectKeyId(*cert), "0a1b2c");
+    EXPECT_EQ(getAuthorityKeyId(*cert), "3d4e");
+}
+
+TEST_F(ExtractPropertiesTest, LongNameIsNotTruncated)
+{
+    std::string expected;
+    X509_NAME* subject = X509_get_subject_name(cert.get());
+    for (int i = 0; i < 80; ++i)
+    {
+        std::string unit = "unit-" + std::to_string(i) + std::string(50, 'x');
+        addEntry(subject, "OU", unit);
+        expected += (i == 0 ? "OU=" : ",OU=") + unit;
+    }
+    ASSERT_GT(expected.size(), 4096U);
+
+    EXPECT_EQ(extractProperties(*cert).subject, expected);
+}
+
+TEST_F(ExtractPropertiesTest, KeyUsage)
+{
+    addExtension(NID_key_usage,
+                 "digitalSignature,keyEncipherment,keyAgreement,decipherOnly");
+    addExtension(NID_ext_key_usage, "serverAuth,clientAuth,codeSigning");
+
+    EXPECT_THAT(extractProperties(*cert).keyUsage,
+                ElementsAre("DigitalSignature", "KeyEncipherment",
+                            "KeyAgreement", "DecipherOnly",
+                            "ServerAuthentication", "ClientAuthentication",
+                            "CodeSigning"));
+}
+
+TEST_F(ExtractPropertiesTest, NoKeyUsage)
+{
+    EXPECT_THAT(extractProperties(*cert).keyUsage, IsEmpty());
+}
+
+TEST_F(ExtractPropertiesTest, Validity)
+{
+    auto properties = extractProperties(*cert);
+    EXPECT_EQ(properties.validNotBefore, 1609459200U);
+    EXPECT_EQ(properties.validNotAfter, 1924992000U);
+}
+
+class StorageFormatTest : public ::testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        char dirTemplate[] = "/tmp/FakeCerts.XXXXXX";
+        ASSERT_NE(mkdtemp(dirTemplate), nullptr);
+        dir = dirTemplate;
+    }
+
+    void TearDown() override
+    {
+        fs::remove_all(dir);
+    }
+
+    static X509Ptr makeCertificate(const std::string& cn)
+    {
+        auto pKey = generateECKeyPair("prime256v1");
+        X509Ptr cert(X509_new(), ::X509_free);
+        X509_set_version(cert.get(), X509_VERSION_3);
+        X509_gmtime_adj(X509_getm_notBefore(cert.get()), 0);
+        X509_gmtime_adj(X509_getm_notAfter(cert.get()), 24 * 60 * 60);
+        X509_NAME* name = X509_get_subject_name(cert.get());
+        X509_NAME_add_entry_by_txt(
+            name, "CN", MBSTRING_ASC,
+            reinterpret_cast<const unsigned char*>(cn.c_str()), -1, -1, 0);
+        X509_set_issuer_name(cert.get(), name);
+        X509_set_pubkey(cert.get(), pKey.get());
+        X509_sign(cert.get(), pKey.get(), EVP_sha256());
+        return cert;
+    }
+
+    std::string writeFile(const std::string& name, const std::string& data)
+    {
+        std::string path = dir / name;
+        std::ofstream(path, std::ios::binary) << data;
+        return path;
+    }
+
+    fs::path dir;
+};
+
+TEST_F(StorageFormatTest, Detect)
+{
+    auto cert = makeCertificate("root");
+    EXPECT_EQ(detectStorageFormat(encodeCertificate(*cert, StorageFormat::der)),
+              StorageFormat::der);
+    EXPECT_EQ(detectStorageFormat(encodeCertificate(*cert, StorageFormat::pem)),
+              StorageFormat::pem);
+    EXPECT_EQ(detectStorageFormat("0\x82 is not PEM, but 00 is"),
+              StorageFormat::der);
+    EXPECT_EQ(detectStorageFormat("00"), StorageFormat::pem);
+    EXPECT_EQ(detectStorageFormat(""), StorageFormat::pem);
+}
+
+TEST_F(StorageFormatTest, LoadEitherFormat)
+{
+    auto cert = makeCertificate("root");
+    for (auto format : {StorageFormat::pem, StorageFormat::der})
+    {
+        auto path = writeFile(storageFormatToString(format),
+                              encodeCertificate(*cert, format));
+        EXPECT_EQ(getFileStorageFormat(path), format);
+        auto loaded = loadCert(path);
+        EXPECT_EQ(X509_cmp(loaded.get(), cert.get()), 0);
+        EXPECT_NO_THROW(getX509Store(path));
+    }
+}
+
+TEST_F(StorageFormatTest, LoadList)
+{
+    auto first = makeCertificate("first");
+    auto second = makeCertificate("second");
+    auto der = writeFile("der",
+                         encodeCertificate(*first, StorageFormat::der) +
+                             encodeCertificate(*second, StorageFormat::der));
+    auto pem = writeFile("pem",
+                         "first\n" +
+                             encodeCertificate(*first, StorageFormat::pem) +
+                             "second\n" +
+                             encodeCertificate(*second, StorageFormat::pem));
+    for (const auto& path : {der, pem})
+    {
+        auto certs = loadCertificates(path);
+        ASSERT_EQ(certs.size(), 2U);
+        EXPECT_EQ(X509_cmp(certs[0].get(), first.get()), 0);
+        EXPECT_EQ(X509_cmp(certs[1].get(), second.get()), 0);
+    }
+}
+
+TEST_F(StorageFormatTest, LoadInvalidList)
+{
+    EXPECT_THROW(loadCertificates(writeFile("text", "blah-blah")),
+                 InvalidCertificate);
+    EXPECT_THROW(
+        loadCertificates(writeFile("begin", "-----BEGIN CERTIFICATE-----")),
+        InvalidCertificate);
+    auto cert = makeCertificate("root");
+    auto der = encodeCertificate(*cert, StorageFormat::der);
+    auto truncated = writeFile("truncated", der + der.substr(0, 100));
+    EXPECT_THROW(loadCertificates(truncated), InvalidCertificate);
+}
+
+TEST_F(StorageFormatTest, Fingerprint)
+{
+    auto cert = makeCertificate("root");
+    auto fingerprint = generateFingerprint(*cert);
+    EXPECT_EQ(fingerprint.size(), 64U);
+    EXPECT_EQ(fingerprint.find_first_not_of("0123456789abcdef"),
+              std::string::npos);
+    auto copy = loadCert(
+        writeFile("der", encodeCertificate(*cert, StorageFormat::der)));
+    EXPECT_EQ(generateFingerprint(*copy), fingerprint);
+    EXPECT_NE(generateFingerprint(*makeCertificate("root")), fingerprint);
+}
+
+TEST(CrlOrderTest, IsNewerCrl)
+{
+    auto makeCrl = [](time_t lastUpdate, std::optional<long> number) {
+        X509CrlPtr crl(X509_CRL_new(), ::X509_CRL_free);
+        ASN1TimePtr time(ASN1_TIME_set(nullptr, lastUpdate),
+                         ASN1_STRING_free);
+        X509_CRL_set1_lastUpdate(crl.get(), time.get());
+        if (number)
+        {
+            ASN1IntegerPtr crlNumber(ASN1_INTEGER_new(), ::ASN1_INTEGER_free);
+            ASN1_INTEGER_set(crlNumber.get(), *number);
+            X509_CRL_add1_ext_i2d(crl.get(), NID_crl_number, crlNumber.get(),
+                                  0, 0);
+        }
+        return crl;
+    };
+
+    // The lastUpdate times, when either CRL has no number
+    auto crl = makeCrl(2000, std::nullopt);
+    EXPECT_TRUE(isNewerCrl(*crl, *makeCrl(1000, std::nullopt)));
+    EXPECT_FALSE(isNewerCrl(*crl, *makeCrl(2000, std::nullopt)));
+    EXPECT_FALSE(isNewerCrl(*crl, *makeCrl(3000, 1)));
+
+    // The numbers otherwise, whatever the times
+    crl = makeCrl(1000, 2);
+    EXPECT_TRUE(isNewerCrl(*crl, *makeCrl(2000, 1)));
+    EXPECT_FALSE(isNewerCrl(*crl, *makeCrl(500, 2)));
+    EXPECT_FALSE(isNewerCrl(*crl, *makeCrl(500, 3)));
+}
+
+} // namespace
+} // namespace phosphor::certs
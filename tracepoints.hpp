@@ -0,0 +1,72 @@
+#pragma once
+
+#include "config.h"
+
+#include <exception>
+#include <utility>
+
+/** @file
+ *  @brief Static tracepoints for perf, bpftrace or SystemTap.
+ *  @details With the tracepoints build option, each probe is a nop in the
+ *  code and a note in the ELF file, enabled by the tracer attaching to it;
+ *  without it the probes, and their arguments, compile to nothing. The
+ *  probes are listed in the "phosphor_certs" provider, e.g. with
+ *  `bpftrace -l 'usdt:/usr/bin/phosphor-certificate-manager:*'`. Arguments
+ *  are integers or C strings.
+ */
+
+#ifdef CERTS_TRACEPOINTS
+#include <sys/sdt.h>
+
+/** @brief Fire the probe |name| with the arguments given */
+#define CERTS_PROBE(name, ...)                                                 \
+    STAP_PROBEV(phosphor_certs, name __VA_OPT__(, ) __VA_ARGS__)
+
+#define CERTS_PROBE_CONCAT_(a, b) a##b
+#define CERTS_PROBE_CONCAT(a, b) CERTS_PROBE_CONCAT_(a, b)
+
+/** @brief Fire the probe |name| when leaving the scope, with the arguments
+ *  given, evaluated then, and a last argument of 0, or -1 if leaving it
+ *  by an exception.
+ */
+#define CERTS_PROBE_RETURN(name, ...)                                          \
+    auto CERTS_PROBE_CONCAT(certsProbeReturn, __LINE__) =                      \
+        ::phosphor::certs::probe::Return([&](int certsProbeResult) {           \
+        CERTS_PROBE(name __VA_OPT__(, ) __VA_ARGS__, certsProbeResult);        \
+    })
+#else
+#define CERTS_PROBE(name, ...) static_cast<void>(0)
+#define CERTS_PROBE_RETURN(name, ...) static_cast<void>(0)
+#endif
+
+namespace phosphor::certs::probe
+{
+
+/** @class Return
+ *  @brief Call a function with the result code of the scope on leaving it.
+ */
+template <typename Fire>
+class Return
+{
+  public:
+    Return() = delete;
+    Return(const Return&) = delete;
+    Return& operator=(const Return&) = delete;
+    Return(Return&&) = delete;
+    Return& operator=(Return&&) = delete;
+
+    explicit Return(Fire fire) :
+        fire(std::move(fire)), exceptions(std::uncaught_exceptions())
+    {}
+
+    ~Return()
+    {
+        fire(std::uncaught_exceptions() > exceptions ? -1 : 0);
+    }
+
+  private:
+    Fire fire;
+    int exceptions;
+};
+
+} // namespace phosphor::certs::probe
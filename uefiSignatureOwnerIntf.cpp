@@ -5,6 +5,8 @@
 #include <cereal/archives/binary.hpp>
 #include <cereal/types/string.hpp>
 
+#include <utility>
+
 // Register class version
 // From cereal documentation;
 // "This macro should be placed at global scope"
@@ -59,9 +61,10 @@ UefiSignatureOwnerIntf::~UefiSignatureOwnerIntf()
 
 UefiSignatureOwnerIntf::UefiSignatureOwnerIntf(sdbusplus::bus::bus& bus,
                                                const std::string& objPath,
-                                               const std::string& filePath) :
+                                               const std::string& filePath,
+                                               Changed changed) :
     UUID(bus, objPath.c_str()),
-    ownerFilePath(filePath)
+    ownerFilePath(filePath), changed(std::move(changed))
 {
     if (!ownerFilePath.empty())
     {
@@ -104,6 +107,10 @@ std::string UefiSignatureOwnerIntf::uuid(std::string value)
             elog<InternalFailure>();
         }
     }
+    if (changed)
+    {
+        changed(value);
+    }
     return value;
 }
 
@@ -8,6 +8,7 @@
 
 #include <filesystem>
 #include <fstream>
+#include <functional>
 #include <string>
 
 namespace phosphor::certs
@@ -45,18 +46,26 @@ class UefiSignatureOwnerIntf : public UUID
     UefiSignatureOwnerIntf& operator=(UefiSignatureOwnerIntf&&) = delete;
     virtual ~UefiSignatureOwnerIntf();
 
+    /** @brief Called with the new owner when it is set */
+    using Changed = std::function<void(const std::string& uuid)>;
+
     /** @brief Constructor for the UefiSignatureOwnerIntf Object
      *  @param[in] bus - Bus to attach to.
      *  @param[in] objPath - Object path to attach to
      *  @param[in] filePath - Path of the UefiSignatureOwner to store
+     *  @param[in] changed - Optional callback of the owner changes; the
+     *  owner loaded from |filePath| is not one
      */
     UefiSignatureOwnerIntf(sdbusplus::bus::bus& bus, const std::string& objPath,
-                           const std::string& filePath);
+                           const std::string& filePath,
+                           Changed changed = nullptr);
 
     std::string uuid(std::string value) override;
 
   private:
     std::string ownerFilePath;
+
+    Changed changed;
 };
 
 } // namespace internal
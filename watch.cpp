@@ -1,5 +1,7 @@
 #include "watch.hpp"
 
+#include "tracepoints.hpp"
+
 #include <sys/epoll.h>
 #include <sys/inotify.h>
 #include <unistd.h>
@@ -78,6 +80,7 @@ void Watch::startWatch()
         constexpr int size = sizeof(struct inotify_event) + NAME_MAX + 1;
         std::array<char, size> buffer{};
         int length = read(fd, buffer.data(), buffer.size());
+        CERTS_PROBE(watch_event, watchDir.c_str(), length);
         if (length >= static_cast<int>(sizeof(struct inotify_event)))
         {
             struct inotify_event* notifyEvent =
@@ -86,6 +89,10 @@ void Watch::startWatch()
             {
                 if (watchFile == notifyEvent->name)
                 {
+                    CERTS_PROBE(watch_callback_entry, watchDir.c_str(),
+                                watchFile.c_str());
+                    CERTS_PROBE_RETURN(watch_callback_return,
+                                       watchDir.c_str(), watchFile.c_str());
                     callback();
                 }
             }
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <optional>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace phosphor::certs
+{
+
+/** @brief Outcome of a single task run by parallelMap() */
+template <typename T>
+struct TaskResult
+{
+    /** @brief Value returned by the task, if it did not throw */
+    std::optional<T> value;
+
+    /** @brief Exception thrown by the task, if any */
+    std::exception_ptr error;
+};
+
+/** @brief Run |task| on every element of |inputs| with at most |maxWorkers|
+ *  threads, the calling thread included.
+ *
+ *  Tasks must not touch D-Bus objects or the event loop; they are meant for
+ *  the file reading and parsing part of a restore. Results are returned in
+ *  input order, and an exception thrown by a task is captured in its result
+ *  so that the caller can handle it on the calling thread.
+ *
+ *  @param[in] inputs - Task inputs.
+ *  @param[in] maxWorkers - Upper bound of concurrently running tasks.
+ *  @param[in] task - Callable invoked once per input.
+ *
+ *  @return Task results, one per input.
+ */
+template <typename Input, typename Task>
+auto parallelMap(const std::vector<Input>& inputs, size_t maxWorkers,
+                 Task task)
+    -> std::vector<TaskResult<std::invoke_result_t<Task&, const Input&>>>
+{
+    using Result = TaskResult<std::invoke_result_t<Task&, const Input&>>;
+    std::vector<Result> results(inputs.size());
+    std::atomic<size_t> nextIndex = 0;
+
+    auto worker = [&inputs, &results, &nextIndex, &task]() {
+        for (size_t i = nextIndex++; i < inputs.size(); i = nextIndex++)
+        {
+            try
+            {
+                results[i].value.emplace(task(inputs[i]));
+            }
+            catch (...)
+            {
+                results[i].error = std::current_exception();
+            }
+        }
+    };
+
+    size_t cores = std::max(1U, std::thread::hardware_concurrency());
+    size_t workers = std::min({maxWorkers, inputs.size(), cores});
+    {
+        std::vector<std::jthread> threads;
+        for (size_t i = 1; i < workers; ++i)
+        {
+            try
+            {
+                threads.emplace_back(worker);
+            }
+            catch (const std::system_error&)
+            {
+                // Out of threads; the ones already running pick up the rest.
+                break;
+            }
+        }
+        worker();
+    }
+    return results;
+}
+
+} // namespace phosphor::certs
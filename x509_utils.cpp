@@ -2,13 +2,21 @@
 
 #include "x509_utils.hpp"
 
+#include "file_content.hpp"
+#include "metrics.hpp"
+#include "tracepoints.hpp"
+
 #include <openssl/asn1.h>
 #include <openssl/bio.h>
+#include <openssl/bn.h>
+#include <openssl/buffer.h>
 #include <openssl/err.h>
 #include <openssl/evp.h>
+#include <openssl/objects.h>
 #include <openssl/pem.h>
 #include <openssl/ssl3.h>
 #include <openssl/x509_vfy.h>
+#include <openssl/x509v3.h>
 
 #include <phosphor-logging/elog-errors.hpp>
 #include <phosphor-logging/elog.hpp>
@@ -16,10 +24,20 @@
 #include <xyz/openbmc_project/Certs/error.hpp>
 #include <xyz/openbmc_project/Common/error.hpp>
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
 #include <cstdio>
 #include <ctime>
 #include <exception>
+#include <fstream>
 #include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
 
 namespace phosphor::certs
 {
@@ -40,8 +58,17 @@ using X509StoreCtxPtr =
 using X509Ptr = std::unique_ptr<X509, decltype(&::X509_free)>;
 using BIOMemPtr = std::unique_ptr<BIO, decltype(&::BIO_free)>;
 using ASN1TimePtr = std::unique_ptr<ASN1_TIME, decltype(&ASN1_STRING_free)>;
+using ASN1IntegerPtr =
+    std::unique_ptr<ASN1_INTEGER, decltype(&::ASN1_INTEGER_free)>;
 using SSLCtxPtr = std::unique_ptr<SSL_CTX, decltype(&::SSL_CTX_free)>;
 
+void freeX509Infos(STACK_OF(X509_INFO) * infos)
+{
+    sk_X509_INFO_pop_free(infos, X509_INFO_free);
+}
+using X509InfoStackPtr =
+    std::unique_ptr<STACK_OF(X509_INFO), decltype(&freeX509Infos)>;
+
 // Trust chain related errors.`
 constexpr bool isTrustChainError(int error)
 {
@@ -52,8 +79,144 @@ constexpr bool isTrustChainError(int error)
            error == X509_V_ERR_CERT_UNTRUSTED ||
            error == X509_V_ERR_UNABLE_TO_VERIFY_LEAF_SIGNATURE;
 }
+
+struct UsageName
+{
+    uint32_t flag;
+    std::string_view name;
+};
+
+// Refer to schema 2018.3
+// http://redfish.dmtf.org/schemas/v1/Certificate.json#/definitions/KeyUsage for
+// supported KeyUsage types in redfish
+// Refer to
+// https://github.com/openssl/openssl/blob/master/include/openssl/x509v3.h for
+// key usage bit fields
+constexpr std::array<UsageName, 9> keyUsageNames = {{
+    {KU_DIGITAL_SIGNATURE, "DigitalSignature"},
+    {KU_NON_REPUDIATION, "NonRepudiation"},
+    {KU_KEY_ENCIPHERMENT, "KeyEncipherment"},
+    {KU_DATA_ENCIPHERMENT, "DataEncipherment"},
+    {KU_KEY_AGREEMENT, "KeyAgreement"},
+    {KU_KEY_CERT_SIGN, "KeyCertSign"},
+    {KU_CRL_SIGN, "CRLSigning"},
+    {KU_ENCIPHER_ONLY, "EncipherOnly"},
+    {KU_DECIPHER_ONLY, "DecipherOnly"},
+}};
+
+// Extended key usages with a Redfish KeyUsage counterpart, by the flag
+// OpenSSL sets for them
+constexpr std::array<UsageName, 6> extendedKeyUsageNames = {{
+    {XKU_SSL_SERVER, "ServerAuthentication"},
+    {XKU_SSL_CLIENT, "ClientAuthentication"},
+    {XKU_SMIME, "EmailProtection"},
+    {XKU_OCSP_SIGN, "OCSPSigning"},
+    {XKU_TIMESTAMP, "Timestamping"},
+    {XKU_CODE_SIGN, "CodeSigning"},
+}};
+
+template <size_t N>
+void appendUsages(uint32_t flags, const std::array<UsageName, N>& names,
+                  std::vector<std::string>& usages)
+{
+    for (const auto& usage : names)
+    {
+        if ((flags & usage.flag) != 0)
+        {
+            usages.emplace_back(usage.name);
+        }
+    }
+}
+
+void appendNameValue(const ASN1_STRING& value, std::string& out)
+{
+    const auto* data = reinterpret_cast<const char*>(
+        ASN1_STRING_get0_data(&value));
+    switch (ASN1_STRING_type(&value))
+    {
+        case V_ASN1_UTF8STRING:
+        case V_ASN1_PRINTABLESTRING:
+        case V_ASN1_IA5STRING:
+        case V_ASN1_NUMERICSTRING:
+            // Already UTF-8
+            out.append(data, ASN1_STRING_length(&value));
+            return;
+        default:
+            break;
+    }
+
+    unsigned char* utf8 = nullptr;
+    int length = ASN1_STRING_to_UTF8(&utf8, &value);
+    if (length < 0)
+    {
+        // Not a character string; keep its bytes
+        out.append(data, ASN1_STRING_length(&value));
+        return;
+    }
+    out.append(reinterpret_cast<const char*>(utf8), length);
+    OPENSSL_free(utf8);
+}
+
+uint64_t toEpochSeconds(const ASN1_TIME& time)
+{
+    struct tm tm = {};
+    if (ASN1_TIME_to_tm(&time, &tm) != 1)
+    {
+        lg2::error("Error occurred during ASN1_TIME_to_tm call");
+        return 0;
+    }
+    // Times before the epoch are rejected on install; see
+    // validateCertificateStartDate()
+    return static_cast<uint64_t>(timegm(&tm));
+}
+
+std::string toHex(const unsigned char* data, size_t length)
+{
+    static constexpr std::string_view hexDigits = "0123456789abcdef";
+    std::string hex;
+    hex.reserve(2 * length);
+    for (size_t i = 0; i < length; ++i)
+    {
+        hex += hexDigits[data[i] >> 4];
+        hex += hexDigits[data[i] & 0xf];
+    }
+    return hex;
+}
+
+std::optional<std::string> toKeyId(const ASN1_OCTET_STRING* keyId)
+{
+    if (keyId == nullptr)
+    {
+        return std::nullopt;
+    }
+    return toHex(ASN1_STRING_get0_data(keyId),
+                 static_cast<size_t>(ASN1_STRING_length(keyId)));
+}
 } // namespace
 
+StorageFormat detectStorageFormat(std::string_view data)
+{
+    // A certificate is a SEQUENCE (0x30) longer than 127 bytes, so its
+    // length takes the long form: 0x80 plus the number of length octets.
+    // The second byte of a PEM file is text, which never has that bit set.
+    if (data.size() >= 2 && static_cast<uint8_t>(data[0]) == 0x30 &&
+        static_cast<uint8_t>(data[1]) >= 0x81 &&
+        static_cast<uint8_t>(data[1]) <= 0x84)
+    {
+        return StorageFormat::der;
+    }
+    return StorageFormat::pem;
+}
+
+StorageFormat getFileStorageFormat(const std::string& filePath)
+{
+    std::array<char, 2> head{};
+    std::ifstream file(filePath, std::ios::binary);
+    file.read(head.data(), head.size());
+    return detectStorageFormat(
+        std::string_view(head.data(), static_cast<size_t>(file.gcount())));
+}
+
 X509StorePtr getX509Store(const std::string& certSrcPath)
 {
     // Create an empty X509_STORE structure for certificate validation.
@@ -66,30 +229,95 @@ X509StorePtr getX509Store(const std::string& certSrcPath)
 
     OpenSSL_add_all_algorithms();
 
-    // ADD Certificate Lookup method.
-    // lookup will be cleaned up automatically when the holding Store goes away.
-    auto lookup = X509_STORE_add_lookup(x509Store.get(), X509_LOOKUP_file());
+    // Load the Certificate file into X509 Store; this is what
+    // X509_LOOKUP_load_file() does, minus the stdio buffering.
+    std::optional<FileContent> file;
+    try
+    {
+        file.emplace(certSrcPath);
+    }
+    catch (const std::system_error& e)
+    {
+        lg2::error("Failed to read file, FILE:{FILE}, ERR:{ERR}", "FILE",
+                   certSrcPath, "ERR", e);
+        elog<InvalidCertificate>(Reason("Invalid certificate file format"));
+    }
+    if (detectStorageFormat(file->view()) == StorageFormat::der)
+    {
+        int count = 0;
+        std::string_view data = file->view();
+        const auto* begin = reinterpret_cast<const unsigned char*>(data.data());
+        const auto* end = begin + data.size();
+        for (const auto* p = begin; p < end;)
+        {
+            X509Ptr cert(d2i_X509(nullptr, &p, end - p), ::X509_free);
+            if (!cert || !X509_STORE_add_cert(x509Store.get(), cert.get()))
+            {
+                count = 0;
+                break;
+            }
+            ++count;
+        }
+        if (count == 0)
+        {
+            lg2::error("Error occurred during d2i_X509 call, FILE:{FILE}",
+                       "FILE", certSrcPath);
+            elog<InvalidCertificate>(
+                Reason("Invalid certificate file format"));
+        }
+        metrics::count(metrics::Counter::opensslParses, count);
+        return x509Store;
+    }
 
-    if (!lookup)
+    BIOMemPtr bio = file->bio();
+    if (!bio)
     {
-        lg2::error("Error occurred during X509_STORE_add_lookup call");
+        lg2::error("Error occurred during BIO_new_mem_buf call");
         elog<InternalFailure>();
     }
-    // Load the Certificate file into X509 Store.
-    if (int errCode = X509_LOOKUP_load_file(lookup, certSrcPath.c_str(),
-                                            X509_FILETYPE_PEM);
-        errCode != 1)
+    X509InfoStackPtr infos(
+        PEM_X509_INFO_read_bio(bio.get(), nullptr, nullptr, nullptr),
+        freeX509Infos);
+    int count = 0;
+    for (int i = 0; infos && i < sk_X509_INFO_num(infos.get()); ++i)
+    {
+        X509_INFO* info = sk_X509_INFO_value(infos.get(), i);
+        if (info->x509 != nullptr)
+        {
+            if (!X509_STORE_add_cert(x509Store.get(), info->x509))
+            {
+                count = 0;
+                break;
+            }
+            ++count;
+        }
+        if (info->crl != nullptr)
+        {
+            if (!X509_STORE_add_crl(x509Store.get(), info->crl))
+            {
+                count = 0;
+                break;
+            }
+            ++count;
+        }
+    }
+    if (count == 0)
     {
         lg2::error(
-            "Error occurred during X509_LOOKUP_load_file call, FILE:{FILE}",
+            "Error occurred during PEM_X509_INFO_read_bio call, FILE:{FILE}",
             "FILE", certSrcPath);
         elog<InvalidCertificate>(Reason("Invalid certificate file format"));
     }
+    metrics::count(metrics::Counter::opensslParses, count);
     return x509Store;
 }
 
 X509Ptr loadCert(const std::string& filePath)
 {
+    [[maybe_unused]] size_t bytes = 0;
+    CERTS_PROBE(load_cert_entry, filePath.c_str());
+    CERTS_PROBE_RETURN(load_cert_return, filePath.c_str(), bytes);
+
     // Read Certificate file
     X509Ptr cert(X509_new(), ::X509_free);
     if (!cert)
@@ -100,21 +328,47 @@ X509Ptr loadCert(const std::string& filePath)
         elog<InternalFailure>();
     }
 
-    BIOMemPtr bioCert(BIO_new_file(filePath.c_str(), "rb"), ::BIO_free);
+    std::optional<FileContent> file;
+    try
+    {
+        file.emplace(filePath);
+    }
+    catch (const std::system_error& e)
+    {
+        lg2::error("Failed to read file, FILE:{FILE}, ERR:{ERR}", "FILE",
+                   filePath, "ERR", e);
+        elog<InternalFailure>();
+    }
+    bytes = file->view().size();
+    X509* x509 = cert.get();
+    if (detectStorageFormat(file->view()) == StorageFormat::der)
+    {
+        std::string_view data = file->view();
+        const auto* p = reinterpret_cast<const unsigned char*>(data.data());
+        if (!d2i_X509(&x509, &p, static_cast<long>(data.size())))
+        {
+            lg2::error("Error occurred during d2i_X509 call, FILE:{FILE}",
+                       "FILE", filePath);
+            elog<InternalFailure>();
+        }
+        metrics::count(metrics::Counter::opensslParses);
+        return cert;
+    }
+
+    BIOMemPtr bioCert = file->bio();
     if (!bioCert)
     {
-        lg2::error("Error occurred during BIO_new_file call, FILE:{FILE}",
+        lg2::error("Error occurred during BIO_new_mem_buf call, FILE:{FILE}",
                    "FILE", filePath);
         elog<InternalFailure>();
     }
-
-    X509* x509 = cert.get();
     if (!PEM_read_bio_X509(bioCert.get(), &x509, nullptr, nullptr))
     {
         lg2::error("Error occurred during PEM_read_bio_X509 call, FILE:{FILE}",
                    "FILE", filePath);
         elog<InternalFailure>();
     }
+    metrics::count(metrics::Counter::opensslParses);
     return cert;
 }
 
@@ -143,6 +397,11 @@ void validateCertificateStartDate(X509& cert)
 void validateCertificateAgainstStore(X509_STORE& x509Store, X509& cert)
 {
     int errCode = X509_V_OK;
+    CERTS_PROBE(validate_store_entry);
+    // The verification error, if the certificate is rejected or allowed in
+    // spite of it
+    CERTS_PROBE_RETURN(validate_store_return, errCode);
+
     X509StoreCtxPtr storeCtx(X509_STORE_CTX_new(), ::X509_STORE_CTX_free);
     if (!storeCtx)
     {
@@ -210,6 +469,9 @@ void validateCertificateAgainstStore(X509_STORE& x509Store, X509& cert)
 
 void validateCertificateInSSLContext(X509& cert)
 {
+    CERTS_PROBE(validate_ssl_entry);
+    CERTS_PROBE_RETURN(validate_ssl_return);
+
     const SSL_METHOD* method = TLS_method();
     SSLCtxPtr ctx(SSL_CTX_new(method), SSL_CTX_free);
     if (SSL_CTX_use_certificate(ctx.get(), &cert) != 1)
@@ -233,8 +495,49 @@ std::string generateCertId(X509& cert)
     return {idBuff};
 }
 
+std::string generateFingerprint(X509& cert)
+{
+    std::array<unsigned char, EVP_MAX_MD_SIZE> digest{};
+    unsigned int length = 0;
+    if (X509_digest(&cert, EVP_sha256(), digest.data(), &length) != 1)
+    {
+        lg2::error("Error occurred during X509_digest call");
+        elog<InternalFailure>();
+    }
+    return toHex(digest.data(), length);
+}
+
+std::string formatSerialNumber(X509& cert)
+{
+    std::unique_ptr<BIGNUM, decltype(&::BN_free)> serial(
+        ASN1_INTEGER_to_BN(X509_get0_serialNumber(&cert), nullptr),
+        ::BN_free);
+    char* hex = serial ? BN_bn2hex(serial.get()) : nullptr;
+    if (hex == nullptr)
+    {
+        lg2::error("Error occurred during BN_bn2hex call");
+        elog<InternalFailure>();
+    }
+    std::string serialNumber(hex);
+    OPENSSL_free(hex);
+    return serialNumber;
+}
+
+std::optional<std::string> getSubjectKeyId(X509& cert)
+{
+    return toKeyId(X509_get0_subject_key_id(&cert));
+}
+
+std::optional<std::string> getAuthorityKeyId(X509& cert)
+{
+    return toKeyId(X509_get0_authority_key_id(&cert));
+}
+
 std::unique_ptr<X509, decltype(&::X509_free)> parseCert(const std::string& pem)
 {
+    CERTS_PROBE(parse_cert_entry, pem.size());
+    CERTS_PROBE_RETURN(parse_cert_return, pem.size());
+
     if (pem.size() > INT_MAX)
     {
         lg2::error("Error occurred during parseCert: PEM is too long");
@@ -257,6 +560,304 @@ std::unique_ptr<X509, decltype(&::X509_free)> parseCert(const std::string& pem)
                    "PEM", pem);
         elog<InternalFailure>();
     }
+    metrics::count(metrics::Counter::opensslParses);
     return cert;
 }
+
+std::string formatName(const X509_NAME& name)
+{
+    std::string out;
+    int previousSet = -1;
+    for (int i = 0; i < X509_NAME_entry_count(&name); ++i)
+    {
+        const X509_NAME_ENTRY* entry = X509_NAME_get_entry(&name, i);
+        int set = X509_NAME_ENTRY_set(entry);
+        if (i > 0)
+        {
+            // Multi-valued RDNs are joined with '+'
+            out += set == previousSet ? '+' : ',';
+        }
+        previousSet = set;
+
+        const ASN1_OBJECT* object = X509_NAME_ENTRY_get_object(entry);
+        int nid = OBJ_obj2nid(object);
+        if (nid != NID_undef)
+        {
+            out += OBJ_nid2sn(nid);
+        }
+        else
+        {
+            std::array<char, 80> oid{};
+            OBJ_obj2txt(oid.data(), oid.size(), object, 1);
+            out += oid.data();
+        }
+        out += '=';
+        appendNameValue(*X509_NAME_ENTRY_get_data(entry), out);
+    }
+    return out;
+}
+
+CertificateProperties extractProperties(X509& cert)
+{
+    CertificateProperties properties;
+    properties.subject = formatName(*X509_get_subject_name(&cert));
+    properties.issuer = formatName(*X509_get_issuer_name(&cert));
+
+    // The extension flags are decoded once and cached on the certificate
+    uint32_t extensions = X509_get_extension_flags(&cert);
+    if ((extensions & EXFLAG_KUSAGE) != 0)
+    {
+        appendUsages(X509_get_key_usage(&cert), keyUsageNames,
+                     properties.keyUsage);
+    }
+    if ((extensions & EXFLAG_XKUSAGE) != 0)
+    {
+        appendUsages(X509_get_extended_key_usage(&cert),
+                     extendedKeyUsageNames, properties.keyUsage);
+    }
+
+    properties.validNotBefore = toEpochSeconds(*X509_get0_notBefore(&cert));
+    properties.validNotAfter = toEpochSeconds(*X509_get0_notAfter(&cert));
+    return properties;
+}
+
+std::vector<X509Ptr> loadCertificates(const std::string& filePath)
+{
+    std::optional<FileContent> file;
+    try
+    {
+        file.emplace(filePath);
+    }
+    catch (const std::system_error& e)
+    {
+        lg2::error("Failed to read certificates list, ERR:{ERR}, SRC:{SRC}",
+                   "ERR", e, "SRC", filePath);
+        elog<InternalFailure>();
+    }
+
+    std::vector<X509Ptr> certs;
+    if (detectStorageFormat(file->view()) == StorageFormat::der)
+    {
+        std::string_view data = file->view();
+        const auto* p = reinterpret_cast<const unsigned char*>(data.data());
+        const auto* end = p + data.size();
+        while (p < end)
+        {
+            X509Ptr cert(d2i_X509(nullptr, &p, end - p), ::X509_free);
+            if (!cert)
+            {
+                lg2::error("Invalid DER certificate in the list, SRC:{SRC}",
+                           "SRC", filePath);
+                elog<InvalidCertificate>(
+                    Reason("Invalid DER certificate in the list"));
+            }
+            certs.emplace_back(std::move(cert));
+        }
+        metrics::count(metrics::Counter::opensslParses, certs.size());
+        return certs;
+    }
+
+    BIOMemPtr bio = file->bio();
+    if (!bio)
+    {
+        lg2::error("Error occurred during BIO_new_mem_buf call");
+        elog<InternalFailure>();
+    }
+    // PEM_read_bio_X509() skips text and other PEM blocks between the
+    // certificates, and fails with PEM_R_NO_START_LINE at the end of the list
+    ERR_clear_error();
+    while (true)
+    {
+        X509Ptr cert(PEM_read_bio_X509(bio.get(), nullptr, nullptr, nullptr),
+                     ::X509_free);
+        if (!cert)
+        {
+            unsigned long error = ERR_peek_last_error();
+            if (ERR_GET_LIB(error) == ERR_LIB_PEM &&
+                ERR_GET_REASON(error) == PEM_R_NO_START_LINE)
+            {
+                ERR_clear_error();
+                break;
+            }
+            lg2::error("Invalid PEM certificate in the list, SRC:{SRC}", "SRC",
+                       filePath);
+            elog<InvalidCertificate>(
+                Reason("Invalid PEM certificate in the list"));
+        }
+        certs.emplace_back(std::move(cert));
+    }
+    if (certs.empty())
+    {
+        lg2::error("No certificate in the list, SRC:{SRC}", "SRC", filePath);
+        elog<InvalidCertificate>(Reason("Invalid certificate file format"));
+    }
+    metrics::count(metrics::Counter::opensslParses, certs.size());
+    return certs;
+}
+
+X509StorePtr getX509Store(const std::vector<X509Ptr>& certs)
+{
+    X509StorePtr x509Store(X509_STORE_new(), &X509_STORE_free);
+    if (!x509Store)
+    {
+        lg2::error("Error occurred during X509_STORE_new call");
+        elog<InternalFailure>();
+    }
+    for (const auto& cert : certs)
+    {
+        if (!X509_STORE_add_cert(x509Store.get(), cert.get()))
+        {
+            lg2::error("Error occurred during X509_STORE_add_cert call");
+            elog<InternalFailure>();
+        }
+    }
+    return x509Store;
+}
+
+std::string encodeCertificate(X509& cert, StorageFormat format)
+{
+    if (format == StorageFormat::der)
+    {
+        int length = i2d_X509(&cert, nullptr);
+        if (length <= 0)
+        {
+            lg2::error("Error occurred during i2d_X509 call");
+            elog<InternalFailure>();
+        }
+        std::string der(static_cast<size_t>(length), '\0');
+        auto* p = reinterpret_cast<unsigned char*>(der.data());
+        i2d_X509(&cert, &p);
+        return der;
+    }
+
+    BIOMemPtr bio(BIO_new(BIO_s_mem()), ::BIO_free);
+    if (!bio || PEM_write_bio_X509(bio.get(), &cert) != 1)
+    {
+        lg2::error("Error occurred during PEM_write_bio_X509 call");
+        elog<InternalFailure>();
+    }
+    BUF_MEM* buf = nullptr;
+    BIO_get_mem_ptr(bio.get(), &buf);
+    return {buf->data, buf->length};
+}
+
+std::vector<X509CrlPtr> loadCrls(const std::string& filePath)
+{
+    std::optional<FileContent> file;
+    try
+    {
+        file.emplace(filePath);
+    }
+    catch (const std::system_error& e)
+    {
+        lg2::error("Failed to read CRL file, ERR:{ERR}, SRC:{SRC}", "ERR", e,
+                   "SRC", filePath);
+        elog<InternalFailure>();
+    }
+
+    std::vector<X509CrlPtr> crls;
+    if (detectStorageFormat(file->view()) == StorageFormat::der)
+    {
+        std::string_view data = file->view();
+        const auto* p = reinterpret_cast<const unsigned char*>(data.data());
+        const auto* end = p + data.size();
+        while (p < end)
+        {
+            X509CrlPtr crl(d2i_X509_CRL(nullptr, &p, end - p),
+                           ::X509_CRL_free);
+            if (!crl)
+            {
+                lg2::error("Invalid DER CRL, SRC:{SRC}", "SRC", filePath);
+                elog<InvalidCertificate>(Reason("Invalid DER CRL"));
+            }
+            crls.emplace_back(std::move(crl));
+        }
+        metrics::count(metrics::Counter::opensslParses, crls.size());
+        return crls;
+    }
+
+    BIOMemPtr bio = file->bio();
+    if (!bio)
+    {
+        lg2::error("Error occurred during BIO_new_mem_buf call");
+        elog<InternalFailure>();
+    }
+    // As for certificates lists, see loadCertificates()
+    ERR_clear_error();
+    while (true)
+    {
+        X509CrlPtr crl(PEM_read_bio_X509_CRL(bio.get(), nullptr, nullptr,
+                                             nullptr),
+                       ::X509_CRL_free);
+        if (!crl)
+        {
+            unsigned long error = ERR_peek_last_error();
+            if (ERR_GET_LIB(error) == ERR_LIB_PEM &&
+                ERR_GET_REASON(error) == PEM_R_NO_START_LINE)
+            {
+                ERR_clear_error();
+                break;
+            }
+            lg2::error("Invalid PEM CRL, SRC:{SRC}", "SRC", filePath);
+            elog<InvalidCertificate>(Reason("Invalid PEM CRL"));
+        }
+        crls.emplace_back(std::move(crl));
+    }
+    if (crls.empty())
+    {
+        lg2::error("No CRL in the file, SRC:{SRC}", "SRC", filePath);
+        elog<InvalidCertificate>(Reason("Invalid CRL file format"));
+    }
+    metrics::count(metrics::Counter::opensslParses, crls.size());
+    return crls;
+}
+
+std::string encodeCrl(X509_CRL& crl)
+{
+    BIOMemPtr bio(BIO_new(BIO_s_mem()), ::BIO_free);
+    if (!bio || PEM_write_bio_X509_CRL(bio.get(), &crl) != 1)
+    {
+        lg2::error("Error occurred during PEM_write_bio_X509_CRL call");
+        elog<InternalFailure>();
+    }
+    BUF_MEM* buf = nullptr;
+    BIO_get_mem_ptr(bio.get(), &buf);
+    return {buf->data, buf->length};
+}
+
+bool isNewerCrl(X509_CRL& crl, X509_CRL& previous)
+{
+    auto crlNumber = [](X509_CRL& crl) {
+        auto* number = static_cast<ASN1_INTEGER*>(
+            X509_CRL_get_ext_d2i(&crl, NID_crl_number, nullptr, nullptr));
+        return ASN1IntegerPtr(number, ::ASN1_INTEGER_free);
+    };
+    auto number = crlNumber(crl);
+    auto previousNumber = crlNumber(previous);
+    if (number && previousNumber)
+    {
+        return ASN1_INTEGER_cmp(number.get(), previousNumber.get()) > 0;
+    }
+    const ASN1_TIME* lastUpdate = X509_CRL_get0_lastUpdate(&crl);
+    const ASN1_TIME* previousUpdate = X509_CRL_get0_lastUpdate(&previous);
+    if (lastUpdate == nullptr || previousUpdate == nullptr)
+    {
+        return false;
+    }
+    return ASN1_TIME_compare(lastUpdate, previousUpdate) > 0;
+}
+
+std::string getSerialNumberBytes(const ASN1_INTEGER& serialNumber)
+{
+    int length = i2d_ASN1_INTEGER(&serialNumber, nullptr);
+    if (length <= 0)
+    {
+        lg2::error("Error occurred during i2d_ASN1_INTEGER call");
+        elog<InternalFailure>();
+    }
+    std::string bytes(static_cast<size_t>(length), '\0');
+    auto* data = reinterpret_cast<unsigned char*>(bytes.data());
+    i2d_ASN1_INTEGER(&serialNumber, &data);
+    return bytes;
+}
 } // namespace phosphor::certs
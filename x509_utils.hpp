@@ -1,24 +1,77 @@
+#pragma once
+
 #include <openssl/ossl_typ.h>
 #include <openssl/x509.h>
 #include <openssl/x509_vfy.h>
 
+#include <cstdint>
 #include <memory>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <vector>
 
 namespace phosphor::certs
 {
 
+/** @brief Encoding of the certificate files a manager stores */
+enum class StorageFormat
+{
+    pem,
+    der,
+};
+
+inline constexpr const char* storageFormatToString(StorageFormat format)
+{
+    switch (format)
+    {
+        case StorageFormat::der:
+            return "der";
+        default:
+            return "pem";
+    }
+}
+
+inline constexpr std::optional<StorageFormat>
+    stringToStorageFormat(std::string_view format)
+{
+    if (format == "pem")
+    {
+        return StorageFormat::pem;
+    }
+    if (format == "der")
+    {
+        return StorageFormat::der;
+    }
+    return std::nullopt;
+}
+
+/** @brief Tells how certificate data is encoded
+ *  @details Data starting like a DER SEQUENCE with a long form length is
+ *  DER; anything else is taken as PEM, which may start with free text.
+ *  @param[in] data - Content of a certificate file.
+ *  @return The encoding.
+ */
+StorageFormat detectStorageFormat(std::string_view data);
+
+/** @brief Tells how a certificate file is encoded
+ *  @param[in] filePath - Certificate file path.
+ *  @return The encoding; PEM if the file can't be read.
+ */
+StorageFormat getFileStorageFormat(const std::string& filePath);
+
 /** @brief Creates an X509 Store from the given certSrcPath
  *  Creates an X509 Store, adds a lookup file to the store from the given source
  * certificate, and returns it
- *  @param[in] certSrcPath - the file path to a list of trusted certificates
+ *  @param[in] certSrcPath - the file path to a list of trusted certificates,
+ * PEM or concatenated DER
  *
  */
 std::unique_ptr<X509_STORE, decltype(&::X509_STORE_free)>
     getX509Store(const std::string& certSrcPath);
 
 /** @brief Loads Certificate file into the X509 structure.
- *  @param[in] filePath - Certificate and key full file path.
+ *  @param[in] filePath - Certificate and key full file path; PEM or DER.
  *  @return pointer to the X509 structure.
  */
 std::unique_ptr<X509, decltype(&::X509_free)>
@@ -58,9 +111,128 @@ void validateCertificateInSSLContext(X509& cert);
  */
 std::string generateCertId(X509& cert);
 
+/**
+ * @brief Generates the SHA-256 fingerprint of a certificate.
+ *
+ * @param[in] cert - Certificate object.
+ *
+ * @return Fingerprint as a lower case hex string.
+ */
+std::string generateFingerprint(X509& cert);
+
+/**
+ * @brief Formats the serial number of a certificate.
+ *
+ * @param[in] cert - Certificate object.
+ *
+ * @return Serial number as an upper case hex string, as `openssl x509
+ * -serial` prints it.
+ */
+std::string formatSerialNumber(X509& cert);
+
+/**
+ * @brief Gets the subject key identifier of a certificate.
+ *
+ * @param[in] cert - Certificate object.
+ *
+ * @return Key identifier as a lower case hex string, std::nullopt if the
+ * certificate has no subjectKeyIdentifier extension.
+ */
+std::optional<std::string> getSubjectKeyId(X509& cert);
+
+/**
+ * @brief Gets the key identifier of the authority key identifier of a
+ * certificate, the subject key identifier of its issuer.
+ *
+ * @param[in] cert - Certificate object.
+ *
+ * @return Key identifier as a lower case hex string, std::nullopt if the
+ * certificate has no authorityKeyIdentifier extension, or one without a key
+ * identifier.
+ */
+std::optional<std::string> getAuthorityKeyId(X509& cert);
+
 /** @brief Parses PEM string into the X509 structure.
  *  @param[in] pem - PEM encoded X509 certificate buffer.
  *  @return pointer to the X509 structure.
  */
 std::unique_ptr<X509, decltype(&::X509_free)> parseCert(const std::string& pem);
+
+/** @brief Loads all the certificates of an authorities list file
+ *  @param[in] filePath - PEM bundle or concatenated DER certificates.
+ *  @return The certificates, in file order.
+ */
+std::vector<std::unique_ptr<X509, decltype(&::X509_free)>>
+    loadCertificates(const std::string& filePath);
+
+/** @brief Creates an X509 Store holding the given certificates
+ *  @param[in] certs - Trusted certificates.
+ */
+std::unique_ptr<X509_STORE, decltype(&::X509_STORE_free)> getX509Store(
+    const std::vector<std::unique_ptr<X509, decltype(&::X509_free)>>& certs);
+
+/** @brief Encodes a certificate for storage
+ *  @param[in] cert - Certificate to encode.
+ *  @param[in] format - Encoding.
+ *  @return The encoded certificate; PEM text ends with a newline.
+ */
+std::string encodeCertificate(X509& cert, StorageFormat format);
+
+using X509CrlPtr = std::unique_ptr<X509_CRL, decltype(&::X509_CRL_free)>;
+
+/** @brief Loads all the CRLs of a file
+ *  @param[in] filePath - PEM CRLs or concatenated DER CRLs.
+ *  @return The CRLs, in file order.
+ */
+std::vector<X509CrlPtr> loadCrls(const std::string& filePath);
+
+/** @brief Encodes a CRL for storage
+ *  @param[in] crl - CRL to encode.
+ *  @return The PEM encoded CRL, which OpenSSL CApath lookups read.
+ */
+std::string encodeCrl(X509_CRL& crl);
+
+/** @brief Tells if a CRL supersedes the one of the same issuer
+ *  @details Compares the CRL numbers when both CRLs have one, the
+ *  lastUpdate times otherwise; a CRL is newer only if strictly greater.
+ *  @param[in] crl - CRL to install.
+ *  @param[in] previous - CRL installed.
+ *  @return Whether |crl| is newer than |previous|.
+ */
+bool isNewerCrl(X509_CRL& crl, X509_CRL& previous);
+
+/** @brief Gets the serial number of a certificate, or of a CRL entry, as
+ *  the revocation index keys it
+ *  @param[in] serialNumber - Serial number.
+ *  @return Its DER encoding, which keeps the sign: a negative serial number,
+ *  as some CAs issue, doesn't match the positive one of the same magnitude.
+ */
+std::string getSerialNumberBytes(const ASN1_INTEGER& serialNumber);
+
+/** @brief Certificate fields published on D-Bus */
+struct CertificateProperties
+{
+    std::string subject;
+    std::string issuer;
+    std::vector<std::string> keyUsage;
+    uint64_t validNotBefore = 0;
+    uint64_t validNotAfter = 0;
+};
+
+/** @brief Extracts the D-Bus visible fields of a certificate
+ *  @details Works on the decoded certificate only: names are rendered as
+ *  comma separated "SN=value" lists in UTF-8, key usages come from the
+ *  extension flags OpenSSL caches on the certificate, and the validity
+ *  bounds are converted to seconds since the Unix epoch.
+ *  @param[in] cert - Certificate to extract the fields of.
+ *  @return Extracted fields.
+ */
+CertificateProperties extractProperties(X509& cert);
+
+/** @brief Renders a distinguished name the way the Subject and Issuer
+ *  properties present it, e.g. "C=US,O=Example,CN=bmc.example.com"
+ *  @param[in] name - Name to render.
+ *  @return Rendered name; never truncated.
+ */
+std::string formatName(const X509_NAME& name);
 } // namespace phosphor::certs